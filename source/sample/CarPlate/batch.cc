@@ -0,0 +1,415 @@
+﻿/**************************************************************************//**
+ * @file	batch.cc
+ * @brief	CarBatchRunner 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include <ctype.h>
+#include "batch.hh"
+
+/**
+ *	@brief	CarBatchRunner 建構式
+ *	@return	此函數沒有返回值
+ */
+CarBatchRunner::CarBatchRunner()
+	: m_filesPtr(nullptr)
+	, m_outputPtr(nullptr)
+	, m_nNext(0)
+	, m_nFrames(0)
+	, m_nDetections(0)
+	, m_nFailed(0) {
+}
+
+/**
+ *	@brief	CarBatchRunner 解構式
+ *	@return	此函數沒有返回值
+ */
+CarBatchRunner::~CarBatchRunner()
+{
+	for (auto& metrics : m_vecMetrics) {
+		m_cMetrics.Unregister(metrics.get());
+	}
+}
+
+/**
+ *	@brief	批次偵測檔案列表，所有檔案處理完畢後返回。
+ *	@param[in]	files	影片或影像檔案路徑列表
+ *	@param[out]	output	偵測結果輸出
+ *	@param[in]	options	批次偵測選項
+ *	@return	<b>型別: bool</b> \n 若所有檔案皆處理成功返回值為非零值 (true)。 \n 若有檔案開啟失敗返回值為零 (false)。
+ */
+bool CarBatchRunner::Run(const std::vector<std::string>& files, std::ostream& output, const CarBatchOptions& options)
+{
+	m_filesPtr = &files;
+	m_outputPtr = &output;
+	m_sOptions = options;
+	m_strReplay = options.recordFile.empty() ? std::string() : CAR_SOURCE_REPLAY + options.recordFile;
+	m_nNext.store(0);
+	m_nFrames.store(0);
+	m_nDetections.store(0);
+	m_nFailed.store(0);
+
+	// 每個檔案的偵測管線約使用 4 個 threads (解碼與各節點，預處理另以 OpenCV 平行分塊)，幀平行模式另加 worker 數量，
+	// 依 CPU 核心數量決定同時處理的檔案數量
+	m_sOptions.workers = std::max<size_t>(m_sOptions.workers, 1);
+	int jobs = m_sOptions.jobs;
+	if (jobs <= 0) {
+		const int threads = (m_sOptions.workers > 1) ? static_cast<int>(m_sOptions.workers) + 2 : 4;
+		jobs = static_cast<int>(std::thread::hardware_concurrency()) / threads;
+	}
+	jobs = std::max(std::min(jobs, static_cast<int>(files.size())), 1);
+
+	// 模型檔不存在時於啟動 job 前轉換一次，之後各 job 與幀平行 worker 直接映射載入
+	if (!m_sOptions.modelFile.empty()) {
+		CarPlateOcr cOcr;
+		if (!cOcr.LoadModel(m_sOptions.modelFile.c_str())) {
+			CarPlateOcr::ConvertXml(m_sOptions.classFile, m_sOptions.imageFile, m_sOptions.modelFile.c_str());
+		}
+	}
+
+	// 每個 job 一個統計物件，批次偵測結束後仍可取得快照
+	for (auto& metrics : m_vecMetrics) {
+		m_cMetrics.Unregister(metrics.get());
+	}
+	m_vecMetrics.clear();
+	for (int i = 0; i < jobs; i++) {
+		std::unique_ptr<CarStreamMetrics> metrics(new (std::nothrow) CarStreamMetrics("job-" + std::to_string(i)));
+		if (metrics == nullptr) break;
+
+		m_cMetrics.Register(metrics.get());
+		m_vecMetrics.push_back(std::move(metrics));
+	}
+
+	std::vector<std::thread*> vecJobs;
+	for (size_t i = 0; i < m_vecMetrics.size(); i++) {
+		auto threadPtr = new (std::nothrow) std::thread(&CarBatchRunner::JobProcess, this, m_vecMetrics[i].get());
+		if (threadPtr == nullptr) break;
+		vecJobs.push_back(threadPtr);
+	}
+
+	// job thread 建立失敗時由呼叫端 thread 處理
+	if (vecJobs.empty()) {
+		CarStreamMetrics metrics("job-0");
+		CarBatchRunner::JobProcess(this, m_vecMetrics.empty() ? &metrics : m_vecMetrics.front().get());
+	}
+
+	for (auto& threadPtr : vecJobs) {
+		if (threadPtr->joinable()) {
+			threadPtr->join();
+		}
+		SAFE_DELETE(threadPtr);
+	}
+
+	output.flush();
+	m_filesPtr = nullptr;
+	m_outputPtr = nullptr;
+	return m_nFailed.load() == 0;
+}
+
+/**
+ *	@brief	依副檔名判斷是否為單張影像檔案 (其餘視為影片)
+ *	@param[in]	file	檔案路徑
+ *	@return	<b>型別: bool</b> \n 若為影像檔案返回值為非零值 (true)。 \n 若不是影像檔案返回值為零 (false)。
+ */
+bool CarBatchRunner::IsImageFile(const std::string& file)
+{
+	static const char* const extensions[] = { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff" };
+
+	const auto dot = file.find_last_of('.');
+	if (dot == std::string::npos) {
+		return false;
+	}
+
+	std::string ext = file.substr(dot);
+	for (auto& c : ext) {
+		c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+	}
+
+	for (auto extPtr : extensions) {
+		if (ext == extPtr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *	@brief	job thread process: 依序取出尚未處理的檔案進行偵測
+ *	@param[in]	cThisPtr	(指標) CarBatchRunner 物件
+ *	@param[in]	metricsPtr	(指標) 此 job 的效能統計
+ *	@return	此函數沒有返回值
+ */
+void CarBatchRunner::JobProcess(CarBatchRunner* cThisPtr, CarStreamMetrics* metricsPtr)
+{
+	const auto& files = *cThisPtr->m_filesPtr;
+	const auto& options = cThisPtr->m_sOptions;
+
+	// 批次模式不顯示影像，不建立疊圖節點
+	CarFramePool pool;
+	CarStageGraph stageGraph;
+	stageGraph.SetMetrics(metricsPtr);
+	stageGraph.SetWorkers(options.workers);
+	stageGraph.SetThreads(options.threads);
+	if (options.isVoting) {
+		CarTrackOptions trackOptions;
+		CarVoteOptions voteOptions;
+		trackOptions.isEnabled = true;
+		voteOptions.isEnabled = true;
+		stageGraph.GetTracker().SetOptions(trackOptions);
+		stageGraph.SetVoteOptions(voteOptions);
+		stageGraph.AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarTrackStage(stageGraph.GetTracker())));
+	}
+	const char* modelFile = options.modelFile.empty() ? nullptr : options.modelFile.c_str();
+	stageGraph.AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarTiledStage()));
+	stageGraph.AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarContoursStage()));
+	stageGraph.AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarRecognizeStage(modelFile, options.classFile, options.imageFile)));
+
+	for (;;) {
+		const size_t index = cThisPtr->m_nNext.fetch_add(1);
+		if (index >= files.size()) {
+			break;
+		}
+
+		if (!cThisPtr->ProcessFile(index, stageGraph, pool, *metricsPtr)) {
+			cThisPtr->m_nFailed.fetch_add(1);
+		}
+	}
+
+	// 緩衝池隨 job thread 結束釋放，統計物件保留
+	metricsPtr->SetSources(nullptr, nullptr);
+}
+
+/**
+ *	@brief	偵測單一檔案所有影像
+ *	@param[in]	index		檔案索引 (偵測事件的串流編號)
+ *	@param[in]	stageGraph	偵測管線 (job thread 各自持有)
+ *	@param[in]	pool		影像緩衝池 (job thread 各自持有)
+ *	@param[in]	metrics		效能統計 (job thread 各自持有)
+ *	@return	<b>型別: bool</b> \n 若檔案處理成功返回值為非零值 (true)。 \n 若檔案開啟失敗返回值為零 (false)。
+ */
+bool CarBatchRunner::ProcessFile(size_t index, CarStageGraph& stageGraph, CarFramePool& pool, CarStreamMetrics& metrics)
+{
+	const std::string& file = (*m_filesPtr)[index];
+
+	// 阻塞式佇列: 偵測端來不及時解碼端等待，不丟棄任何影像
+	CarQueueChannel channel(CAR_RING_CAPACITY, RingOverflow::Block);
+	// 幀平行模式每個 worker 另保留一幀，單一幀處理較久 (等待重新排序) 時其他 worker 仍可繼續處理
+	const size_t depth = (m_sOptions.workers > 1) ? std::max(m_sOptions.depth, m_sOptions.workers * 2) : m_sOptions.depth;
+	if (!stageGraph.Start(channel, 0, depth)) {
+		return false;
+	}
+	metrics.SetSources(&channel, &pool);
+
+	Decoder decoder;
+	decoder.file = file;
+	decoder.channelPtr = &channel;
+	decoder.poolPtr = &pool;
+	decoder.metricsPtr = &metrics;
+	decoder.decoded.store(0);
+	decoder.isDone.store(false);
+	decoder.isOpened = false;
+	decoder.recordFile = m_sOptions.recordFile;
+
+	std::thread* threadPtr = new (std::nothrow) std::thread(&CarBatchRunner::DecodeProcess, &decoder);
+	if (threadPtr == nullptr) {
+		metrics.SetSources(nullptr, &pool);
+		stageGraph.Stop();
+		return false;
+	}
+
+	// 依幀序取出偵測結果，解碼完畢且所有影像流出管線後結束
+	CarStageFrame* stageFramePtr = nullptr;
+	std::string lines;
+	double timestampMs = 0.0;
+	for (;;) {
+		if (decoder.isDone.load() && stageGraph.GetFinished() >= decoder.decoded.load()) {
+			break;
+		}
+
+		if (stageGraph.Pop(stageFramePtr, CAR_RING_WAIT_MS)) {
+			timestampMs = stageFramePtr->frame.TimestampMs();
+			this->WriteFrame(index, *stageFramePtr, lines);
+			stageGraph.Release(stageFramePtr);
+		}
+	}
+
+	// 檔案結束時輸出尚未結束的軌跡
+	if (m_sOptions.isVoting) {
+		std::vector<CarPlateEvent> events;
+		stageGraph.FlushEvents(events);
+		this->WriteEvents(index, timestampMs, events, lines);
+	}
+
+	if (threadPtr->joinable()) {
+		threadPtr->join();
+	}
+	SAFE_DELETE(threadPtr);
+
+	// 先關閉傳輸通道，來源 thread 不必等到取幀逾時
+	metrics.SetSources(nullptr, &pool);
+	channel.Close();
+	stageGraph.Stop();
+	return decoder.isOpened;
+}
+
+/**
+ *	@brief	解碼 thread process: 依序讀取檔案所有影像放入傳輸通道，不跳幀、不休眠。
+ *	@param[in]	decoderPtr	(指標) 解碼狀態
+ *	@return	此函數沒有返回值
+ */
+void CarBatchRunner::DecodeProcess(Decoder* decoderPtr)
+{
+	auto& channel = *decoderPtr->channelPtr;
+	auto& pool = *decoderPtr->poolPtr;
+	auto metricsPtr = decoderPtr->metricsPtr;
+
+	// 錄製解碼後的原始影像 (供之後以 replay: 重現相同輸入)
+	CarFrameRecorder recorder;
+	if (!decoderPtr->recordFile.empty()) {
+		recorder.Open(decoderPtr->recordFile.c_str());
+	}
+
+	for (;;) {
+		if (CarBatchRunner::IsImageFile(decoderPtr->file)) {
+			CarFrame frame = pool.Acquire(cv::Size(), CV_8UC3);
+			{
+				CarStageTimer timer(metricsPtr, MetricStage::Decode);
+				frame.Image() = cv::imread(decoderPtr->file, cv::IMREAD_COLOR);
+			}
+			if (frame.Empty()) break;
+
+			decoderPtr->isOpened = true;
+			metricsPtr->AddCaptured();
+			if (recorder.IsOpened()) {
+				recorder.Write(frame);
+			}
+			if (channel.Push(frame)) {
+				decoderPtr->decoded.fetch_add(1);
+			}
+			break;
+		}
+
+		// 影片、錄製檔 (replay:) 或合成影像 (synthetic:)，錄製檔不依錄製速度而是盡快送出
+		CarCaptureOptions options;
+		options.isRealtime = false;
+		std::unique_ptr<CarFrameSource> source(CarFrameSource::Create(decoderPtr->file, options));
+		if (source == nullptr || !source->Open()) break;
+
+		source->SetMetrics(metricsPtr);
+		decoderPtr->isOpened = true;
+		for (;;) {
+			CarFrame frame;
+			if (source->Read(frame, pool) != SourceRead::Frame) {
+				break;
+			}
+
+			metricsPtr->AddCaptured();
+			if (recorder.IsOpened()) {
+				recorder.Write(frame);
+			}
+			if (!channel.Push(frame)) {
+				break;
+			}
+			decoderPtr->decoded.fetch_add(1);
+		}
+		source->Close();
+		break;
+	}
+
+	decoderPtr->isDone.store(true);
+}
+
+/**
+ *	@brief	輸出單一幀偵測結果，每筆候選區域一行 (並放入偵測事件)。
+ *	@param[in]		index		檔案索引
+ *	@param[in]		stageFrame	處理完成的影像資料
+ *	@param[in,out]	lines		輸出暫存 (job thread 重複使用)
+ *	@return	此函數沒有返回值
+ */
+void CarBatchRunner::WriteFrame(size_t index, const CarStageFrame& stageFrame, std::string& lines)
+{
+	char buffer[128];
+	const std::string& file = (*m_filesPtr)[index];
+	const auto& candidates = stageFrame.candidates;
+	const auto& reads = stageFrame.reads;
+	const double timestampMs = stageFrame.frame.TimestampMs();
+
+	m_nFrames.fetch_add(1, std::memory_order_relaxed);
+	if (m_sOptions.isVoting) {
+		this->WriteEvents(index, timestampMs, stageFrame.events, lines);
+		return;
+	}
+	if (candidates.empty()) {
+		return;
+	}
+
+	if (m_sOptions.eventsPtr != nullptr) {
+		CarDetectEvent event;
+		const char* sourcePtr = m_strReplay.empty() ? file.c_str() : m_strReplay.c_str();
+		for (size_t i = 0; i < candidates.size(); i++) {
+			CarEventWriter::MakeEvent(event, static_cast<int>(index), stageFrame.index, timestampMs, candidates[i], i < reads.size() ? &reads[i] : nullptr);
+			CarEventWriter::SetCrop(event, sourcePtr, stageFrame.index);
+			m_sOptions.eventsPtr->Post(event);
+		}
+	}
+
+	// 同一幀的結果組合後一次寫入，不同檔案的結果不會交錯於同一行
+	lines.clear();
+	for (size_t i = 0; i < candidates.size(); i++) {
+		const cv::Rect& rect = candidates[i].rect;
+		const bool isRead = i < reads.size() && reads[i].count > 0;
+		::snprintf(buffer, sizeof(buffer), "\t%llu\t%d\t%d\t%d\t%d\t%s\t%.3f\n",
+			static_cast<unsigned long long>(stageFrame.index), rect.x, rect.y, rect.width, rect.height,
+			isRead ? reads[i].text : "", isRead ? reads[i].confidence : 0.0f);
+		lines += file;
+		lines += buffer;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_outputPtr->write(lines.data(), static_cast<std::streamsize>(lines.size()));
+	m_nDetections.fetch_add(candidates.size(), std::memory_order_relaxed);
+}
+
+/**
+ *	@brief	輸出車牌事件，每筆事件一行 (並放入偵測事件)。
+ *	@param[in]		index		檔案索引
+ *	@param[in]		timestampMs	產生事件的幀時間戳記 (ms)
+ *	@param[in]		events		車牌事件
+ *	@param[in,out]	lines		輸出暫存 (job thread 重複使用)
+ *	@return	此函數沒有返回值
+ */
+void CarBatchRunner::WriteEvents(size_t index, double timestampMs, const std::vector<CarPlateEvent>& events, std::string& lines)
+{
+	char buffer[128];
+	const std::string& file = (*m_filesPtr)[index];
+	if (events.empty()) {
+		return;
+	}
+
+	if (m_sOptions.eventsPtr != nullptr) {
+		// 截圖參考指向車牌最後一次出現的幀 (事件外接矩形所在的幀)
+		CarDetectEvent event;
+		const char* sourcePtr = m_strReplay.empty() ? file.c_str() : m_strReplay.c_str();
+		for (const auto& plateEvent : events) {
+			CarEventWriter::MakeEvent(event, static_cast<int>(index), timestampMs, plateEvent);
+			CarEventWriter::SetCrop(event, sourcePtr, plateEvent.lastIndex);
+			m_sOptions.eventsPtr->Post(event);
+		}
+	}
+
+	lines.clear();
+	for (const auto& event : events) {
+		const cv::Rect& rect = event.rect;
+		::snprintf(buffer, sizeof(buffer), "\t%llu\t%d\t%d\t%d\t%d\t%s\t%.3f\n",
+			static_cast<unsigned long long>(event.firstIndex), rect.x, rect.y, rect.width, rect.height,
+			event.read.text, event.read.confidence);
+		lines += file;
+		lines += buffer;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_outputPtr->write(lines.data(), static_cast<std::streamsize>(lines.size()));
+	m_nDetections.fetch_add(events.size(), std::memory_order_relaxed);
+}
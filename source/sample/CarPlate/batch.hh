@@ -0,0 +1,109 @@
+﻿/**************************************************************************//**
+ * @file	batch.hh
+ * @brief	CarBatchRunner 影像檔案批次車牌偵測類別宣告 Header (不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_BATCH_HH
+#define	ODMC_CARPLATE_BATCH_HH
+#include <ostream>
+#include "eventlog.hh"
+#include "stagegraph.hh"
+#include "source.hh"
+
+/**
+ *	@struct	CarBatchOptions
+ *	@brief	批次偵測選項
+ */
+struct CarBatchOptions {
+	int			jobs;			//!< 同時處理的檔案數量，0 = 依 CPU 核心數量與節點數量決定
+	size_t		depth;			//!< 每個檔案同時處理中的幀數上限
+	size_t		workers;		//!< 每個檔案的幀平行偵測 worker 數量，1 = 節點管線
+	int			threads;		//!< 單幀平行處理 (分塊預處理與連通元件列帶) thread 數量，0 = 所有核心
+	std::string	modelFile;		//!< 字元辨識二進位模型檔 (空字串時不進行字元辨識)
+	cv::String	classFile;		//!< 字元訓練標籤檔 (XML)
+	cv::String	imageFile;		//!< 字元訓練影像檔 (XML)
+	bool		isVoting;		//!< 是否追蹤車牌並依軌跡投票 (每個車牌只輸出一行)
+	std::string	recordFile;		//!< 錄製解碼後影像的錄製檔路徑 (只處理單一檔案時使用)，空字串 = 不錄製
+	CarEventWriter*	eventsPtr;	//!< 偵測事件非同步輸出 (已啟動，串流編號為檔案索引)，nullptr = 不輸出
+
+	CarBatchOptions()
+		: jobs(0)
+		, depth(CAR_BATCH_DEPTH)
+		, workers(1)
+		, threads(CAR_PARALLEL_THREADS)
+		, modelFile()
+		, classFile()
+		, imageFile()
+		, isVoting(false)
+		, recordFile()
+		, eventsPtr(nullptr) {
+	}
+};
+
+/**
+ *	@class	CarBatchRunner
+ *	@brief	影像檔案批次車牌偵測 (無視窗)
+ *	@remark	每個檔案由解碼 thread 依序讀取所有影像 (不跳幀、不休眠)，經阻塞式佇列送入偵測管線，
+ *			處理速度只受 CPU 限制。多個檔案由 job threads 同時處理，偵測結果依檔案內幀序輸出，
+ *			每筆候選區域輸出一行 (tab 分隔): 檔案、幀序、x、y、寬、高、車牌文字、信心值。
+ *			啟用投票時改為每筆車牌事件輸出一行，幀序為第一次辨識的幀序，其餘欄位相同。
+ *			設定多個 worker 時每個檔案以幀平行模式偵測 (重新處理單一錄影檔時可使用所有核心)，輸出順序不變。
+ *			單幀預處理與連通元件標記依 thread 數量切割列帶平行處理 (單一高解析度串流降低每幀延遲)。
+ *			設定事件輸出時，輸出的每一行同時以偵測事件放入事件佇列 (不在 job thread 進行 I/O)。
+ */
+class CarBatchRunner
+{
+public:
+	CarBatchRunner();
+	virtual ~CarBatchRunner();
+
+	bool Run(const std::vector<std::string>& files, std::ostream& output, const CarBatchOptions& options = CarBatchOptions());
+
+	uint64_t GetFrames() const { return m_nFrames.load(std::memory_order_relaxed); }
+	uint64_t GetDetections() const { return m_nDetections.load(std::memory_order_relaxed); }
+	uint64_t GetFailed() const { return m_nFailed.load(std::memory_order_relaxed); }
+	CarMetricsRegistry& GetMetrics() { return m_cMetrics; }
+
+	static bool IsImageFile(const std::string& file);
+
+private:
+	CarBatchRunner(const CarBatchRunner&) = delete;				//!< Disable copy construction
+	CarBatchRunner& operator=(const CarBatchRunner&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Decoder
+	 *	@brief	單一檔案解碼狀態
+	 */
+	struct Decoder {
+		std::string			file;			//!< 檔案路徑
+		CarFrameChannel*	channelPtr;		//!< 影像傳輸通道
+		CarFramePool*		poolPtr;		//!< 影像緩衝池
+		CarStreamMetrics*	metricsPtr;		//!< 效能統計
+		std::atomic<uint64_t> decoded;		//!< 已解碼幀數
+		std::atomic<bool>	isDone;			//!< 是否已解碼完畢 (或開啟失敗)
+		bool				isOpened;		//!< 檔案是否開啟成功
+		std::string			recordFile;		//!< 錄製檔路徑 (空字串 = 不錄製)
+	};
+
+	static void JobProcess(CarBatchRunner* cThisPtr, CarStreamMetrics* metricsPtr);
+	static void DecodeProcess(Decoder* decoderPtr);
+	bool ProcessFile(size_t index, CarStageGraph& stageGraph, CarFramePool& pool, CarStreamMetrics& metrics);
+	void WriteFrame(size_t index, const CarStageFrame& stageFrame, std::string& lines);
+	void WriteEvents(size_t index, double timestampMs, const std::vector<CarPlateEvent>& events, std::string& lines);
+
+	const std::vector<std::string>* m_filesPtr;		//!< 檔案列表
+	std::ostream*			m_outputPtr;		//!< 偵測結果輸出
+	CarBatchOptions			m_sOptions;			//!< 批次偵測選項
+	std::string				m_strReplay;		//!< 錄製檔重播網址 (replay:<錄製檔>，事件截圖參考來源)，空字串 = 不錄製
+	std::atomic<size_t>		m_nNext;			//!< 下一個要處理的檔案索引
+	std::atomic<uint64_t>	m_nFrames;			//!< 已偵測幀數
+	std::atomic<uint64_t>	m_nDetections;		//!< 已輸出候選區域 (或車牌事件) 數量
+	std::atomic<uint64_t>	m_nFailed;			//!< 開啟失敗的檔案數量
+	std::mutex				m_mutex;			//!< 保護偵測結果輸出
+	CarMetricsRegistry		m_cMetrics;			//!< 各 job 效能統計登錄
+	std::vector<std::unique_ptr<CarStreamMetrics> > m_vecMetrics;	//!< 各 job 效能統計 (保留至下一次批次偵測)
+};
+
+#endif // !ODMC_CARPLATE_BATCH_HH
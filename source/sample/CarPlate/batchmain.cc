@@ -0,0 +1,174 @@
+﻿/**************************************************************************//**
+ * @file	batchmain.cc
+ * @brief	CarPlate 批次偵測程式進入口 (無視窗，不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include "batch.hh"
+
+/**
+ *	@brief	顯示使用說明
+ *	@param[in]	name	程式名稱
+ *	@return	此函數沒有返回值
+ */
+static void PrintUsage(const char* name)
+{
+	::fprintf(stderr,
+		"usage: %s [-j jobs] [-w workers] [-t threads] [-d depth] [-o output] [-s seconds] [-J] [-v] [-R record] [-e events] [-u socket] [-b] [-m model -c classify.xml -i images.xml] file...\n"
+		"       %s -X -m model -c classify.xml -i images.xml\n"
+		"  file: video, image, replay:<recording> or synthetic:[<width>x<height>][@<frames>]\n"
+		"  -j  files processed concurrently (default: cores / 4, or cores / (workers + 2) with -w)\n"
+		"  -w  frame-parallel detector workers per file, results stay in frame order (default: 1 = stage pipeline)\n"
+		"  -t  threads splitting each frame into row bands for preprocessing and labeling (default: 0 = all cores)\n"
+		"  -d  frames in flight per file (default: %d, at least 2 x workers)\n"
+		"  -o  detection output file (default: stdout)\n"
+		"  -s  print per-stage latency statistics to stderr every N seconds (default: at exit only)\n"
+		"  -J  print statistics as JSON lines instead of text\n"
+		"  -v  track plates and vote across frames: one line per plate instead of per frame\n"
+		"  -R  record the decoded frames of a single input to a raw recording (play back with replay:<recording>)\n"
+		"  -e  append detection events to a file (JSON lines, written by a background thread)\n"
+		"  -u  send detection events to a local UNIX socket (reconnects when the listener restarts)\n"
+		"  -b  write detection events as a compact binary log instead of JSON lines\n"
+		"  -m  binary OCR model; -c/-i XML training files used when the model does not exist\n"
+		"  -X  convert the -c/-i XML training files to the -m binary model and exit\n",
+		name, name, CAR_BATCH_DEPTH);
+}
+
+/**
+ *	@brief	批次偵測程式入口函數
+ */
+int main(int argc, char* argv[])
+{
+	CarBatchOptions options;
+	std::vector<std::string> files;
+	const char* outputFile = nullptr;
+	int statsSeconds = 0;
+	MetricsFormat statsFormat = MetricsFormat::Text;
+	const char* eventFile = nullptr;
+	const char* eventSocket = nullptr;
+	EventFormat eventFormat = EventFormat::JsonLines;
+	bool isConvert = false;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1) < argc;
+
+		if (arg == "-j" && hasValue) options.jobs = ::atoi(argv[++i]);
+		else if (arg == "-w" && hasValue) options.workers = static_cast<size_t>(std::max(::atoi(argv[++i]), 1));
+		else if (arg == "-t" && hasValue) options.threads = std::max(::atoi(argv[++i]), 0);
+		else if (arg == "-d" && hasValue) options.depth = static_cast<size_t>(std::max(::atoi(argv[++i]), 1));
+		else if (arg == "-o" && hasValue) outputFile = argv[++i];
+		else if (arg == "-s" && hasValue) statsSeconds = std::max(::atoi(argv[++i]), 0);
+		else if (arg == "-J") statsFormat = MetricsFormat::Json;
+		else if (arg == "-v") options.isVoting = true;
+		else if (arg == "-R" && hasValue) options.recordFile = argv[++i];
+		else if (arg == "-e" && hasValue) eventFile = argv[++i];
+		else if (arg == "-u" && hasValue) eventSocket = argv[++i];
+		else if (arg == "-b") eventFormat = EventFormat::Binary;
+		else if (arg == "-m" && hasValue) options.modelFile = argv[++i];
+		else if (arg == "-c" && hasValue) options.classFile = argv[++i];
+		else if (arg == "-i" && hasValue) options.imageFile = argv[++i];
+		else if (arg == "-X") isConvert = true;
+		else if (!arg.empty() && arg[0] == '-') {
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else files.push_back(arg);
+	}
+
+	// 只轉換字元辨識模型 (XML 訓練資料轉為可映射載入的二進位模型檔)
+	if (isConvert) {
+		if (options.modelFile.empty() || options.classFile.empty() || options.imageFile.empty() || !files.empty()) {
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		if (!CarPlateOcr::ConvertXml(options.classFile, options.imageFile, options.modelFile.c_str())) {
+			::fprintf(stderr, "cannot convert OCR model: %s\n", options.modelFile.c_str());
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	if (files.empty() || (!options.recordFile.empty() && files.size() != 1)) {
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream fileOutput;
+	if (outputFile != nullptr) {
+		fileOutput.open(outputFile, std::ios::out | std::ios::trunc);
+		if (!fileOutput.is_open()) {
+			::fprintf(stderr, "cannot open output file: %s\n", outputFile);
+			return EXIT_FAILURE;
+		}
+	}
+	std::ostream& output = (outputFile != nullptr) ? static_cast<std::ostream&>(fileOutput) : std::cout;
+
+	// 偵測事件由背景 thread 批次寫入，job threads 只放入佇列
+	CarEventWriter events;
+	std::vector<std::string> vecSinkNames;
+	if (eventFile != nullptr) {
+		std::unique_ptr<CarFileEventSink> sink(new (std::nothrow) CarFileEventSink());
+		if (sink == nullptr || !sink->Open(eventFile)) {
+			::fprintf(stderr, "cannot open event file: %s\n", eventFile);
+			return EXIT_FAILURE;
+		}
+		events.AddSink(std::move(sink));
+		vecSinkNames.push_back(std::string("file ") + eventFile);
+	}
+	if (eventSocket != nullptr) {
+		std::unique_ptr<CarSocketEventSink> sink(new (std::nothrow) CarSocketEventSink());
+		if (sink == nullptr || !sink->Open(eventSocket)) {
+			::fprintf(stderr, "invalid event socket: %s\n", eventSocket);
+			return EXIT_FAILURE;
+		}
+		events.AddSink(std::move(sink));
+		vecSinkNames.push_back(std::string("socket ") + eventSocket);
+	}
+	if (events.GetSinkCount() > 0) {
+		if (!events.Start(eventFormat)) {
+			::fprintf(stderr, "cannot start event writer\n");
+			return EXIT_FAILURE;
+		}
+		options.eventsPtr = &events;
+	}
+
+	CarBatchRunner runner;
+	if (statsSeconds > 0) {
+		runner.GetMetrics().StartDump(std::cerr, statsSeconds * 1000, statsFormat);
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const bool isSuccess = runner.Run(files, output, options);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	runner.GetMetrics().StopDump();
+	events.Stop();
+
+	const double seconds = elapsed.count();
+	::fprintf(stderr, "files: %zu (failed %llu), frames: %llu, detections: %llu, %.2f s, %.1f fps\n",
+		files.size(),
+		static_cast<unsigned long long>(runner.GetFailed()),
+		static_cast<unsigned long long>(runner.GetFrames()),
+		static_cast<unsigned long long>(runner.GetDetections()),
+		seconds,
+		seconds > 0.0 ? static_cast<double>(runner.GetFrames()) / seconds : 0.0);
+	if (options.eventsPtr != nullptr) {
+		::fprintf(stderr, "events: %llu posted, %llu dropped\n",
+			static_cast<unsigned long long>(events.GetPosted()),
+			static_cast<unsigned long long>(events.GetDropped()));
+		// 各輸出端分別計數，例如 socket 未連接時檔案輸出仍計入已寫入
+		for (size_t i = 0; i < events.GetSinkCount(); i++) {
+			const CarEventSink* sinkPtr = events.GetSink(i);
+			::fprintf(stderr, "  %s: %llu written, %llu failed\n", vecSinkNames[i].c_str(),
+				static_cast<unsigned long long>(sinkPtr->GetWritten()),
+				static_cast<unsigned long long>(sinkPtr->GetFailed()));
+		}
+	}
+	runner.GetMetrics().Dump(std::cerr, statsFormat);
+	return isSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+}
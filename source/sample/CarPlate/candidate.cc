@@ -0,0 +1,255 @@
+﻿/**************************************************************************//**
+ * @file	candidate.cc
+ * @brief	CarCandidateFilter 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "candidate.hh"
+
+/**
+ *	@brief	CarAreaRule 建構式
+ *	@param[in]	minRatio	面積比例下限
+ *	@param[in]	maxRatio	面積比例上限
+ *	@return	此函數沒有返回值
+ */
+CarAreaRule::CarAreaRule(float minRatio, float maxRatio)
+	: m_fMinRatio(minRatio)
+	, m_fMaxRatio(maxRatio) {
+}
+
+/**
+ *	@brief	[重載] 外接矩形面積佔畫面比例需落於上下限之間
+ */
+float CarAreaRule::Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate)
+{
+	(void)candidate;
+	const auto& comp = context.components;
+	const float frameArea = static_cast<float>(context.frameSize.area());
+	const float ratio = static_cast<float>(comp.width[index] * comp.height[index]) / frameArea;
+	return (ratio >= m_fMinRatio && ratio <= m_fMaxRatio) ? 1.0f : 0.0f;
+}
+
+/**
+ *	@brief	CarAspectRule 建構式
+ *	@param[in]	tolerance	長寬比容許誤差 (比例)
+ *	@return	此函數沒有返回值
+ */
+CarAspectRule::CarAspectRule(float tolerance)
+	: m_fTolerance(tolerance) {
+}
+
+/**
+ *	@brief	[重載] 比對新、舊式車牌長寬比，誤差越小分數越高，並設定候選車牌規格
+ */
+float CarAspectRule::Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate)
+{
+	static const float aspectOld = static_cast<float>(CAR_PLATE_OLDPLATE_WD) / CAR_PLATE_OLDPLATE_HT;
+	static const float aspectNew = static_cast<float>(CAR_PLATE_NEWPLATE_WD) / CAR_PLATE_NEWPLATE_HT;
+
+	const auto& comp = context.components;
+	const float aspect = static_cast<float>(comp.width[index]) / static_cast<float>(comp.height[index]);
+	const float errOld = ::fabsf(aspect - aspectOld) / aspectOld;
+	const float errNew = ::fabsf(aspect - aspectNew) / aspectNew;
+	const float err = std::min(errOld, errNew);
+
+	if (err > m_fTolerance) {
+		return 0.0f;
+	}
+
+	candidate.type = (errOld < errNew) ? PlateType::Old : PlateType::New;
+	return 1.0f - 0.5f * err / m_fTolerance;
+}
+
+/**
+ *	@brief	CarFillRule 建構式
+ *	@param[in]	minFill	填充率下限
+ *	@param[in]	maxFill	填充率上限
+ *	@return	此函數沒有返回值
+ */
+CarFillRule::CarFillRule(float minFill, float maxFill)
+	: m_fMinFill(minFill)
+	, m_fMaxFill(maxFill) {
+}
+
+/**
+ *	@brief	[重載] 元件填充率需落於上下限之間 (排除實心色塊與零散雜訊)
+ */
+float CarFillRule::Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate)
+{
+	(void)candidate;
+	const float fill = context.components.fill[index];
+	return (fill >= m_fMinFill && fill <= m_fMaxFill) ? 1.0f : 0.0f;
+}
+
+/**
+ *	@brief	CarCharDensityRule 建構式
+ *	@param[in]	minChars	最少字元數量
+ *	@param[in]	maxChars	最多字元數量
+ *	@return	此函數沒有返回值
+ */
+CarCharDensityRule::CarCharDensityRule(int minChars, int maxChars)
+	: m_nMinChars(minChars)
+	, m_nMaxChars(maxChars) {
+}
+
+/**
+ *	@brief	[重載] 挑出外型類似字元的元件，並依重心 X 排序以便區間查詢
+ */
+void CarCharDensityRule::Prepare(const CarCandidateContext& context)
+{
+	const auto& comp = context.components;
+	const size_t count = comp.Count();
+
+	m_vecChars.clear();
+	for (size_t i = 0; i < count; i++) {
+		// 字元為直立矩形，高度至少 8 pixel
+		if (comp.height[i] < 8 || comp.height[i] < comp.width[i]) continue;
+		if (comp.height[i] > comp.width[i] * 8) continue;
+		m_vecChars.push_back(static_cast<int>(i));
+	}
+
+	std::sort(m_vecChars.begin(), m_vecChars.end(), [&comp](int a, int b) { return comp.cx[a] < comp.cx[b]; });
+	m_vecCharsX.resize(m_vecChars.size());
+	for (size_t i = 0; i < m_vecChars.size(); i++) {
+		m_vecCharsX[i] = comp.cx[m_vecChars[i]];
+	}
+}
+
+/**
+ *	@brief	[重載] 計算候選區域內高度合理的類字元元件數量
+ */
+float CarCharDensityRule::Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate)
+{
+	const auto& comp = context.components;
+	const cv::Rect& rect = candidate.rect;
+	const float x0 = static_cast<float>(rect.x);
+	const float x1 = static_cast<float>(rect.x + rect.width);
+	const float y0 = static_cast<float>(rect.y);
+	const float y1 = static_cast<float>(rect.y + rect.height);
+	const int minHeight = rect.height * 35 / 100;
+	const int maxHeight = rect.height * 95 / 100;
+	int chars = 0;
+
+	auto it = std::lower_bound(m_vecCharsX.begin(), m_vecCharsX.end(), x0);
+	for (auto i = static_cast<size_t>(it - m_vecCharsX.begin()); i < m_vecCharsX.size() && m_vecCharsX[i] < x1; i++) {
+		const int c = m_vecChars[i];
+		if (static_cast<size_t>(c) == index) continue;
+		if (comp.cy[c] < y0 || comp.cy[c] >= y1) continue;
+		if (comp.height[c] < minHeight || comp.height[c] > maxHeight) continue;
+		chars++;
+	}
+
+	if (chars < 2) return 0.0f;
+	if (chars < m_nMinChars) return static_cast<float>(chars) / static_cast<float>(m_nMinChars);
+	if (chars > m_nMaxChars) return static_cast<float>(m_nMaxChars) / static_cast<float>(chars);
+	return 1.0f;
+}
+
+/**
+ *	@brief	CarCandidateFilter 建構式，並載入預設規則
+ *	@return	此函數沒有返回值
+ */
+CarCandidateFilter::CarCandidateFilter()
+{
+	this->SetDefaultRules();
+}
+
+/**
+ *	@brief	CarCandidateFilter 解構式
+ *	@return	此函數沒有返回值
+ */
+CarCandidateFilter::~CarCandidateFilter() {}
+
+/**
+ *	@brief	加入篩選規則 (依加入順序執行)
+ *	@param[in]	rule	篩選規則物件
+ *	@return	此函數沒有返回值
+ */
+void CarCandidateFilter::AddRule(std::unique_ptr<CarCandidateRule> rule)
+{
+	if (rule != nullptr) {
+		m_vecRules.push_back(std::move(rule));
+	}
+}
+
+/**
+ *	@brief	清除所有篩選規則
+ *	@return	此函數沒有返回值
+ */
+void CarCandidateFilter::ClearRules()
+{
+	m_vecRules.clear();
+}
+
+/**
+ *	@brief	設定預設篩選規則: 面積、長寬比、填充率、字元密度
+ *	@return	此函數沒有返回值
+ */
+void CarCandidateFilter::SetDefaultRules()
+{
+	this->ClearRules();
+	this->AddRule(std::unique_ptr<CarCandidateRule>(new CarAreaRule()));
+	this->AddRule(std::unique_ptr<CarCandidateRule>(new CarAspectRule()));
+	this->AddRule(std::unique_ptr<CarCandidateRule>(new CarFillRule()));
+	this->AddRule(std::unique_ptr<CarCandidateRule>(new CarCharDensityRule()));
+}
+
+/**
+ *	@brief	篩選車牌候選區域
+ *	@param[in]	components	CarComponents 物件參考，當前幀連通元件統計資料。
+ *	@param[in]	frameSize	影像大小
+ *	@param[out]	candidates	存放候選區域 (依分數由高至低排列)
+ *	@param[in]	topK		最多輸出數量
+ *	@return	<b>型別: size_t</b> \n 輸出的候選區域數量
+ *	@remark	重疊 (內、外框) 的候選區域只保留分數最高者。
+ */
+size_t CarCandidateFilter::Filter(const CarComponents& components, cv::Size frameSize, std::vector<CarPlateCandidate>& candidates, size_t topK)
+{
+	const CarCandidateContext context = { components, frameSize };
+	const size_t count = components.Count();
+
+	candidates.clear();
+	m_vecScored.clear();
+	if (frameSize.area() <= 0 || topK == 0) {
+		return 0;
+	}
+
+	for (auto& rule : m_vecRules) {
+		rule->Prepare(context);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		CarPlateCandidate candidate = { components.Rect(i), 1.0f, static_cast<int>(i), PlateType::Unknown, -1 };
+
+		for (auto& rule : m_vecRules) {
+			candidate.score *= rule->Score(context, i, candidate);
+			if (candidate.score <= 0.0f) break;
+		}
+
+		if (candidate.score > 0.0f) {
+			m_vecScored.push_back(candidate);
+		}
+	}
+
+	std::sort(m_vecScored.begin(), m_vecScored.end(), [](const CarPlateCandidate& a, const CarPlateCandidate& b) {
+		return a.score > b.score;
+	});
+
+	for (const auto& candidate : m_vecScored) {
+		bool overlapped = false;
+		for (const auto& accepted : candidates) {
+			const int inter = (candidate.rect & accepted.rect).area();
+			if (inter * 10 > std::min(candidate.rect.area(), accepted.rect.area()) * 7) {
+				overlapped = true;
+				break;
+			}
+		}
+
+		if (!overlapped) {
+			candidates.push_back(candidate);
+			if (candidates.size() >= topK) break;
+		}
+	}
+	return candidates.size();
+}
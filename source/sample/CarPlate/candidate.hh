@@ -0,0 +1,155 @@
+﻿/**************************************************************************//**
+ * @file	candidate.hh
+ * @brief	CarCandidateFilter 車牌候選區域篩選類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_CANDIDATE_HH
+#define	ODMC_CARPLATE_CANDIDATE_HH
+#include <memory>
+#include "labeling.hh"
+
+/**
+ *	@enum	PlateType
+ *	@brief	車牌規格列表
+ */
+enum class PlateType {
+	Unknown = 0,		//!< 未判定
+	Old,				//!< 舊式車牌 (32 x 15 cm)
+	New,				//!< 新式車牌 (38 x 16 cm)
+};
+
+/**
+ *	@struct	CarPlateCandidate
+ *	@brief	車牌候選區域
+ */
+struct CarPlateCandidate {
+	cv::Rect	rect;		//!< 候選區域外接矩形
+	float		score;		//!< 候選分數 (0 ~ 1)
+	int			component;	//!< 對應連通元件編號
+	PlateType	type;		//!< 最接近的車牌規格
+	int			track;		//!< 車牌軌跡編號 (-1 = 未追蹤)
+};
+
+/**
+ *	@struct	CarCandidateContext
+ *	@brief	候選篩選共用資訊 (每幀一份)
+ */
+struct CarCandidateContext {
+	const CarComponents&	components;		//!< 當前幀連通元件統計資料
+	cv::Size				frameSize;		//!< 影像大小
+};
+
+/**
+ *	@class	CarCandidateRule
+ *	@brief	候選篩選規則介面，可自行繼承並加入 CarCandidateFilter
+ */
+class CarCandidateRule
+{
+public:
+	virtual ~CarCandidateRule() {}
+
+	/**
+	 *	@brief	每幀篩選前呼叫一次，可用來建立規則所需的索引
+	 *	@param[in]	context	候選篩選共用資訊
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Prepare(const CarCandidateContext& context) { (void)context; }
+
+	/**
+	 *	@brief	計算元件分數
+	 *	@param[in]		context		候選篩選共用資訊
+	 *	@param[in]		index		元件編號
+	 *	@param[in,out]	candidate	候選資料，規則可補充候選資訊 (如車牌規格)
+	 *	@return	<b>型別: float</b> \n 分數 0 ~ 1，返回值為零時直接淘汰該元件。
+	 */
+	virtual float Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate) = 0;
+};
+
+/**
+ *	@class	CarAreaRule
+ *	@brief	外接矩形面積篩選 (佔畫面比例)
+ */
+class CarAreaRule : public CarCandidateRule
+{
+public:
+	CarAreaRule(float minRatio = CAR_CANDIDATE_AREA_MIN, float maxRatio = CAR_CANDIDATE_AREA_MAX);
+	float Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate) override;
+
+private:
+	float m_fMinRatio;		//!< 面積比例下限
+	float m_fMaxRatio;		//!< 面積比例上限
+};
+
+/**
+ *	@class	CarAspectRule
+ *	@brief	長寬比篩選，比對新、舊式車牌實際尺寸
+ */
+class CarAspectRule : public CarCandidateRule
+{
+public:
+	CarAspectRule(float tolerance = CAR_CANDIDATE_ASPECT_TOL);
+	float Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate) override;
+
+private:
+	float m_fTolerance;		//!< 長寬比容許誤差 (比例)
+};
+
+/**
+ *	@class	CarFillRule
+ *	@brief	元件填充率篩選
+ */
+class CarFillRule : public CarCandidateRule
+{
+public:
+	CarFillRule(float minFill = CAR_CANDIDATE_FILL_MIN, float maxFill = CAR_CANDIDATE_FILL_MAX);
+	float Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate) override;
+
+private:
+	float m_fMinFill;		//!< 填充率下限
+	float m_fMaxFill;		//!< 填充率上限
+};
+
+/**
+ *	@class	CarCharDensityRule
+ *	@brief	字元群集密度篩選，計算候選區域內類字元元件數量
+ */
+class CarCharDensityRule : public CarCandidateRule
+{
+public:
+	CarCharDensityRule(int minChars = CAR_CANDIDATE_CHARS_MIN, int maxChars = CAR_CANDIDATE_CHARS_MAX);
+	void Prepare(const CarCandidateContext& context) override;
+	float Score(const CarCandidateContext& context, size_t index, CarPlateCandidate& candidate) override;
+
+private:
+	int m_nMinChars;					//!< 最少字元數量
+	int m_nMaxChars;					//!< 最多字元數量
+	std::vector<int>	m_vecChars;		//!< 類字元元件編號 (依重心 X 排序)
+	std::vector<float>	m_vecCharsX;	//!< 類字元元件重心 X (與 m_vecChars 對應)
+};
+
+/**
+ *	@class	CarCandidateFilter
+ *	@brief	車牌候選區域篩選，依規則計分後輸出前 K 名候選區域
+ */
+class CarCandidateFilter
+{
+public:
+	CarCandidateFilter();
+	virtual ~CarCandidateFilter();
+
+	void AddRule(std::unique_ptr<CarCandidateRule> rule);
+	void ClearRules();
+	void SetDefaultRules();
+	size_t Filter(const CarComponents& components, cv::Size frameSize, std::vector<CarPlateCandidate>& candidates, size_t topK = CAR_CANDIDATE_TOPK);
+
+private:
+	CarCandidateFilter(const CarCandidateFilter&) = delete;				//!< Disable copy construction
+	CarCandidateFilter& operator=(const CarCandidateFilter&) = delete;	//!< Disable assignment operator
+
+	std::vector<std::unique_ptr<CarCandidateRule> >	m_vecRules;		//!< 篩選規則 (依序執行，便宜的規則放前面)
+	std::vector<CarPlateCandidate>					m_vecScored;	//!< 通過規則的候選暫存
+};
+
+#endif // !ODMC_CARPLATE_CANDIDATE_HH
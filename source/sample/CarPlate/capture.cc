@@ -0,0 +1,175 @@
+﻿/**************************************************************************//**
+ * @file	capture.cc
+ * @brief	CarCapture 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "capture.hh"
+
+/**
+ *	@brief	CarCapture 建構式
+ *	@return	此函數沒有返回值
+ */
+CarCapture::CarCapture()
+	: m_channelPtr(nullptr)
+	, m_poolPtr(nullptr)
+	, m_metricsPtr(nullptr)
+	, m_isKeep(false)
+	, m_isReset(false)
+	, m_isEnded(false)
+	, m_cProcCapture(nullptr) {
+}
+
+/**
+ *	@brief	CarCapture 解構式
+ *	@return	此函數沒有返回值
+ */
+CarCapture::~CarCapture()
+{
+	this->Stop();
+}
+
+/**
+ *	@brief	開始擷取影像
+ *	@param[in]	url		串流網址、影像檔案路徑、錄製檔 (replay:<path>)、合成影像 (synthetic:[<寬>x<高>][@<幀數>])
+ *						或斷線模擬 (flaky:<幀數>,<失敗次數>[,<阻塞 ms>]:<網址>)
+ *	@param[in]	channel	影像傳輸通道 (必須比擷取 thread 更晚銷毀)
+ *	@param[in]	pool	影像緩衝池 (必須比擷取 thread 更晚銷毀)
+ *	@param[in]	options	影像擷取選項
+ *	@return	<b>型別: bool</b> \n 若擷取 thread 啟動成功返回值為非零值 (true)。 \n 若啟動失敗返回值為零 (false)。
+ */
+bool CarCapture::Start(const cv::String& url, CarFrameChannel& channel, CarFramePool& pool, const CarCaptureOptions& options)
+{
+	this->Stop();
+
+	m_strUrl = url;
+	m_sOptions = options;
+	m_channelPtr = &channel;
+	m_poolPtr = &pool;
+	m_isReset.store(false);
+	m_isEnded.store(false);
+	m_isKeep.store(true);
+	m_cConnection.Reset(options, &channel, m_metricsPtr);
+
+	m_cProcCapture = new (std::nothrow) std::thread(&CarCapture::CaptureProcess, this);
+	if (m_cProcCapture == nullptr) {
+		m_isKeep.store(false);
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	停止擷取影像，等候擷取 thread 結束。
+ *	@return	此函數沒有返回值
+ *	@remark	Block 模式的傳輸通道需由呼叫端先行關閉，避免擷取 thread 停在放入影像。
+ */
+void CarCapture::Stop()
+{
+	m_isKeep.store(false);
+	m_cConnection.Interrupt();
+
+	if (m_cProcCapture != nullptr) {
+		if (m_cProcCapture->joinable()) {
+			m_cProcCapture->join();
+		}
+	}
+	SAFE_DELETE(m_cProcCapture);
+}
+
+/**
+ *	@brief	Video caputre thread process
+ *	@param[in]	cThisPtr	(指標) CarCapture 物件
+ *	@return	此函數沒有返回值
+ *	@remark	佇列已滿時丟棄最舊的影像 (DropOldest)，信箱則直接覆寫尚未取出的影像。
+ *			重新連接的退避等待在此 thread 進行，停止擷取時立即中斷。
+ */
+void CarCapture::CaptureProcess(CarCapture* cThisPtr)
+{
+	const auto& options = cThisPtr->m_sOptions;
+	auto& camChannel = *cThisPtr->m_channelPtr;
+	auto& camPool = *cThisPtr->m_poolPtr;
+	auto metricsPtr = cThisPtr->m_metricsPtr;
+	auto& connection = cThisPtr->m_cConnection;
+
+	// 依網址建立影像來源 (串流、影像檔案、錄製檔重播或合成影像)
+	std::unique_ptr<CarFrameSource> source(CarFrameSource::Create(cThisPtr->m_strUrl, options));
+	if (source == nullptr) {
+		connection.OnEnded();
+		cThisPtr->m_isEnded.store(true);
+		return;
+	}
+	source->SetMetrics(metricsPtr);
+
+	// 錄製送出的原始影像與時間戳記 (供重播來源重現相同輸入)
+	CarFrameRecorder recorder;
+	if (!options.recordFile.empty()) {
+		recorder.Open(options.recordFile.c_str());
+	}
+
+	CarFrame frame;
+	while (cThisPtr->m_isKeep.load() == true) {
+		// 影像來源尚未開啟 (或重新連接)，開啟失敗時已等待退避時間
+		if (!connection.IsConnected()) {
+			if (!connection.Connect(*source)) {
+				continue;
+			}
+			cThisPtr->m_isReset.store(true);
+		}
+
+		const SourceRead result = source->Read(frame, camPool);
+
+		// 錄製檔或合成影像播放完畢
+		if (result == SourceRead::End) {
+			connection.OnEnded();
+			cThisPtr->m_isEnded.store(true);
+			break;
+		}
+
+		// 尚未到達重播時間，重新檢查執行識別
+		if (result == SourceRead::Pending) {
+			continue;
+		}
+
+		// 依解碼模式跳過的幀 (仍依原始速度播放)
+		if (result == SourceRead::Skipped) {
+			if (metricsPtr != nullptr) {
+				metricsPtr->AddSkipped();
+			}
+			connection.OnSkipped();
+			if (options.pacingMs > 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(options.pacingMs));
+			}
+			continue;
+		}
+
+		// 沒有擷取到影像，連續失敗達到上限時關閉來源並等待退避時間
+		if (result != SourceRead::Frame || frame.Empty()) {
+			frame.Release();
+			if (!connection.OnFailure(*source)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			continue;
+		}
+
+		// 將影像放入傳輸通道，緩衝區所有權交由偵測端，被丟棄、覆寫或換回的緩衝區歸還緩衝池。
+		if (recorder.IsOpened()) {
+			recorder.Write(frame);
+		}
+		if (metricsPtr != nullptr) {
+			metricsPtr->AddCaptured();
+		}
+		connection.OnFrame();
+		camChannel.Push(frame);
+		frame.Release();
+
+		if (options.pacingMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(options.pacingMs));
+		}
+	}
+
+	// thread 持續運作關閉, 關閉影像來源與錄製檔
+	source->Close();
+	recorder.Close();
+}
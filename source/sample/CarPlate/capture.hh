@@ -0,0 +1,52 @@
+﻿/**************************************************************************//**
+ * @file	capture.hh
+ * @brief	CarCapture 影像擷取類別宣告 Header (不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_CAPTURE_HH
+#define	ODMC_CARPLATE_CAPTURE_HH
+#include "connection.hh"
+
+/**
+ *	@class	CarCapture
+ *	@brief	影像擷取 thread，影像直接解碼至緩衝池緩衝區後放入傳輸通道
+ *	@remark	每幀附加來源幀序 (串流重新連接後由 0 起算) 與時間戳記。依解碼模式跳過的幀只呼叫 grab
+ *			(解碼器仍會解碼該幀)，不進行色彩轉換、縮放與緩衝區複製，計入跳過幀數。開啟失敗或連續讀取失敗時由 CarConnection
+ *			以抖動指數退避重新連接，連線狀態經由傳輸通道發布給偵測端。
+ */
+class CarCapture
+{
+public:
+	CarCapture();
+	virtual ~CarCapture();
+
+	bool Start(const cv::String& url, CarFrameChannel& channel, CarFramePool& pool, const CarCaptureOptions& options = CarCaptureOptions());
+	void Stop();
+	bool IsRunning() const { return m_cProcCapture != nullptr; }
+	bool FetchReset() { return m_isReset.exchange(false); }
+	bool IsEnded() const { return m_isEnded.load(); }
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; }
+	SourceHealth GetHealth() const { return (m_channelPtr != nullptr) ? m_channelPtr->GetHealth() : SourceHealth::Idle; }
+	uint64_t GetReconnects() const { return m_cConnection.GetReconnects(); }
+	uint64_t GetOpenFailures() const { return m_cConnection.GetOpenFailures(); }
+
+private:
+	CarCapture(const CarCapture&) = delete;				//!< Disable copy construction
+	CarCapture& operator=(const CarCapture&) = delete;	//!< Disable assignment operator
+	static void CaptureProcess(CarCapture* cThisPtr);
+
+	cv::String			m_strUrl;			//!< 串流網址或影像檔案路徑
+	CarCaptureOptions	m_sOptions;			//!< 影像擷取選項
+	CarFrameChannel*	m_channelPtr;		//!< 影像傳輸通道
+	CarFramePool*		m_poolPtr;			//!< 影像緩衝池
+	CarStreamMetrics*	m_metricsPtr;		//!< 擷取與解碼計時 (可為 nullptr，啟動前設定)
+	CarConnection		m_cConnection;		//!< 影像來源連線管理
+	std::atomic<bool>	m_isKeep;			//!< 持續擷取識別 (keep running thread process)
+	std::atomic<bool>	m_isReset;			//!< 串流重新連接識別 (影像規格可能改變)
+	std::atomic<bool>	m_isEnded;			//!< 影像來源已結束識別 (錄製檔或合成影像播放完畢)
+	std::thread*		m_cProcCapture;		//!< 影像擷取 process
+};
+
+#endif // !ODMC_CARPLATE_CAPTURE_HH
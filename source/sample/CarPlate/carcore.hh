@@ -0,0 +1,140 @@
+﻿/**************************************************************************//**
+ * @file	carcore.hh
+ * @brief	CarPlate 影像處理核心 (CarPlateCore 靜態程式庫) 前置定義 Header (不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_CARCORE_HH
+#define	ODMC_CARPLATE_CARCORE_HH
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "opencv2/opencv.hpp"
+
+#if defined(_MSC_VER)
+#	if defined(_WIN64)
+#		if defined(_DEBUG)
+#			pragma comment(lib, "opencv_world412d")
+#			pragma comment(lib, "x64/debug/CarPlateCore")
+#		else
+#			pragma comment(lib, "opencv_world412")
+#			pragma comment(lib, "x64/release/CarPlateCore")
+#		endif
+#	else
+#		pragma message("Please using Win64 compiler...")
+#	endif
+#endif
+
+// 不引用 opendmc 時 (非 Windows 平台) 使用的物件釋放巨集
+#ifndef SAFE_DELETE
+#define SAFE_DELETE(p)			{ if (nullptr!=(p))  { delete (p); (p)=nullptr; } }
+#endif
+
+#define CAR_PLATE_OLDPLATE_WD	32	//!< 舊式車牌寬度 (cm)
+#define	CAR_PLATE_OLDPLATE_HT	15	//!< 舊式車牌高度 (cm)
+
+#define CAR_PLATE_NEWPLATE_WD	38	//!< 新式車牌寬度 (cm)
+#define	CAR_PLATE_NEWPLATE_HT	16	//!< 新式車牌高度 (cm)
+
+#define CAR_PLATE_BLUE_WD		11	//!< 進行平滑寬度
+#define	CAR_PLATE_BLUE_HT		5	//!< 進行平滑高度
+
+#define CAR_PLATE_THRESH_BLOCK_SIZE	19
+#define CAR_PLATE_THRESH_WEIGHT		9
+
+#define CAR_LABEL_BAND_ROWS		64	//!< 連通元件標記，每個列帶最少列數
+
+#define CAR_CANDIDATE_TOPK			4		//!< 每幀最多輸出車牌候選區域數量
+#define CAR_CANDIDATE_ASPECT_TOL	0.35f	//!< 車牌長寬比容許誤差 (比例)
+#define CAR_CANDIDATE_AREA_MIN		0.001f	//!< 候選外接矩形面積下限 (佔畫面比例)
+#define CAR_CANDIDATE_AREA_MAX		0.08f	//!< 候選外接矩形面積上限 (佔畫面比例)
+#define CAR_CANDIDATE_FILL_MIN		0.05f	//!< 候選元件填充率下限
+#define CAR_CANDIDATE_FILL_MAX		0.85f	//!< 候選元件填充率上限
+#define CAR_CANDIDATE_CHARS_MIN		4		//!< 候選區域內最少字元數量
+#define CAR_CANDIDATE_CHARS_MAX		8		//!< 候選區域內最多字元數量
+
+#define CAR_OCR_CHAR_WD			20		//!< 字元訓練影像寬度 (pixel)
+#define CAR_OCR_CHAR_HT			30		//!< 字元訓練影像高度 (pixel)
+#define CAR_OCR_MAX_CHARS		8		//!< 車牌最多字元數量
+#define CAR_OCR_NEIGHBORS		1		//!< k-NN 預設鄰居數量
+#define CAR_OCR_ALIGN			64		//!< 訓練特徵列對齊 (bytes)
+
+#define CAR_RING_CAPACITY		32		//!< 擷取與偵測之間的環形佇列容量 (幀)
+#define CAR_RING_WAIT_MS		100		//!< 環形佇列休眠等待上限 (ms)，逾時後重新檢查執行識別
+#define CAR_POOL_MAX_FREE		40		//!< 影像緩衝池每種規格最多保留的閒置緩衝區數量
+#define CAR_CAPTURE_ERROR_LIMIT	90		//!< 連續擷取失敗上限，超過時重新連接串流
+#define CAR_CAPTURE_KEYFRAME_INTERVAL	30	//!< 無法查詢關鍵影格時預估的關鍵影格間隔 (幀)
+#define CAR_CAPTURE_BACKOFF_MIN_MS	100		//!< 重新連接等待時間下限 (ms)，每次連續失敗加倍
+#define CAR_CAPTURE_BACKOFF_MAX_MS	30000	//!< 重新連接等待時間上限 (ms)
+#define CAR_CAPTURE_STABLE_MS	10000	//!< 連續收到影像超過此時間才視為連線穩定並重設等待時間 (ms)
+#define CAR_CAPTURE_STALL_MS	2000	//!< 超過此時間沒有收到影像時通知偵測端影像來源停滯 (ms)
+
+#define CAR_SYNTH_WIDTH			1280	//!< 合成影像預設寬度 (pixel)
+#define CAR_SYNTH_HEIGHT		720		//!< 合成影像預設高度 (pixel)
+#define CAR_SYNTH_FPS			30		//!< 合成影像時間戳記幀率
+#define CAR_SYNTH_SEED			20261019	//!< 合成影像亂數種子 (背景與車牌文字)
+#define CAR_SYNTH_PASS_FRAMES	90		//!< 合成影像每面車牌橫越畫面的幀數
+#define CAR_SYNTH_GAP_FRAMES	30		//!< 合成影像兩面車牌之間的空白幀數
+#define CAR_SYNTH_PLATE_WD		240		//!< 合成車牌寬度 (pixel，高度為寬度的 1/4)
+
+#define CAR_STAGE_DEPTH			4		//!< stage graph 同時處理中的幀數上限
+#define CAR_BATCH_DEPTH			8		//!< 批次偵測每個檔案同時處理中的幀數上限
+
+#define CAR_RATE_MAX_INTERVAL_MS	1000	//!< 速率控制預設最大處理間隔 (ms)
+#define CAR_RATE_COST_ALPHA			0.1		//!< 處理成本指數移動平均權重
+#define CAR_RATE_LATENCY_ALPHA		0.2		//!< 端到端延遲指數移動平均權重
+#define CAR_RATE_BACKOFF			1.25	//!< 延遲超過上限時每幀放大間隔的倍數
+#define CAR_RATE_BACKOFF_MAX		16.0	//!< 間隔放大倍數上限
+#define CAR_RATE_RECOVER			0.95	//!< 延遲恢復後每幀縮小間隔倍數的比例
+#define CAR_RATE_RECOVER_LEVEL		0.8		//!< 延遲低於上限此比例時開始恢復
+
+#define CAR_MOTION_SCALE			8		//!< 畫面變化偵測亮度平面縮小倍數
+#define CAR_MOTION_THRESHOLD		20		//!< 畫面變化偵測像素亮度差值門檻
+#define CAR_MOTION_ON_RATIO			0.004	//!< 變化像素比例達到此值視為有變化
+#define CAR_MOTION_OFF_RATIO		0.002	//!< 變化像素比例低於此值視為靜止
+#define CAR_MOTION_ON_FRAMES		2		//!< 連續變化幀數達到此值開始偵測
+#define CAR_MOTION_HOLD_FRAMES		15		//!< 連續靜止幀數達到此值停止偵測
+#define CAR_MOTION_LEARN_SHIFT		4		//!< 背景模型學習速率 (每幀逼近差值的 1 / 2^N)
+
+#define CAR_TRACK_FULL_SCAN_FRAMES	15		//!< 車牌追蹤每隔此幀數搜尋全畫面一次
+#define CAR_TRACK_MARGIN			0.5		//!< 搜尋區域向外擴張比例 (車牌寬高倍數)
+#define CAR_TRACK_PADDING			24		//!< 搜尋區域最少向外擴張 pixel 數量 (涵蓋平滑化與自適應閥值區塊)
+#define CAR_TRACK_MAX_MISSES		3		//!< 連續未找到幀數超過此值時移除軌跡
+#define CAR_TRACK_MAX_AREA			0.5		//!< 搜尋區域面積超過畫面此比例時搜尋全畫面
+#define CAR_TRACK_MAX_TRACKS		8		//!< 同時追蹤的車牌數量上限
+#define CAR_TRACK_GAIN				0.5f	//!< 軌跡速度依預測誤差修正的權重
+#define CAR_TRACK_RATIO_ALPHA		0.1		//!< 搜尋面積比例指數移動平均權重
+
+#define CAR_VOTE_MIN_FRAMES			3		//!< 車牌軌跡至少辨識此幀數才輸出事件
+#define CAR_VOTE_SATURATION_FRAMES	12		//!< 辨識幀數達到此值且信心值飽和時提前輸出
+#define CAR_VOTE_SATURATION			0.8f	//!< 提前輸出的投票信心值門檻
+#define CAR_VOTE_END_FRAMES			15		//!< 車牌軌跡此幀數未出現視為結束
+#define CAR_VOTE_SUPPRESS_FRAMES	900		//!< 同一車牌文字於此幀數內不重複輸出
+#define CAR_VOTE_MAX_TRACKS			16		//!< 同時投票的軌跡數量上限
+#define CAR_VOTE_RECENT_PLATES		64		//!< 最近輸出車牌 LRU 容量
+
+#define CAR_PREPROCESS_TILED		1		//!< 預設使用分塊融合預處理 (0 = 分段處理)
+#define CAR_TILE_CACHE_BYTES		(1024 * 1024)	//!< 分塊預處理每個區塊工作集上限 (約為 L2 快取大小)
+#define CAR_TILE_PIXEL_BYTES		17		//!< 分塊預處理每個 pixel 使用的 bytes (BGR 輸入、6 個 8-bit 與 2 個 float 暫存)
+#define CAR_TILE_MIN_ROWS			32		//!< 分塊預處理每個區塊最少輸出列數
+#define CAR_TILE_HALO				(2 + CAR_PLATE_BLUE_HT / 2 + CAR_PLATE_THRESH_BLOCK_SIZE / 2)	//!< 區塊上下重疊列數 (對比 + 平滑化 + 自適應閥值半徑)
+#define CAR_PARALLEL_THREADS		0		//!< 單幀平行處理 (分塊預處理與連通元件列帶) 使用的 thread 數量，0 = 所有核心
+
+#define CAR_EVENT_QUEUE_CAPACITY	4096	//!< 偵測事件佇列容量 (佇列已滿時丟棄新事件)
+#define CAR_EVENT_BATCH_MAX			256		//!< 背景寫入每批最多事件數量
+#define CAR_EVENT_FLUSH_MS			100		//!< 背景寫入佇列為空時的休眠間隔 (ms)
+#define CAR_EVENT_SYNC_MS			1000	//!< 事件檔案 fsync 間隔 (ms)
+#define CAR_EVENT_RECONNECT_MS		1000	//!< 事件 socket 斷線後重新連接間隔 (ms)
+
+#endif // !ODMC_CARPLATE_CARCORE_HH
@@ -0,0 +1,210 @@
+﻿/**************************************************************************//**
+ * @file	channel.cc
+ * @brief	CarFrameChannel 影像傳輸通道類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "channel.hh"
+
+/**
+ *	@brief	建立影像傳輸通道
+ *	@param[in]	type		傳輸方式
+ *	@param[in]	capacity	佇列容量 (只用於 ChannelType::Queue)
+ *	@return	<b>型別: CarFrameChannel*</b> \n 若建立成功返回通道物件指標 (由呼叫端釋放)。 \n 若建立失敗返回值為 nullptr。
+ */
+CarFrameChannel* CarFrameChannel::Create(ChannelType type, size_t capacity)
+{
+	switch (type) {
+	case ChannelType::Mailbox:
+		return new (std::nothrow) CarMailboxChannel();
+	default:
+		return new (std::nothrow) CarQueueChannel(capacity);
+	}
+}
+
+/**
+ *	@brief	CarFrameChannel 建構式
+ *	@return	此函數沒有返回值
+ */
+CarFrameChannel::CarFrameChannel()
+	: m_nHealth(static_cast<int>(SourceHealth::Idle))
+	, m_nStallMs(0)
+	, m_nLastFrame(0) {
+}
+
+/**
+ *	@brief	設定影像來源連線狀態 (擷取端)，恢復正常時喚醒等待中的偵測端。
+ *	@param[in]	health	連線狀態
+ *	@return	此函數沒有返回值
+ */
+void CarFrameChannel::SetHealth(SourceHealth health)
+{
+	if (health == SourceHealth::Online) {
+		this->NotifyFrame();
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutexHealth);
+		m_nHealth.store(static_cast<int>(health), std::memory_order_release);
+	}
+	m_cvHealth.notify_all();
+}
+
+/**
+ *	@brief	記錄收到影像的時間 (擷取端每放入一幀呼叫一次)，距離上一幀超過停滯時間時喚醒等待中的偵測端。
+ *	@return	此函數沒有返回值
+ */
+void CarFrameChannel::NotifyFrame()
+{
+	const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+	const int64_t prev = m_nLastFrame.exchange(now, std::memory_order_relaxed);
+	const int stallMs = m_nStallMs.load(std::memory_order_relaxed);
+
+	if (stallMs > 0 && std::chrono::steady_clock::duration(now - prev) > std::chrono::milliseconds(stallMs)) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutexHealth);
+		}
+		m_cvHealth.notify_all();
+	}
+}
+
+/**
+ *	@brief	取得影像來源連線狀態
+ *	@return	<b>型別: SourceHealth</b> \n 連線狀態，正常接收中但超過停滯時間沒有影像時返回 SourceHealth::Stalled。
+ */
+SourceHealth CarFrameChannel::GetHealth() const
+{
+	const auto health = static_cast<SourceHealth>(m_nHealth.load(std::memory_order_acquire));
+	const int stallMs = m_nStallMs.load(std::memory_order_relaxed);
+
+	if (health == SourceHealth::Online && stallMs > 0) {
+		const std::chrono::steady_clock::duration elapsed(std::chrono::steady_clock::now().time_since_epoch().count() - m_nLastFrame.load(std::memory_order_relaxed));
+		if (elapsed > std::chrono::milliseconds(stallMs)) {
+			return SourceHealth::Stalled;
+		}
+	}
+	return health;
+}
+
+/**
+ *	@brief	影像來源是否停滯 (連接中、等待重新連接或超過停滯時間沒有影像)
+ *	@return	<b>型別: bool</b> \n 若影像來源停滯返回值為非零值 (true)。 \n 若正常、尚未開始或已結束返回值為零 (false)。
+ */
+bool CarFrameChannel::IsStalled() const
+{
+	const auto health = this->GetHealth();
+	return health == SourceHealth::Connecting || health == SourceHealth::Stalled || health == SourceHealth::Backoff;
+}
+
+/**
+ *	@brief	等待影像來源恢復 (偵測端)
+ *	@param[in]	timeoutMs	最長等待時間 (ms)
+ *	@return	<b>型別: bool</b> \n 若影像來源未停滯返回值為非零值 (true)。 \n 若逾時仍停滯返回值為零 (false)。
+ *	@remark	擷取端設定連線狀態或停滯後再次收到影像時喚醒。
+ */
+bool CarFrameChannel::WaitResume(int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(m_mutexHealth);
+	return m_cvHealth.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !this->IsStalled(); });
+}
+
+/**
+ *	@brief	取得連線狀態名稱
+ *	@param[in]	health	連線狀態
+ *	@return	<b>型別: const char*</b> \n 狀態名稱
+ */
+const char* CarFrameChannel::GetHealthName(SourceHealth health)
+{
+	static const char* const names[] = {
+		"idle", "connecting", "online", "stalled", "backoff", "ended",
+	};
+
+	const auto index = static_cast<int>(health);
+	return (index >= 0 && index < static_cast<int>(sizeof(names) / sizeof(names[0]))) ? names[index] : "unknown";
+}
+
+/**
+ *	@brief	CarQueueChannel 建構式
+ *	@param[in]	capacity	佇列容量
+ *	@param[in]	overflow	佇列已滿處理方式
+ *	@return	此函數沒有返回值
+ */
+CarQueueChannel::CarQueueChannel(size_t capacity, RingOverflow overflow)
+	: m_cRing(capacity, overflow) {
+}
+
+/**
+ *	@brief	[重載] 放入影像至環形佇列
+ */
+bool CarQueueChannel::Push(CarFrame& frame)
+{
+	return m_cRing.Push(frame);
+}
+
+/**
+ *	@brief	[重載] 取出最舊的影像
+ */
+bool CarQueueChannel::Pop(CarFrame& frame, int timeoutMs)
+{
+	return m_cRing.Pop(frame, timeoutMs);
+}
+
+/**
+ *	@brief	[重載] 關閉環形佇列
+ */
+void CarQueueChannel::Close()
+{
+	m_cRing.Close();
+}
+
+/**
+ *	@brief	[重載] 取得環形佇列統計資料
+ */
+void CarQueueChannel::GetStats(CarChannelStats& stats) const
+{
+	stats.produced = m_cRing.GetProduced();
+	stats.consumed = m_cRing.GetConsumed();
+	stats.dropped = m_cRing.GetDropped();
+	stats.pending = m_cRing.GetSize();
+}
+
+/**
+ *	@brief	CarMailboxChannel 建構式
+ *	@return	此函數沒有返回值
+ */
+CarMailboxChannel::CarMailboxChannel() {}
+
+/**
+ *	@brief	[重載] 覆寫最新影像，換回的舊影像由呼叫端歸還緩衝池
+ */
+bool CarMailboxChannel::Push(CarFrame& frame)
+{
+	return m_cMailbox.Push(frame);
+}
+
+/**
+ *	@brief	[重載] 取出最新影像
+ */
+bool CarMailboxChannel::Pop(CarFrame& frame, int timeoutMs)
+{
+	return m_cMailbox.Pop(frame, timeoutMs);
+}
+
+/**
+ *	@brief	[重載] 關閉信箱
+ */
+void CarMailboxChannel::Close()
+{
+	m_cMailbox.Close();
+}
+
+/**
+ *	@brief	[重載] 取得信箱統計資料
+ */
+void CarMailboxChannel::GetStats(CarChannelStats& stats) const
+{
+	stats.produced = m_cMailbox.GetProduced();
+	stats.consumed = m_cMailbox.GetConsumed();
+	stats.dropped = m_cMailbox.GetOverwritten();
+	stats.pending = m_cMailbox.HasNew() ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+﻿/**************************************************************************//**
+ * @file	channel.hh
+ * @brief	CarFrameChannel 擷取與偵測之間影像傳輸通道類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_CHANNEL_HH
+#define	ODMC_CARPLATE_CHANNEL_HH
+#include "framepool.hh"
+#include "spscring.hh"
+#include "mailbox.hh"
+
+/**
+ *	@enum	ChannelType
+ *	@brief	影像傳輸方式列表
+ */
+enum class ChannelType {
+	Queue = 0,		//!< FIFO 環形佇列，依序處理每一幀 (影像檔案、離線分析)
+	Mailbox,		//!< 最新影像信箱，只處理最新的一幀 (即時串流)
+};
+
+/**
+ *	@enum	SourceHealth
+ *	@brief	影像來源連線狀態 (擷取端設定，偵測端讀取)
+ */
+enum class SourceHealth : int {
+	Idle = 0,		//!< 尚未開始擷取
+	Connecting,		//!< 連接中 (已開啟，尚未收到第一幀)
+	Online,			//!< 正常接收影像
+	Stalled,		//!< 已連接但超過停滯時間沒有收到影像
+	Backoff,		//!< 連線中斷，等待重新連接
+	Ended,			//!< 影像來源已結束 (錄製檔或合成影像播放完畢)
+};
+
+/**
+ *	@struct	CarChannelStats
+ *	@brief	影像傳輸通道統計資料
+ */
+struct CarChannelStats {
+	uint64_t	produced;		//!< 擷取端放入幀數
+	uint64_t	consumed;		//!< 偵測端取出幀數
+	uint64_t	dropped;		//!< 未處理即被丟棄或覆寫的幀數
+	size_t		pending;		//!< 待處理幀數
+};
+
+/**
+ *	@class	CarFrameChannel
+ *	@brief	影像傳輸通道介面 (單一擷取端、單一偵測端)
+ *	@remark	除了影像之外，擷取端同時經由通道發布影像來源連線狀態。偵測端在取不到影像時以 IsStalled 判斷
+ *			來源是否停滯 (連接中、等待重新連接或超過停滯時間沒有影像)，停滯期間以 WaitResume 等待恢復，
+ *			不需反覆輪詢空的通道。擷取 thread 阻塞於網路讀取時，停滯時間由偵測端依最近收到影像的時間判定。
+ */
+class CarFrameChannel
+{
+public:
+	CarFrameChannel();
+	virtual ~CarFrameChannel() {}
+
+	static CarFrameChannel* Create(ChannelType type, size_t capacity = CAR_RING_CAPACITY);
+
+	/**
+	 *	@brief	放入影像 (擷取端)
+	 *	@param[in,out]	frame	要放入的影像，返回時可能換成被丟棄或可重複使用的影像。
+	 *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若影像被丟棄或通道已關閉返回值為零 (false)。
+	 */
+	virtual bool Push(CarFrame& frame) = 0;
+
+	/**
+	 *	@brief	取出影像 (偵測端)
+	 *	@param[in,out]	frame		存放取出的影像
+	 *	@param[in]		timeoutMs	最長等待時間 (ms)，0 = 不等待，負值 = 持續等待。
+	 *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或通道已關閉返回值為零 (false)。
+	 */
+	virtual bool Pop(CarFrame& frame, int timeoutMs = -1) = 0;
+
+	/**
+	 *	@brief	關閉通道，喚醒等待中的擷取端與偵測端
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Close() = 0;
+
+	/**
+	 *	@brief	是否只保留最新影像 (偵測端不需為了跳幀取出影像)
+	 *	@return	<b>型別: bool</b> \n 若只保留最新影像返回值為非零值 (true)。 \n 若依序保留影像返回值為零 (false)。
+	 */
+	virtual bool IsLatestOnly() const = 0;
+
+	/**
+	 *	@brief	取得通道統計資料
+	 *	@param[out]	stats	存放統計資料
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void GetStats(CarChannelStats& stats) const = 0;
+
+	void SetHealth(SourceHealth health);
+	void SetStallTime(int stallMs) { m_nStallMs.store(stallMs, std::memory_order_relaxed); }
+	void NotifyFrame();
+	SourceHealth GetHealth() const;
+	bool IsStalled() const;
+	bool WaitResume(int timeoutMs);
+
+	static const char* GetHealthName(SourceHealth health);
+
+private:
+	CarFrameChannel(const CarFrameChannel&) = delete;				//!< Disable copy construction
+	CarFrameChannel& operator=(const CarFrameChannel&) = delete;	//!< Disable assignment operator
+
+	std::atomic<int>		m_nHealth;			//!< 影像來源連線狀態 (SourceHealth)
+	std::atomic<int>		m_nStallMs;			//!< 停滯判定時間 (ms)，0 = 不判定
+	std::atomic<int64_t>	m_nLastFrame;		//!< 最近收到影像的時間 (steady_clock ticks)
+	std::mutex				m_mutexHealth;		//!< 等待恢復用 mutex
+	std::condition_variable	m_cvHealth;			//!< 連線狀態改變通知
+};
+
+/**
+ *	@class	CarQueueChannel
+ *	@brief	FIFO 環形佇列影像傳輸通道，佇列已滿時丟棄最舊的影像
+ */
+class CarQueueChannel : public CarFrameChannel
+{
+public:
+	CarQueueChannel(size_t capacity = CAR_RING_CAPACITY, RingOverflow overflow = RingOverflow::DropOldest);
+
+	bool Push(CarFrame& frame) override;
+	bool Pop(CarFrame& frame, int timeoutMs = -1) override;
+	void Close() override;
+	bool IsLatestOnly() const override { return false; }
+	void GetStats(CarChannelStats& stats) const override;
+
+private:
+	CarSpscRing<CarFrame>	m_cRing;		//!< 環形佇列
+};
+
+/**
+ *	@class	CarMailboxChannel
+ *	@brief	最新影像信箱傳輸通道，擷取端永遠覆寫最新影像
+ *	@remark	端對端延遲上限為一個處理週期，與佇列深度無關。
+ */
+class CarMailboxChannel : public CarFrameChannel
+{
+public:
+	CarMailboxChannel();
+
+	bool Push(CarFrame& frame) override;
+	bool Pop(CarFrame& frame, int timeoutMs = -1) override;
+	void Close() override;
+	bool IsLatestOnly() const override { return true; }
+	void GetStats(CarChannelStats& stats) const override;
+
+private:
+	CarMailbox<CarFrame>	m_cMailbox;		//!< 最新影像信箱
+};
+
+#endif // !ODMC_CARPLATE_CHANNEL_HH
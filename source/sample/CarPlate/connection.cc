@@ -0,0 +1,233 @@
+﻿/**************************************************************************//**
+ * @file	connection.cc
+ * @brief	CarConnection 與 CarBackoff 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "connection.hh"
+
+/**
+ *	@brief	CarBackoff 建構式
+ *	@param[in]	minMs	等待時間下限 (ms)
+ *	@param[in]	maxMs	等待時間上限 (ms)
+ *	@param[in]	seed	抖動亂數種子 (固定種子可重現等待時間序列)
+ *	@return	此函數沒有返回值
+ */
+CarBackoff::CarBackoff(int minMs, int maxMs, uint32_t seed)
+	: m_nMinMs(1)
+	, m_nMaxMs(1)
+	, m_nAttempts(0)
+	, m_cRandom(seed) {
+	this->SetRange(minMs, maxMs);
+}
+
+/**
+ *	@brief	設定等待時間範圍，並重設連續失敗次數。
+ *	@param[in]	minMs	等待時間下限 (ms)，最小為 1
+ *	@param[in]	maxMs	等待時間上限 (ms)，小於下限時等於下限
+ *	@return	此函數沒有返回值
+ */
+void CarBackoff::SetRange(int minMs, int maxMs)
+{
+	m_nMinMs = std::max(minMs, 1);
+	m_nMaxMs = std::max(maxMs, m_nMinMs);
+	m_nAttempts = 0;
+}
+
+/**
+ *	@brief	取得下一次等待時間，並累加連續失敗次數。
+ *	@return	<b>型別: int</b> \n 等待時間 (ms)，介於 min(minMs * 2^n, maxMs) 的一半至全部之間。
+ */
+int CarBackoff::Next()
+{
+	int64_t ceiling = m_nMinMs;
+	for (int i = 0; i < m_nAttempts && ceiling < m_nMaxMs; i++) {
+		ceiling <<= 1;
+	}
+	ceiling = std::min<int64_t>(ceiling, m_nMaxMs);
+	m_nAttempts++;
+
+	const int half = static_cast<int>(ceiling / 2);
+	std::uniform_int_distribution<int> jitter(0, static_cast<int>(ceiling) - half);
+	return half + jitter(m_cRandom);
+}
+
+/**
+ *	@brief	CarConnection 建構式
+ *	@return	此函數沒有返回值
+ */
+CarConnection::CarConnection()
+	: m_nErrorLimit(CAR_CAPTURE_ERROR_LIMIT)
+	, m_nErrors(0)
+	, m_isConnected(false)
+	, m_isOnline(false)
+	, m_nConnects(0)
+	, m_channelPtr(nullptr)
+	, m_metricsPtr(nullptr)
+	, m_nReconnects(0)
+	, m_nOpenFailures(0)
+	, m_isInterrupted(false) {
+}
+
+/**
+ *	@brief	開始擷取前重設連線狀態 (擷取 thread 啟動前呼叫)
+ *	@param[in]	options		影像擷取選項 (重新連接上限、等待時間範圍與停滯判定時間)
+ *	@param[in]	channelPtr	(指標) 發布連線狀態的傳輸通道，可為 nullptr
+ *	@param[in]	metricsPtr	(指標) 重新連接計數，可為 nullptr
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::Reset(const CarCaptureOptions& options, CarFrameChannel* channelPtr, CarStreamMetrics* metricsPtr)
+{
+	m_cBackoff.SetRange(options.backoffMinMs, options.backoffMaxMs);
+	m_nErrorLimit = options.errorLimit;
+	m_nErrors = 0;
+	m_isConnected = false;
+	m_isOnline = false;
+	m_nConnects = 0;
+	m_channelPtr = channelPtr;
+	m_metricsPtr = metricsPtr;
+	m_nReconnects.store(0, std::memory_order_relaxed);
+	m_nOpenFailures.store(0, std::memory_order_relaxed);
+	m_isInterrupted.store(false);
+
+	if (m_channelPtr != nullptr) {
+		m_channelPtr->SetStallTime(options.stallMs);
+	}
+	this->SetHealth(SourceHealth::Idle);
+}
+
+/**
+ *	@brief	開啟影像來源 (已開啟時直接返回)，開啟失敗時等待退避時間後返回。
+ *	@param[in]	source	影像來源
+ *	@return	<b>型別: bool</b> \n 若來源已開啟返回值為非零值 (true)。 \n 若開啟失敗 (已等待或被中斷) 返回值為零 (false)。
+ */
+bool CarConnection::Connect(CarFrameSource& source)
+{
+	if (m_isConnected) {
+		return true;
+	}
+
+	this->SetHealth(SourceHealth::Connecting);
+	if (!source.Open()) {
+		m_nOpenFailures.fetch_add(1, std::memory_order_relaxed);
+		this->WaitBackoff();
+		return false;
+	}
+
+	m_isConnected = true;
+	m_isOnline = false;
+	m_nErrors = 0;
+	if (m_nConnects++ > 0) {
+		m_nReconnects.fetch_add(1, std::memory_order_relaxed);
+		if (m_metricsPtr != nullptr) {
+			m_metricsPtr->AddReconnect();
+		}
+	}
+	return true;
+}
+
+/**
+ *	@brief	關閉影像來源，等待退避時間後返回 (下一次 Connect 重新開啟)。
+ *	@param[in]	source	影像來源
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::Disconnect(CarFrameSource& source)
+{
+	source.Close();
+	m_isConnected = false;
+	m_isOnline = false;
+	this->WaitBackoff();
+}
+
+/**
+ *	@brief	收到一幀影像: 第一幀時發布正常狀態，連線穩定後重設等待時間。
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::OnFrame()
+{
+	m_nErrors = 0;
+	if (!m_isOnline) {
+		m_isOnline = true;
+		m_tOnline = Clock::now();
+		this->SetHealth(SourceHealth::Online);
+		return;
+	}
+
+	if (m_channelPtr != nullptr) {
+		m_channelPtr->NotifyFrame();
+	}
+	if (m_cBackoff.GetAttempts() > 0 && (Clock::now() - m_tOnline) >= std::chrono::milliseconds(CAR_CAPTURE_STABLE_MS)) {
+		m_cBackoff.Reset();
+	}
+}
+
+/**
+ *	@brief	依解碼模式跳過一幀 (來源仍在送出影像，視同收到影像)
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::OnSkipped()
+{
+	this->OnFrame();
+}
+
+/**
+ *	@brief	讀取失敗: 連續失敗達到上限時關閉來源並等待退避時間。
+ *	@param[in]	source	影像來源
+ *	@return	<b>型別: bool</b> \n 若已關閉來源返回值為非零值 (true)。 \n 若未達上限 (或不重新連接) 返回值為零 (false)。
+ */
+bool CarConnection::OnFailure(CarFrameSource& source)
+{
+	if (m_nErrorLimit <= 0 || ++m_nErrors < m_nErrorLimit) {
+		return false;
+	}
+	this->Disconnect(source);
+	return true;
+}
+
+/**
+ *	@brief	影像來源已結束 (錄製檔或合成影像播放完畢)
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::OnEnded()
+{
+	this->SetHealth(SourceHealth::Ended);
+}
+
+/**
+ *	@brief	中斷等待中的退避時間 (停止擷取時由其他 thread 呼叫)，之後的等待立即返回。
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::Interrupt()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isInterrupted.store(true);
+	}
+	m_cvInterrupt.notify_all();
+}
+
+/**
+ *	@brief	發布連線狀態至傳輸通道
+ *	@param[in]	health	連線狀態
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::SetHealth(SourceHealth health)
+{
+	if (m_channelPtr != nullptr) {
+		m_channelPtr->SetHealth(health);
+	}
+}
+
+/**
+ *	@brief	發布等待重新連接狀態，等待下一次退避時間 (可被 Interrupt 中斷)。
+ *	@return	此函數沒有返回值
+ */
+void CarConnection::WaitBackoff()
+{
+	this->SetHealth(SourceHealth::Backoff);
+
+	const int delayMs = m_cBackoff.Next();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cvInterrupt.wait_for(lock, std::chrono::milliseconds(delayMs), [this] { return m_isInterrupted.load(); });
+}
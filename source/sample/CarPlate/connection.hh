@@ -0,0 +1,88 @@
+﻿/**************************************************************************//**
+ * @file	connection.hh
+ * @brief	CarConnection 影像來源連線管理與 CarBackoff 重新連接等待時間類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_CONNECTION_HH
+#define	ODMC_CARPLATE_CONNECTION_HH
+#include <random>
+#include "source.hh"
+
+/**
+ *	@class	CarBackoff
+ *	@brief	重新連接等待時間 (加入隨機抖動的指數退避)
+ *	@remark	第 n 次連續失敗的等待上限為 minMs * 2^n (不超過 maxMs)，實際等待時間在上限的一半至上限之間隨機取值，
+ *			避免多路串流在同一台伺服器或網路中斷後同時重新連接。
+ */
+class CarBackoff
+{
+public:
+	CarBackoff(int minMs = CAR_CAPTURE_BACKOFF_MIN_MS, int maxMs = CAR_CAPTURE_BACKOFF_MAX_MS, uint32_t seed = std::random_device()());
+
+	void SetRange(int minMs, int maxMs);
+	void Reset() { m_nAttempts = 0; }
+	int Next();
+	int GetAttempts() const { return m_nAttempts; }
+
+private:
+	int				m_nMinMs;		//!< 等待時間下限 (ms)
+	int				m_nMaxMs;		//!< 等待時間上限 (ms)
+	int				m_nAttempts;	//!< 連續失敗次數
+	std::mt19937	m_cRandom;		//!< 抖動亂數產生器
+};
+
+/**
+ *	@class	CarConnection
+ *	@brief	影像來源連線管理 (只由擷取 thread 呼叫，Interrupt 除外)
+ *	@remark	開啟失敗或連續讀取失敗達到上限時關閉來源，依 CarBackoff 等待後再重新開啟。
+ *			等待在擷取 thread 上以 condition variable 進行，可由 Interrupt 立即喚醒 (停止擷取時)，
+ *			不佔用偵測 threads。連線狀態經由傳輸通道發布 (CarFrameChannel::SetHealth)，偵測端據此判斷來源停滯；
+ *			連線收到影像持續 CAR_CAPTURE_STABLE_MS 後才重設等待時間，反覆斷線的來源等待時間持續增加。
+ */
+class CarConnection
+{
+public:
+	CarConnection();
+	virtual ~CarConnection() {}
+
+	void Reset(const CarCaptureOptions& options, CarFrameChannel* channelPtr, CarStreamMetrics* metricsPtr);
+	bool Connect(CarFrameSource& source);
+	void Disconnect(CarFrameSource& source);
+	void OnFrame();
+	void OnSkipped();
+	bool OnFailure(CarFrameSource& source);
+	void OnEnded();
+	void Interrupt();
+
+	bool IsConnected() const { return m_isConnected; }
+	int GetAttempts() const { return m_cBackoff.GetAttempts(); }
+	uint64_t GetReconnects() const { return m_nReconnects.load(std::memory_order_relaxed); }
+	uint64_t GetOpenFailures() const { return m_nOpenFailures.load(std::memory_order_relaxed); }
+
+private:
+	CarConnection(const CarConnection&) = delete;				//!< Disable copy construction
+	CarConnection& operator=(const CarConnection&) = delete;	//!< Disable assignment operator
+	void SetHealth(SourceHealth health);
+	void WaitBackoff();
+
+	typedef std::chrono::steady_clock Clock;
+
+	CarBackoff				m_cBackoff;			//!< 重新連接等待時間
+	int						m_nErrorLimit;		//!< 連續讀取失敗上限，0 = 不重新連接
+	int						m_nErrors;			//!< 連續讀取失敗次數
+	bool					m_isConnected;		//!< 來源是否已開啟
+	bool					m_isOnline;			//!< 本次連接是否已收到影像
+	uint64_t				m_nConnects;		//!< 開啟成功次數
+	Clock::time_point		m_tOnline;			//!< 本次連接收到第一幀的時間
+	CarFrameChannel*		m_channelPtr;		//!< 發布連線狀態的傳輸通道 (可為 nullptr)
+	CarStreamMetrics*		m_metricsPtr;		//!< 重新連接計數 (可為 nullptr)
+	std::atomic<uint64_t>	m_nReconnects;		//!< 重新連接成功次數
+	std::atomic<uint64_t>	m_nOpenFailures;	//!< 開啟失敗次數
+	std::atomic<bool>		m_isInterrupted;	//!< 是否已中斷等待
+	std::mutex				m_mutex;			//!< 等待用 mutex
+	std::condition_variable	m_cvInterrupt;		//!< 中斷通知
+};
+
+#endif // !ODMC_CARPLATE_CONNECTION_HH
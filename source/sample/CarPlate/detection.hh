@@ -2,22 +2,14 @@
  * @file	detection.hh
  * @brief	CxPlateDetection 類別宣告 Header
  * @date	2019-12-09
- * @date	2019-12-09
+ * @date	2026-10-19
  * @author	Swang
  *****************************************************************************/
 #ifndef ODMC_CARPLATE_DETECTION_HH
 #define	ODMC_CARPLATE_DETECTION_HH
 #include "carplate.hh"
-
-/**
- *	@enum	EdgeType
- *	@brief	邊緣強化方式列表
- */
-enum class EdgeType {
-	Threshold = 1,		//!< 自適應閥值
-	Sobel,				//!< Sobel
-	Canny,				//!< Canny
-};
+#include "capture.hh"
+#include "stagegraph.hh"
 
 /**
  *	@class	CarPlateDetection
@@ -32,33 +24,31 @@ public:
 public:
 	bool DetectionRun(HWND hWnd);
 	void DetectionEnd();
+	void SetChannelType(ChannelType type) { m_eChannelType = type; }
+	CarMetricsRegistry& GetMetrics() { return m_cMetricsRegistry; }
 
 protected:
-	// 影像處理
-	bool ImagePreprocess(cv::Mat& imgFrame, cv::Mat& imgGrayscale, cv::Mat& imgThresh, EdgeType edgeType = EdgeType::Threshold);
-	void ImageGrayscale(cv::Mat& imgFrame, cv::Mat& imgGrayScale, int scaleType = 0);
-	void ImageContrast(cv::Mat& imgGrayscale, cv::Mat& imgContrast);
-	void ImageDrawContours(cv::Mat& imgThresh);
-	void ImageMatch(cv::Mat& imgFrame, cv::Mat& imgAddone, int alpha = 50);
-
 	// 視窗處理函數
 	bool DisplayBitmap(int x, int y, int wd, int ht, BITMAPINFO* bmiPtr, void* dataPtr) const;
 	bool SetCenterPosition() const;
 	bool SetWindowPosition(int x, int y) const;
 	bool SetWindowSize(int wd, int ht) const;
 	void Resize(BITMAPINFO* bmi, int wd, int ht) const;
-	DWORD ShowFPS(DWORD lastTime, int frameCount, int bufSize);
+	bool ShowFPS(std::chrono::steady_clock::time_point& lastTime, int frameCount, int bufSize);
 
 private:
 	CarPlateDetection(const CarPlateDetection&) = delete;				//!< Disable copy construction
 	CarPlateDetection& operator=(const CarPlateDetection&) = delete;	//!< Disable assignment operator
 	static void DetectionProcess(CarPlateDetection* cThisPtr);
-	static void CaptureProcess(std::atomic<bool>& camKeep, std::queue<cv::Mat>& camQueue, std::mutex& camMutex, void* rstPtr);
 
 	bool m_isDetecting;							//!< 車牌偵測是否正常運行
 	HWND m_hWndTarget;							//!< 影像輸出視窗 handle
+	ChannelType	m_eChannelType;					//!< 擷取與偵測之間影像傳輸方式
 	std::atomic<bool>*	m_cKeepDetection;		//!< 持續車牌偵測識別 (keep running thread process)
 	std::thread*		m_cProcDetection;		//!< 車牌偵測 process
+	CarStageGraph		m_cStageGraph;			//!< 車牌偵測管線化處理
+	CarStreamMetrics	m_cMetrics;				//!< 效能統計
+	CarMetricsRegistry	m_cMetricsRegistry;		//!< 效能統計登錄 (提供快照與定期輸出)
 };
 
 #endif // !ODMC_CARPLATE_DETECTION_HH
@@ -0,0 +1,764 @@
+﻿/**************************************************************************//**
+ * @file	detector.cc
+ * @brief	CarPlateDetector 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "detector.hh"
+#include "opencv2/core/hal/intrin.hpp"
+
+#if CV_SIMD
+/**
+ *	@brief	疊合一組通道值: 原始值 + 輪廓值 * 權重，以 float 計算並四捨六入五成雙 (與 cv::addWeighted 相同)。
+ *	@param[in]	src		原始通道值
+ *	@param[in]	mask	輪廓圖層值
+ *	@param[in]	weight	輪廓圖層權重
+ *	@return	<b>型別: cv::v_uint8</b> \n 疊合後的通道值 (飽和至 0 ~ 255)
+ */
+static inline cv::v_uint8 MatchLanes(const cv::v_uint8& src, const cv::v_uint8& mask, const cv::v_float32& weight)
+{
+	cv::v_uint16 src0, src1, mask0, mask1;
+	cv::v_expand(src, src0, src1);
+	cv::v_expand(mask, mask0, mask1);
+
+	cv::v_uint32 s[4], m[4];
+	cv::v_expand(src0, s[0], s[1]);
+	cv::v_expand(src1, s[2], s[3]);
+	cv::v_expand(mask0, m[0], m[1]);
+	cv::v_expand(mask1, m[2], m[3]);
+
+	cv::v_int32 t[4];
+	for (int k = 0; k < 4; k++) {
+		t[k] = cv::v_round(cv::v_cvt_f32(cv::v_reinterpret_as_s32(s[k])) + cv::v_cvt_f32(cv::v_reinterpret_as_s32(m[k])) * weight);
+	}
+	return cv::v_pack_u(cv::v_pack(t[0], t[1]), cv::v_pack(t[2], t[3]));
+}
+#endif
+
+/**
+ *	@brief	疊合一列輪廓圖層: B、G 通道加上輪廓值 * 權重 (與原本 cv::addWeighted 疊合結果相同)，R 通道不變。
+ *	@param[in,out]	bgrPtr	原始影像 (BGR 交錯)
+ *	@param[in]		maskPtr	輪廓圖層 (0 = 不疊合)
+ *	@param[in]		len		像素數量
+ *	@param[in]		weight	輪廓圖層權重 (alpha / 100)
+ *	@return	此函數沒有返回值
+ */
+static void MatchRow(uint8_t* bgrPtr, const uint8_t* maskPtr, int len, float weight)
+{
+	int i = 0;
+
+#if CV_SIMD
+	const int lanes = cv::v_uint8::nlanes;
+	const cv::v_float32 vWeight = cv::vx_setall_f32(weight);
+	const cv::v_uint8 vZero = cv::vx_setall_u8(0);
+	for (; i <= len - lanes; i += lanes) {
+		const cv::v_uint8 mask = cv::vx_load(maskPtr + i);
+
+		// 輪廓圖層大部分為 0，整段沒有輪廓時不讀寫原始影像
+		if (!cv::v_check_any(mask > vZero)) continue;
+
+		cv::v_uint8 b, g, r;
+		cv::v_load_deinterleave(bgrPtr + i * 3, b, g, r);
+		cv::v_store_interleave(bgrPtr + i * 3, MatchLanes(b, mask, vWeight), MatchLanes(g, mask, vWeight), r);
+	}
+	cv::vx_cleanup();
+#endif
+
+	for (; i < len; i++) {
+		if (maskPtr[i] == 0) continue;
+
+		uint8_t* pixelPtr = bgrPtr + i * 3;
+		const float add = static_cast<float>(maskPtr[i]) * weight;
+		pixelPtr[0] = cv::saturate_cast<uint8_t>(static_cast<float>(pixelPtr[0]) + add);
+		pixelPtr[1] = cv::saturate_cast<uint8_t>(static_cast<float>(pixelPtr[1]) + add);
+	}
+}
+
+/**
+ *	@brief	CarPlateDetector 建構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateDetector::CarPlateDetector()
+	: m_metricsPtr(nullptr)
+	, m_isIdle(false)
+	, m_nFrames(0)
+	, m_isTiled(CAR_PREPROCESS_TILED != 0) {
+}
+
+/**
+ *	@brief	CarPlateDetector 解構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateDetector::~CarPlateDetector() {}
+
+/**
+ *	@brief	載入字元辨識模型，優先映射二進位模型檔，不存在時由 XML 轉換並保存供下次啟動使用。
+ *	@param[in]	modelFile	二進位模型檔路徑
+ *	@param[in]	classFile	字元訓練標籤檔 (XML)
+ *	@param[in]	imageFile	字元訓練影像檔 (XML)
+ *	@return	<b>型別: bool</b> \n 若載入成功返回值為非零值 (true)。 \n 若載入失敗返回值為零 (false)，此時只進行車牌定位。
+ */
+bool CarPlateDetector::LoadOcr(const char* modelFile, const cv::String& classFile, const cv::String& imageFile)
+{
+	if (m_cOcr.IsLoaded() || m_cOcr.LoadModel(modelFile)) {
+		return true;
+	}
+
+	if (m_cOcr.LoadXml(classFile, imageFile)) {
+		m_cOcr.SaveModel(modelFile);
+		return true;
+	}
+	return false;
+}
+
+/**
+ *	@brief	偵測單一幀車牌，並將候選框、辨識文字與輪廓圖層疊合於原始影像。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像 (BGR)，直接繪製偵測結果。
+ *	@return	<b>型別: bool</b> \n 若偵測過程成功返回值為非零值 (true)。 \n 若偵測過程失敗返回值為零 (false)。
+ *	@remark	候選區域、辨識結果與車牌事件由 GetCandidates、GetReads、GetEvents 取得，內容保留至下一次呼叫。
+ *			啟用畫面變化偵測時，靜止畫面不進行偵測 (結果為空)，返回值為非零值 (true)。
+ *			啟用車牌位置追蹤時只在已知車牌附近區域進行預處理與候選搜尋 (定期搜尋全畫面)。
+ *			啟用投票時同一軌跡的多幀辨識結果合併為一筆車牌事件，於軌跡結束或信心值飽和時輸出。
+ */
+bool CarPlateDetector::Detect(cv::Mat& imgFrame)
+{
+	const uint64_t index = m_nFrames++;
+	for (;;) {
+		if (imgFrame.empty()) break;
+
+		// 畫面靜止時不偵測，影像不繪製任何內容 (仍結束逾時的軌跡)
+		if (!this->ImageMotion(imgFrame)) {
+			m_vecCandidates.clear();
+			m_vecReads.clear();
+			m_cVoter.Update(index, m_vecCandidates, m_vecReads, m_vecEvents);
+			return true;
+		}
+
+		// 搜尋區域 (未啟用追蹤時為全畫面)
+		m_cTracker.Predict(index, imgFrame.size(), m_vecRegions);
+
+		// 暫存影像 (解析度不變時沿用)
+		m_cWorkspace.Prepare(imgFrame.size());
+		auto& imgGrayscale = m_cWorkspace.Get(WorkBuffer::Grayscale);
+		auto& imgThresh = m_cWorkspace.Get(WorkBuffer::Thresh);
+
+		// 預處理影像
+		if (!this->ImagePreprocess(imgFrame, imgGrayscale, imgThresh, m_vecRegions)) break;
+
+		// 標記連通元件並篩選車牌候選區域
+		if (!this->ImageCandidates(imgFrame, imgThresh, m_vecRegions, m_cComponents, m_vecCandidates)) break;
+
+		// 辨識車牌文字
+		this->ImageRecognize(imgFrame, imgGrayscale);
+		m_cTracker.Update(index, m_vecRegions, m_vecCandidates);
+		m_cVoter.Update(index, m_vecCandidates, m_vecReads, m_vecEvents);
+
+		// 疊合輪廓圖層 (輪廓圖層只保留候選區域)
+		this->ImageMatch(imgFrame, imgThresh, m_vecCandidates);
+		return true;
+	}
+
+	m_vecCandidates.clear();
+	m_vecReads.clear();
+	m_vecEvents.clear();
+	return false;
+}
+
+/**
+ *	@brief	偵測單一幀車牌 (影像輸入、結果輸出)，不在影像上繪製任何內容。
+ *	@param[in]	imgFrame	cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[out]	result		存放候選區域、辨識結果與各處理階段耗時
+ *	@return	<b>型別: bool</b> \n 若偵測過程成功返回值為非零值 (true)。 \n 若偵測過程失敗返回值為零 (false)。
+ *	@remark	不依賴視窗或繪圖，供無視窗服務與效能量測使用，暫存影像於下一次呼叫時重複使用。
+ */
+bool CarPlateDetector::Detect(const cv::Mat& imgFrame, CarDetectResult& result)
+{
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	auto& timing = result.timing;
+	::memset(&timing, 0, sizeof(CarDetectTiming));
+	result.candidates.clear();
+	result.reads.clear();
+	result.events.clear();
+	result.isIdle = false;
+
+	const uint64_t index = m_nFrames++;
+	const auto startTime = Clock::now();
+	for (;;) {
+		if (imgFrame.empty()) break;
+
+		// 畫面靜止時不偵測
+		if (!this->ImageMotion(imgFrame)) {
+			result.isIdle = true;
+			m_cVoter.Update(index, result.candidates, result.reads, result.events);
+			timing.totalMs = Milliseconds(Clock::now() - startTime).count();
+			return true;
+		}
+
+		// 搜尋區域 (未啟用追蹤時為全畫面)
+		m_cTracker.Predict(index, imgFrame.size(), m_vecRegions);
+
+		// 暫存影像 (解析度不變時沿用)
+		m_cWorkspace.Prepare(imgFrame.size());
+		auto& imgGrayscale = m_cWorkspace.Get(WorkBuffer::Grayscale);
+		auto& imgThresh = m_cWorkspace.Get(WorkBuffer::Thresh);
+
+		// 預處理影像 (灰階轉換不修改原始影像)
+		auto lastTime = Clock::now();
+		if (!this->ImagePreprocess(imgFrame, imgGrayscale, imgThresh, m_vecRegions)) break;
+		auto thisTime = Clock::now();
+		timing.preprocessMs = Milliseconds(thisTime - lastTime).count();
+
+		// 標記連通元件並篩選車牌候選區域
+		if (!this->ImageSearch(imgThresh, m_vecRegions, m_cComponents, result.candidates, &timing)) break;
+
+		// 辨識車牌文字
+		lastTime = Clock::now();
+		result.reads.resize(result.candidates.size());
+		for (size_t i = 0; i < result.candidates.size(); i++) {
+			if (!m_cOcr.Recognize(imgGrayscale, result.candidates[i].rect, result.reads[i])) {
+				result.reads[i].count = 0;
+				result.reads[i].text[0] = '\0';
+			}
+		}
+		thisTime = Clock::now();
+		timing.recognizeMs = Milliseconds(thisTime - lastTime).count();
+		if (m_metricsPtr != nullptr) m_metricsPtr->Record(MetricStage::Recognize, thisTime - lastTime);
+		timing.totalMs = Milliseconds(thisTime - startTime).count();
+		m_cTracker.Update(index, m_vecRegions, result.candidates);
+		m_cVoter.Update(index, result.candidates, result.reads, result.events);
+		return true;
+	}
+
+	result.candidates.clear();
+	result.reads.clear();
+	timing.totalMs = Milliseconds(Clock::now() - startTime).count();
+	return false;
+}
+
+/**
+ *	@brief	畫面變化偵測，判斷此幀是否需要進行車牌偵測 (未啟用時總是需要)
+ *	@param[in]	imgFrame	cv::Mat 物件參考，原始影像 (BGR 或灰階)。
+ *	@return	<b>型別: bool</b> \n 若畫面有變化需要偵測返回值為非零值 (true)。 \n 若畫面靜止返回值為零 (false)。
+ */
+bool CarPlateDetector::ImageMotion(const cv::Mat& imgFrame)
+{
+	m_isIdle = false;
+	if (!m_cMotion.IsEnabled()) {
+		return true;
+	}
+
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Motion);
+		m_isIdle = !m_cMotion.Update(imgFrame);
+	}
+
+	if (m_isIdle && m_metricsPtr != nullptr) {
+		m_metricsPtr->AddIdle();
+	}
+	return !m_isIdle;
+}
+
+/**
+ *	@brief	預處理車牌定位圖形
+ *	@param[in]	imgFrame		cv::Mat 物件參考，要預處理的原始影像。
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，用來保存灰階化影像。
+ *	@return	<b>型別: bool</b> \n 若預處理過程成功，返回值為非零值 (true)。 \n 若預處理過程失敗，返回值為零 (false)。
+ */
+bool CarPlateDetector::ImagePreprocess(
+	cv::Mat& imgFrame,
+	cv::Mat& imgGrayscale,
+	cv::Mat& imgThresh,
+	EdgeType edgeType)
+{
+	for (;;) {
+		// 灰階化
+		// cv::cvtColor(imgFrame, imgGrayscale, cv::COLOR_BGR2GRAY);
+		this->ImageGrayscale(imgFrame, imgGrayscale);
+		if (imgGrayscale.data == nullptr) break;
+
+		// 提高灰階影像對比
+		auto& imgContrast = m_cWorkspace.Get(WorkBuffer::Contrast);
+		this->ImageContrast(imgGrayscale, imgContrast);
+		if (imgContrast.data == nullptr) break;
+
+		// 平滑化與二值化
+		if (!this->ImageThreshold(imgContrast, imgThresh, edgeType)) break;
+		return true;
+	}
+  	return false;
+}
+
+/**
+ *	@brief	只預處理搜尋區域內的影像 (灰階、提高對比、平滑化、二值化)，區域外內容不更新。
+ *	@param[in]	imgFrame		cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，存放灰階影像 (與原始影像同尺寸)。
+ *	@param[out]	imgThresh		cv::Mat 物件參考，存放二值化影像 (與原始影像同尺寸)。
+ *	@param[in]	regions			搜尋區域
+ *	@return	<b>型別: bool</b> \n 若預處理過程成功，返回值為非零值 (true)。 \n 若預處理過程失敗，返回值為零 (false)。
+ *	@remark	啟用分塊融合時各區域依快取大小分塊一次完成所有步驟 (結果與分段處理相同)，否則依序分段處理。
+ */
+bool CarPlateDetector::ImagePreprocess(const cv::Mat& imgFrame, cv::Mat& imgGrayscale, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions)
+{
+	if (m_isTiled) {
+		CarStageTimer timer(m_metricsPtr, MetricStage::Tiled);
+		return m_cTiled.Process(imgFrame, regions, imgGrayscale, imgThresh);
+	}
+
+	for (;;) {
+		this->ImageGrayscale(imgFrame, imgGrayscale, regions);
+		if (imgGrayscale.data == nullptr) break;
+
+		auto& imgContrast = m_cWorkspace.Get(WorkBuffer::Contrast);
+		this->ImageContrast(imgGrayscale, imgContrast, regions);
+		if (imgContrast.data == nullptr) break;
+
+		if (!this->ImageThreshold(imgContrast, imgThresh, regions)) break;
+		return true;
+	}
+	return false;
+}
+
+/**
+ *	@brief	平滑化並二值化 (邊緣強化) 影像
+ *	@param[in]	imgContrast	cv::Mat 物件參考，提高對比後的灰階影像。
+ *	@param[out]	imgThresh	cv::Mat 物件參考，用來保存二值化影像。
+ *	@param[in]	edgeType	邊緣強化方式
+ *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若處理失敗返回值為零 (false)。
+ */
+bool CarPlateDetector::ImageThreshold(cv::Mat& imgContrast, cv::Mat& imgThresh, EdgeType edgeType)
+{
+	cv::Size sizeBlurred(CAR_PLATE_BLUE_WD, CAR_PLATE_BLUE_HT);
+	if (imgContrast.empty()) {
+		return false;
+	}
+	m_cWorkspace.Prepare(imgContrast.size());
+	auto& imgBlurred = m_cWorkspace.Get(WorkBuffer::Blurred);
+
+	// 進行平滑化
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Blur);
+		cv::GaussianBlur(imgContrast, imgBlurred, sizeBlurred, cv::BORDER_CONSTANT);
+	}
+
+	CarStageTimer timer(m_metricsPtr, MetricStage::Threshold);
+	switch (edgeType) {
+	case EdgeType::Sobel:
+		break;
+	case EdgeType::Canny:
+		cv::Canny(imgBlurred, imgThresh, 70, 210);
+		break;
+	default:
+		// 區域平均暫存取自工作區，每幀不重新配置
+		imgThresh.create(imgBlurred.size(), CV_8UC1);
+		CarTiledPreprocess::AdaptiveThreshold(imgBlurred, m_cWorkspace.Get(WorkBuffer::BlurredFloat), m_cWorkspace.Get(WorkBuffer::MeanFloat), m_cWorkspace.Get(WorkBuffer::Mean), imgThresh);
+		break;
+	}
+	return imgThresh.data != nullptr;
+}
+
+/**
+ *	@brief	只在搜尋區域內平滑化並二值化 (邊緣強化) 影像，區域外內容不更新。
+ *	@param[in]	imgContrast	cv::Mat 物件參考，提高對比後的灰階影像 (搜尋區域內有效)。
+ *	@param[out]	imgThresh	cv::Mat 物件參考，用來保存二值化影像 (與原始影像同尺寸)。
+ *	@param[in]	regions		搜尋區域 (互不重疊)
+ *	@param[in]	edgeType	邊緣強化方式
+ *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若處理失敗返回值為零 (false)。
+ *	@remark	濾波以區域邊界為影像邊界 (BORDER_ISOLATED)，不讀取區域外未更新的內容。
+ */
+bool CarPlateDetector::ImageThreshold(const cv::Mat& imgContrast, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, EdgeType edgeType)
+{
+	const cv::Size sizeBlurred(CAR_PLATE_BLUE_WD, CAR_PLATE_BLUE_HT);
+	if (imgContrast.empty()) {
+		return false;
+	}
+	m_cWorkspace.Prepare(imgContrast.size());
+	auto& imgBlurred = m_cWorkspace.Get(WorkBuffer::Blurred);
+	imgThresh.create(imgContrast.size(), CV_8UC1);
+
+	// 進行平滑化
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Blur);
+		for (const auto& region : regions) {
+			cv::Mat imgRegion = imgBlurred(region);
+			cv::GaussianBlur(imgContrast(region), imgRegion, sizeBlurred, 0, 0, cv::BORDER_DEFAULT | cv::BORDER_ISOLATED);
+		}
+	}
+
+	CarStageTimer timer(m_metricsPtr, MetricStage::Threshold);
+	for (const auto& region : regions) {
+		cv::Mat imgRegion = imgThresh(region);
+		switch (edgeType) {
+		case EdgeType::Sobel:
+			break;
+		case EdgeType::Canny:
+			cv::Canny(imgBlurred(region), imgRegion, 70, 210);
+			break;
+		default:
+			{
+				cv::Mat imgFloat = m_cWorkspace.Get(WorkBuffer::BlurredFloat)(region);
+				cv::Mat imgMeanFloat = m_cWorkspace.Get(WorkBuffer::MeanFloat)(region);
+				cv::Mat imgMean = m_cWorkspace.Get(WorkBuffer::Mean)(region);
+				CarTiledPreprocess::AdaptiveThreshold(imgBlurred(region), imgFloat, imgMeanFloat, imgMean, imgRegion);
+			}
+			break;
+		}
+	}
+	return imgThresh.data != nullptr;
+}
+
+/**
+ *	@brief	灰階轉換, RGB or BGR to grayscale
+ *	@param[in]	imgFrame		cv::Mat 物件參考，要進行灰階轉換的影像。
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，存放轉換後灰階化影像。
+ *	@param[in]	scaleType		指定要使用的方式(預設為 0 = YUV 方式取 Y)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageGrayscale(cv::Mat& imgFrame, cv::Mat& imgGrayscale, int scaleType)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Grayscale);
+
+	if (scaleType == 1) {
+		cv::Mat imgHSV;
+		cv::Mat imgValue;
+		std::vector<cv::Mat> vectorOfHSVImages;
+
+		// 轉換為 HSV 通道
+		cv::cvtColor(imgFrame, imgHSV, cv::COLOR_BGR2HSV);
+
+		cv::split(imgHSV, vectorOfHSVImages);
+		imgGrayscale = vectorOfHSVImages[2].clone();
+
+		// 釋放 vector 資源
+		vectorOfHSVImages.clear();
+		vectorOfHSVImages.shrink_to_fit();
+	}
+	else {
+		cv::cvtColor(imgFrame, imgGrayscale, cv::COLOR_BGR2GRAY);
+	}
+}
+
+/**
+ *	@brief	只轉換搜尋區域內的灰階影像 (BGR to grayscale)，區域外內容不更新。
+ *	@param[in]	imgFrame		cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，存放灰階影像 (與原始影像同尺寸)。
+ *	@param[in]	regions			搜尋區域
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageGrayscale(const cv::Mat& imgFrame, cv::Mat& imgGrayscale, const std::vector<cv::Rect>& regions)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Grayscale);
+
+	imgGrayscale.create(imgFrame.size(), CV_8UC1);
+	for (const auto& region : regions) {
+		cv::Mat imgRegion = imgGrayscale(region);
+		cv::cvtColor(imgFrame(region), imgRegion, cv::COLOR_BGR2GRAY);
+	}
+}
+
+/**
+ *	@brief	提高影像對比
+ *	@param[in]	imgGrayscale	cv::Mat 物件參考，要進行提高對比的灰階(單通道)影像
+ *	@param[out]	imgContrast		cv::Mat 物件參考，用來保存提高對比後的影像
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageContrast(cv::Mat& imgGrayscale, cv::Mat& imgContrast)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Contrast);
+	imgContrast.create(imgGrayscale.size(), imgGrayscale.type());
+	this->ContrastRegion(imgGrayscale, imgContrast, cv::Rect(cv::Point(), imgGrayscale.size()));
+}
+
+/**
+ *	@brief	只提高搜尋區域內的影像對比，區域外內容不更新。
+ *	@param[in]	imgGrayscale	cv::Mat 物件參考，灰階影像 (搜尋區域內有效)。
+ *	@param[out]	imgContrast		cv::Mat 物件參考，用來保存提高對比後的影像 (與灰階影像同尺寸)。
+ *	@param[in]	regions			搜尋區域
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageContrast(const cv::Mat& imgGrayscale, cv::Mat& imgContrast, const std::vector<cv::Rect>& regions)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Contrast);
+
+	imgContrast.create(imgGrayscale.size(), imgGrayscale.type());
+	for (const auto& region : regions) {
+		this->ContrastRegion(imgGrayscale, imgContrast, region);
+	}
+}
+
+/**
+ *	@brief	提高指定區域影像對比 (top-hat 加上原圖再減去 black-hat)，不計時。
+ *	@param[in]	imgGrayscale	cv::Mat 物件參考，灰階影像。
+ *	@param[out]	imgContrast		cv::Mat 物件參考，用來保存提高對比後的影像 (與灰階影像同尺寸，已配置)。
+ *	@param[in]	region			處理區域 (以區域邊界為影像邊界)
+ *	@return	此函數沒有返回值
+ *	@remark	top-hat 與 black-hat 寫入工作區同一區域，原圖加 top-hat 直接寫入輸出後原地減去 black-hat (飽和運算結果相同)。
+ */
+void CarPlateDetector::ContrastRegion(const cv::Mat& imgGrayscale, cv::Mat& imgContrast, const cv::Rect& region)
+{
+	m_cWorkspace.Prepare(imgGrayscale.size());
+	const auto& element = m_cWorkspace.GetElement();
+	const cv::Mat imgSource = imgGrayscale(region);
+	cv::Mat imgTophat = m_cWorkspace.Get(WorkBuffer::Tophat)(region);
+	cv::Mat imgBlackhat = m_cWorkspace.Get(WorkBuffer::Blackhat)(region);
+	cv::Mat imgRegion = imgContrast(region);
+
+	cv::morphologyEx(imgSource, imgTophat, cv::MORPH_TOPHAT, element, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+	cv::morphologyEx(imgSource, imgBlackhat, cv::MORPH_BLACKHAT, element, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+	cv::add(imgSource, imgTophat, imgRegion);
+	cv::subtract(imgRegion, imgBlackhat, imgRegion);
+}
+
+/**
+ *	@brief	標記連通元件，取代 findContours / drawContours。
+ *	@param[in,out]	imgThresh	cv::Mat 物件參考，輸入二值化影像，並直接作為輪廓圖層輸出。
+ *	@return	此函數沒有返回值
+ *	@remark	元件統計結果存放於 m_cComponents，後續候選篩選只需統計值，不需要輪廓多邊形。
+ */
+void CarPlateDetector::ImageDrawContours(cv::Mat& imgThresh)
+{
+	this->ImageDrawContours(imgThresh, m_cComponents);
+}
+
+/**
+ *	@brief	標記連通元件，統計結果存放於指定物件 (stage graph 每幀各自保存)。
+ *	@param[in]	imgThresh	cv::Mat 物件參考，二值化影像。
+ *	@param[out]	components	CarComponents 物件參考，存放連通元件統計資料。
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageDrawContours(cv::Mat& imgThresh, CarComponents& components)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Contours);
+	m_cLabeling.Labeling(imgThresh, components);
+}
+
+/**
+ *	@brief	篩選車牌候選區域，輪廓圖層只保留候選區域並於原始影像標示候選框。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像，繪製候選框。
+ *	@param[in,out]	imgThresh	cv::Mat 物件參考，輸入二值化影像，導出只含候選區域的輪廓圖層。
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh)
+{
+	this->ImageCandidates(imgFrame, imgThresh, m_cComponents, m_vecCandidates);
+}
+
+/**
+ *	@brief	篩選車牌候選區域，連通元件與候選結果使用指定物件 (stage graph 每幀各自保存)。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像，繪製候選框。
+ *	@param[in,out]	imgThresh	cv::Mat 物件參考，輸入二值化影像，導出只含候選區域的輪廓圖層。
+ *	@param[in]		components	CarComponents 物件參考，連通元件統計資料。
+ *	@param[out]		candidates	存放車牌候選區域
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const CarComponents& components, std::vector<CarPlateCandidate>& candidates)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Candidates);
+	m_cCandidateFilter.Filter(components, imgThresh.size(), candidates);
+	this->DrawCandidates(imgFrame, imgThresh, candidates);
+}
+
+/**
+ *	@brief	只在搜尋區域內標記連通元件並篩選車牌候選區域，輪廓圖層只保留候選區域並於原始影像標示候選框。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像，繪製候選框。
+ *	@param[in,out]	imgThresh	cv::Mat 物件參考，輸入二值化影像，導出只含候選區域的輪廓圖層。
+ *	@param[in]		regions		搜尋區域 (互不重疊)
+ *	@param[out]		components	CarComponents 物件參考，存放連通元件統計資料。
+ *	@param[out]		candidates	存放車牌候選區域 (影像座標)
+ *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若連通元件標記失敗返回值為零 (false)。
+ */
+bool CarPlateDetector::ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, CarComponents& components, std::vector<CarPlateCandidate>& candidates)
+{
+	if (!this->ImageSearch(imgThresh, regions, components, candidates)) {
+		return false;
+	}
+	this->DrawCandidates(imgFrame, imgThresh, candidates);
+	return true;
+}
+
+/**
+ *	@brief	只在搜尋區域內標記連通元件並篩選車牌候選區域，不繪製任何內容。
+ *	@param[in]	imgThresh	cv::Mat 物件參考，二值化影像 (搜尋區域內有效)。
+ *	@param[in]	regions		搜尋區域 (互不重疊)
+ *	@param[out]	components	CarComponents 物件參考，存放連通元件統計資料 (多個區域時為最後一個區域)。
+ *	@param[out]	candidates	存放車牌候選區域 (影像座標)，多個區域時依分數保留前 K 個。
+ *	@param[out]	timingPtr	(指標) 累加連通元件標記與候選篩選耗時，nullptr = 不輸出。
+ *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若連通元件標記失敗返回值為零 (false)。
+ *	@remark	面積規則以整個畫面計算，區域內的候選區域與全畫面搜尋時分數相同。
+ */
+bool CarPlateDetector::ImageSearch(const cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, CarComponents& components, std::vector<CarPlateCandidate>& candidates, CarDetectTiming* timingPtr)
+{
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	Clock::duration labelingTime = Clock::duration::zero();
+	Clock::duration candidatesTime = Clock::duration::zero();
+	bool isLabeled = true;
+
+	candidates.clear();
+	for (const auto& region : regions) {
+		auto lastTime = Clock::now();
+		isLabeled = m_cLabeling.Labeling(imgThresh(region), components);
+		auto thisTime = Clock::now();
+		labelingTime += thisTime - lastTime;
+		if (!isLabeled) break;
+
+		// 區域座標轉換為影像座標
+		lastTime = thisTime;
+		m_cCandidateFilter.Filter(components, imgThresh.size(), m_vecRegionCandidates);
+		for (auto& candidate : m_vecRegionCandidates) {
+			candidate.rect.x += region.x;
+			candidate.rect.y += region.y;
+			candidates.push_back(candidate);
+		}
+		candidatesTime += Clock::now() - lastTime;
+	}
+
+	if (regions.size() > 1 && candidates.size() > CAR_CANDIDATE_TOPK) {
+		std::stable_sort(candidates.begin(), candidates.end(), [](const CarPlateCandidate& a, const CarPlateCandidate& b) { return a.score > b.score; });
+		candidates.resize(CAR_CANDIDATE_TOPK);
+	}
+
+	if (m_metricsPtr != nullptr) {
+		m_metricsPtr->Record(MetricStage::Contours, labelingTime);
+		m_metricsPtr->Record(MetricStage::Candidates, candidatesTime);
+	}
+	if (timingPtr != nullptr) {
+		timingPtr->labelingMs += Milliseconds(labelingTime).count();
+		timingPtr->candidatesMs += Milliseconds(candidatesTime).count();
+	}
+	return isLabeled;
+}
+
+/**
+ *	@brief	輪廓圖層只保留候選區域，並於原始影像標示候選框。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像，繪製候選框。
+ *	@param[in,out]	imgThresh	cv::Mat 物件參考，輸入二值化影像，導出只含候選區域的輪廓圖層。
+ *	@param[in]		candidates	車牌候選區域
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::DrawCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const std::vector<CarPlateCandidate>& candidates)
+{
+	// 候選區域內容暫存於工作區，清除整張輪廓圖層後複製回原位 (不交換或配置影像)
+	m_cWorkspace.Prepare(imgThresh.size());
+	auto& imgCandidates = m_cWorkspace.Get(WorkBuffer::Candidates);
+	for (const auto& candidate : candidates) {
+		imgThresh(candidate.rect).copyTo(imgCandidates(candidate.rect));
+	}
+	imgThresh.setTo(cv::Scalar::all(0));
+	for (const auto& candidate : candidates) {
+		imgCandidates(candidate.rect).copyTo(imgThresh(candidate.rect));
+		cv::rectangle(imgFrame, candidate.rect, cv::Scalar(0, 255, 0), 2);
+	}
+}
+
+/**
+ *	@brief	辨識車牌候選區域文字，並標示於原始影像。
+ *	@param[in,out]	imgFrame		cv::Mat 物件參考，原始影像，繪製辨識文字。
+ *	@param[in]		imgGrayscale	cv::Mat 物件參考，灰階影像。
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageRecognize(cv::Mat& imgFrame, cv::Mat& imgGrayscale)
+{
+	this->ImageRecognize(imgFrame, imgGrayscale, m_vecCandidates, m_vecReads);
+}
+
+/**
+ *	@brief	辨識指定車牌候選區域文字 (stage graph 每幀各自保存結果)。
+ *	@param[in,out]	imgFrame		cv::Mat 物件參考，原始影像，繪製辨識文字。
+ *	@param[in]		imgGrayscale	cv::Mat 物件參考，灰階影像。
+ *	@param[in]		candidates		車牌候選區域
+ *	@param[out]		reads			存放各候選區域辨識結果
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageRecognize(cv::Mat& imgFrame, cv::Mat& imgGrayscale, const std::vector<CarPlateCandidate>& candidates, std::vector<CarPlateRead>& reads)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Recognize);
+	reads.resize(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++) {
+		const cv::Rect& rect = candidates[i].rect;
+		if (!m_cOcr.Recognize(imgGrayscale, rect, reads[i])) {
+			reads[i].count = 0;
+			reads[i].text[0] = '\0';
+			continue;
+		}
+		cv::putText(imgFrame, reads[i].text, cv::Point(rect.x, std::max(rect.y - 6, 12)), cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 255, 0), 2);
+	}
+}
+
+/**
+ *	@brief	疊合輪廓圖層 (全畫面)，原始影像於輪廓像素加上色調，單次讀寫完成。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[in]		imgMask		cv::Mat 物件參考，輪廓圖層 (單通道，非零為輪廓)，尺寸與原始影像相同。
+ *	@param[in]		alpha		輪廓圖層 alpha 深度 (預設 50%) (最大值 = 100, 最小值 = 0)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageMatch(cv::Mat& imgFrame, const cv::Mat& imgMask, int alpha)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Overlay);
+	if (imgFrame.type() != CV_8UC3 || imgMask.type() != CV_8UC1 || imgFrame.size() != imgMask.size()) {
+		return;
+	}
+
+	const auto weight = static_cast<float>(std::max(std::min(alpha, 100), 0) / 100.0);
+	CarPlateDetector::MatchRegion(imgFrame, imgMask, cv::Rect(cv::Point(), imgFrame.size()), weight);
+}
+
+/**
+ *	@brief	疊合輪廓圖層，只處理候選區域 (輪廓圖層於候選區域外皆為 0 時結果與全畫面相同)。
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[in]		imgMask		cv::Mat 物件參考，輪廓圖層 (單通道，非零為輪廓)，尺寸與原始影像相同。
+ *	@param[in]		candidates	車牌候選區域，重疊的區域合併後只疊合一次。
+ *	@param[in]		alpha		輪廓圖層 alpha 深度 (預設 50%) (最大值 = 100, 最小值 = 0)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::ImageMatch(cv::Mat& imgFrame, const cv::Mat& imgMask, const std::vector<CarPlateCandidate>& candidates, int alpha)
+{
+	CarStageTimer timer(m_metricsPtr, MetricStage::Overlay);
+	if (imgFrame.type() != CV_8UC3 || imgMask.type() != CV_8UC1 || imgFrame.size() != imgMask.size()) {
+		return;
+	}
+
+	const cv::Rect frameRect(cv::Point(), imgFrame.size());
+	m_vecOverlayRegions.clear();
+	for (const auto& candidate : candidates) {
+		const cv::Rect rect = candidate.rect & frameRect;
+		if (rect.area() > 0) {
+			m_vecOverlayRegions.push_back(rect);
+		}
+	}
+	CarPlateTracker::MergeRegions(m_vecOverlayRegions);
+
+	const auto weight = static_cast<float>(std::max(std::min(alpha, 100), 0) / 100.0);
+	for (const auto& region : m_vecOverlayRegions) {
+		CarPlateDetector::MatchRegion(imgFrame, imgMask, region, weight);
+	}
+}
+
+/**
+ *	@brief	疊合指定區域輪廓圖層
+ *	@param[in,out]	imgFrame	cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[in]		imgMask		cv::Mat 物件參考，輪廓圖層 (單通道)。
+ *	@param[in]		region		疊合區域 (位於影像範圍內)
+ *	@param[in]		weight		輪廓圖層權重 (alpha / 100)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateDetector::MatchRegion(cv::Mat& imgFrame, const cv::Mat& imgMask, const cv::Rect& region, float weight)
+{
+	// 連續記憶體的全畫面視為單一列處理
+	int rows = region.height;
+	int cols = region.width;
+	if (region.width == imgFrame.cols && imgFrame.isContinuous() && imgMask.isContinuous()) {
+		cols *= rows;
+		rows = 1;
+	}
+
+	for (int y = 0; y < rows; y++) {
+		uint8_t* bgrPtr = imgFrame.ptr<uint8_t>(region.y + y) + region.x * 3;
+		const uint8_t* maskPtr = imgMask.ptr<uint8_t>(region.y + y) + region.x;
+		MatchRow(bgrPtr, maskPtr, cols, weight);
+	}
+}
+
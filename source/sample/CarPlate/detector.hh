@@ -0,0 +1,138 @@
+﻿/**************************************************************************//**
+ * @file	detector.hh
+ * @brief	CarPlateDetector 車牌偵測影像處理類別宣告 Header (不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_DETECTOR_HH
+#define	ODMC_CARPLATE_DETECTOR_HH
+#include "candidate.hh"
+#include "ocr.hh"
+#include "metrics.hh"
+#include "motion.hh"
+#include "tracker.hh"
+#include "voting.hh"
+#include "workspace.hh"
+#include "preprocess.hh"
+
+/**
+ *	@enum	EdgeType
+ *	@brief	邊緣強化方式列表
+ */
+enum class EdgeType {
+	Threshold = 1,		//!< 自適應閥值
+	Sobel,				//!< Sobel
+	Canny,				//!< Canny
+};
+
+/**
+ *	@struct	CarDetectTiming
+ *	@brief	單一幀各處理階段耗時 (ms，以 std::chrono::steady_clock 量測)
+ */
+struct CarDetectTiming {
+	double		preprocessMs;		//!< 灰階、對比、平滑化與二值化
+	double		labelingMs;			//!< 連通元件標記
+	double		candidatesMs;		//!< 車牌候選區域篩選
+	double		recognizeMs;		//!< 車牌字元辨識
+	double		totalMs;			//!< 全部處理時間
+};
+
+/**
+ *	@struct	CarDetectResult
+ *	@brief	單一幀偵測結果
+ */
+struct CarDetectResult {
+	std::vector<CarPlateCandidate> candidates;	//!< 車牌候選區域
+	std::vector<CarPlateRead> reads;			//!< 各候選區域辨識結果 (count = 0 表示無法辨識)
+	std::vector<CarPlateEvent> events;			//!< 此幀產生的車牌事件 (跨幀投票結果)
+	CarDetectTiming	timing;						//!< 各處理階段耗時
+	bool			isIdle;						//!< 畫面靜止，未進行偵測
+};
+
+/**
+ *	@class	CarPlateDetector
+ *	@brief	車牌偵測影像處理 (預處理、連通元件、候選篩選、字元辨識、疊圖)
+ *	@remark	物件內含各階段暫存影像與統計資料，同一時間只能由一個 thread 使用，
+ *			多路串流時每路串流各自持有一個物件。暫存影像由工作區依解析度配置一次，穩定運作時不配置記憶體。
+ */
+class CarPlateDetector
+{
+public:
+	CarPlateDetector();
+	virtual ~CarPlateDetector();
+
+	bool LoadOcr(const char* modelFile, const cv::String& classFile, const cv::String& imageFile);
+	bool Detect(cv::Mat& imgFrame);
+	bool Detect(const cv::Mat& imgFrame, CarDetectResult& result);
+
+	const std::vector<CarPlateCandidate>& GetCandidates() const { return m_vecCandidates; }
+	const std::vector<CarPlateRead>& GetReads() const { return m_vecReads; }
+	const std::vector<CarPlateEvent>& GetEvents() const { return m_vecEvents; }
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; m_cTracker.SetMetrics(metricsPtr); m_cWorkspace.SetMetrics(metricsPtr); }
+	void SetMotionOptions(const CarMotionOptions& options) { m_cMotion.SetOptions(options); }
+	void SetTrackOptions(const CarTrackOptions& options) { m_cTracker.SetOptions(options); }
+	void SetVoteOptions(const CarVoteOptions& options) { m_cVoter.SetOptions(options); }
+	void FlushEvents(std::vector<CarPlateEvent>& events) { m_cVoter.Flush(events); }
+	const CarMotionGate& GetMotionGate() const { return m_cMotion; }
+	CarPlateTracker& GetTracker() { return m_cTracker; }
+	bool IsIdle() const { return m_isIdle; }
+	uint64_t GetFrames() const { return m_nFrames; }
+	void ReleaseWorkspace() { m_cWorkspace.Release(); }
+	void SetTiled(bool isTiled) { m_isTiled = isTiled; }
+	bool IsTiled() const { return m_isTiled; }
+	void SetThreads(int threads) { m_cTiled.SetThreads(threads); m_cLabeling.SetThreads(threads); }
+	int GetThreads() const { return m_cTiled.GetThreads(); }
+	const CarWorkspace& GetWorkspace() const { return m_cWorkspace; }
+
+public:
+	// 影像處理
+	bool ImageMotion(const cv::Mat& imgFrame);
+	bool ImagePreprocess(cv::Mat& imgFrame, cv::Mat& imgGrayscale, cv::Mat& imgThresh, EdgeType edgeType = EdgeType::Threshold);
+	bool ImagePreprocess(const cv::Mat& imgFrame, cv::Mat& imgGrayscale, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions);
+	void ImageGrayscale(cv::Mat& imgFrame, cv::Mat& imgGrayScale, int scaleType = 0);
+	void ImageGrayscale(const cv::Mat& imgFrame, cv::Mat& imgGrayscale, const std::vector<cv::Rect>& regions);
+	void ImageContrast(cv::Mat& imgGrayscale, cv::Mat& imgContrast);
+	void ImageContrast(const cv::Mat& imgGrayscale, cv::Mat& imgContrast, const std::vector<cv::Rect>& regions);
+	bool ImageThreshold(cv::Mat& imgContrast, cv::Mat& imgThresh, EdgeType edgeType = EdgeType::Threshold);
+	bool ImageThreshold(const cv::Mat& imgContrast, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, EdgeType edgeType = EdgeType::Threshold);
+	bool ImageSearch(const cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, CarComponents& components, std::vector<CarPlateCandidate>& candidates, CarDetectTiming* timingPtr = nullptr);
+	void ImageDrawContours(cv::Mat& imgThresh);
+	void ImageDrawContours(cv::Mat& imgThresh, CarComponents& components);
+	void ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh);
+	void ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const CarComponents& components, std::vector<CarPlateCandidate>& candidates);
+	bool ImageCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const std::vector<cv::Rect>& regions, CarComponents& components, std::vector<CarPlateCandidate>& candidates);
+	void ImageRecognize(cv::Mat& imgFrame, cv::Mat& imgGrayscale);
+	void ImageRecognize(cv::Mat& imgFrame, cv::Mat& imgGrayscale, const std::vector<CarPlateCandidate>& candidates, std::vector<CarPlateRead>& reads);
+	void ImageMatch(cv::Mat& imgFrame, const cv::Mat& imgMask, int alpha = 50);
+	void ImageMatch(cv::Mat& imgFrame, const cv::Mat& imgMask, const std::vector<CarPlateCandidate>& candidates, int alpha = 50);
+
+private:
+	CarPlateDetector(const CarPlateDetector&) = delete;				//!< Disable copy construction
+	CarPlateDetector& operator=(const CarPlateDetector&) = delete;	//!< Disable assignment operator
+	void ContrastRegion(const cv::Mat& imgGrayscale, cv::Mat& imgContrast, const cv::Rect& region);
+	void DrawCandidates(cv::Mat& imgFrame, cv::Mat& imgThresh, const std::vector<CarPlateCandidate>& candidates);
+	static void MatchRegion(cv::Mat& imgFrame, const cv::Mat& imgMask, const cv::Rect& region, float weight);
+
+	CarStreamMetrics*	m_metricsPtr;			//!< 各階段計時 (可為 nullptr)
+	CarMotionGate		m_cMotion;				//!< 畫面變化偵測 (靜止時略過偵測)
+	bool				m_isIdle;				//!< 最近一幀畫面靜止，未進行偵測
+	CarPlateTracker		m_cTracker;				//!< 車牌位置追蹤 (只搜尋已知車牌附近區域)
+	uint64_t			m_nFrames;				//!< 已輸入幀數 (追蹤用幀序號)
+	std::vector<cv::Rect> m_vecRegions;			//!< 當前幀搜尋區域
+	std::vector<CarPlateCandidate> m_vecRegionCandidates;	//!< 單一搜尋區域候選暫存
+	CarPlateVoter		m_cVoter;				//!< 跨幀車牌辨識結果投票與去重複
+	std::vector<CarPlateEvent> m_vecEvents;		//!< 當前幀產生的車牌事件
+	CarLabeling			m_cLabeling;			//!< 連通元件標記
+	CarComponents		m_cComponents;			//!< 當前幀連通元件統計資料
+	CarCandidateFilter	m_cCandidateFilter;		//!< 車牌候選區域篩選
+	std::vector<CarPlateCandidate> m_vecCandidates;	//!< 當前幀車牌候選區域
+	CarPlateOcr			m_cOcr;					//!< 車牌字元辨識
+	std::vector<CarPlateRead> m_vecReads;		//!< 當前幀各候選區域辨識結果
+	CarWorkspace		m_cWorkspace;			//!< 暫存影像工作區 (解析度改變時才重新配置)
+	CarTiledPreprocess	m_cTiled;				//!< 分塊融合預處理
+	bool				m_isTiled;				//!< 搜尋區域預處理使用分塊融合 (否則分段處理)
+	std::vector<cv::Rect> m_vecOverlayRegions;	//!< 疊合區域暫存 (合併重疊的候選區域)
+};
+
+#endif // !ODMC_CARPLATE_DETECTOR_HH
@@ -0,0 +1,631 @@
+﻿/**************************************************************************//**
+ * @file	eventlog.cc
+ * @brief	CarEventWriter 與各事件輸出端類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include "eventlog.hh"
+
+#if defined(_WIN32)
+#	include <io.h>
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#else
+#	include <errno.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/socket.h>
+#	include <sys/stat.h>
+#	include <sys/time.h>
+#	include <sys/un.h>
+#endif
+
+/**
+ *	@brief	CarFileEventSink 建構式
+ *	@return	此函數沒有返回值
+ */
+CarFileEventSink::CarFileEventSink()
+	: m_nFile(-1)
+	, m_isDirty(false) {
+}
+
+/**
+ *	@brief	CarFileEventSink 解構式
+ *	@return	此函數沒有返回值
+ */
+CarFileEventSink::~CarFileEventSink() { this->Close(); }
+
+/**
+ *	@brief	以附加方式開啟 (或建立) 事件檔案
+ *	@param[in]	pathPtr	(指標) 檔案路徑
+ *	@return	<b>型別: bool</b> \n 若開啟成功返回值為非零值 (true)。 \n 若開啟失敗返回值為零 (false)。
+ */
+bool CarFileEventSink::Open(const char* pathPtr)
+{
+	this->Close();
+	if (pathPtr == nullptr) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	m_nFile = ::_open(pathPtr, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	m_nFile = ::open(pathPtr, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+	return m_nFile >= 0;
+}
+
+/**
+ *	@brief	[重載] 設定開頭資料，檔案為空時立即寫入 (附加至既有記錄時不重複寫入)。
+ */
+void CarFileEventSink::Begin(const std::string& preamble)
+{
+	CarEventSink::Begin(preamble);
+	if (m_nFile < 0 || preamble.empty()) {
+		return;
+	}
+
+#if defined(_WIN32)
+	const bool isEmpty = ::_filelengthi64(m_nFile) == 0;
+#else
+	struct stat st;
+	const bool isEmpty = ::fstat(m_nFile, &st) == 0 && st.st_size == 0;
+#endif
+	if (isEmpty) {
+		this->Write(preamble.data(), preamble.size());
+	}
+}
+
+/**
+ *	@brief	[重載] 寫入資料 (寫入不完整時繼續寫入剩餘部分)
+ */
+bool CarFileEventSink::Write(const void* dataPtr, size_t size)
+{
+	if (m_nFile < 0) {
+		return false;
+	}
+
+	auto bytePtr = static_cast<const char*>(dataPtr);
+	while (size > 0) {
+#if defined(_WIN32)
+		const int chunk = static_cast<int>(std::min<size_t>(size, INT_MAX));
+		const int written = ::_write(m_nFile, bytePtr, static_cast<unsigned int>(chunk));
+		if (written <= 0) {
+			return false;
+		}
+#else
+		const ssize_t written = ::write(m_nFile, bytePtr, size);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			return false;
+		}
+#endif
+		bytePtr += written;
+		size -= static_cast<size_t>(written);
+		m_isDirty = true;
+	}
+	return true;
+}
+
+/**
+ *	@brief	[重載] 上次同步後有寫入時同步至儲存裝置 (fsync)
+ */
+void CarFileEventSink::Sync()
+{
+	if (m_nFile < 0 || !m_isDirty) {
+		return;
+	}
+
+#if defined(_WIN32)
+	::_commit(m_nFile);
+#else
+	::fsync(m_nFile);
+#endif
+	m_isDirty = false;
+}
+
+/**
+ *	@brief	[重載] 同步並關閉檔案
+ */
+void CarFileEventSink::Close()
+{
+	if (m_nFile < 0) {
+		return;
+	}
+
+	this->Sync();
+#if defined(_WIN32)
+	::_close(m_nFile);
+#else
+	::close(m_nFile);
+#endif
+	m_nFile = -1;
+}
+
+/**
+ *	@brief	CarSocketEventSink 建構式
+ *	@return	此函數沒有返回值
+ */
+CarSocketEventSink::CarSocketEventSink()
+	: m_nSocket(-1) {
+}
+
+/**
+ *	@brief	CarSocketEventSink 解構式
+ *	@return	此函數沒有返回值
+ */
+CarSocketEventSink::~CarSocketEventSink() { this->Close(); }
+
+/**
+ *	@brief	設定 socket 路徑並嘗試連接
+ *	@param[in]	pathPtr	(指標) UNIX domain socket 路徑
+ *	@return	<b>型別: bool</b> \n 若路徑有效返回值為非零值 (true)，連接失敗時之後寫入會重新連接。 \n 若路徑無效或平台不支援返回值為零 (false)。
+ */
+bool CarSocketEventSink::Open(const char* pathPtr)
+{
+	this->Close();
+	if (pathPtr == nullptr || pathPtr[0] == '\0') {
+		return false;
+	}
+
+#if defined(_WIN32)
+	return false;
+#else
+	struct sockaddr_un addr;
+	if (::strlen(pathPtr) >= sizeof(addr.sun_path)) {
+		return false;
+	}
+
+	m_strPath = pathPtr;
+	m_tRetry = std::chrono::steady_clock::time_point();
+	this->Connect();
+	return true;
+#endif
+}
+
+/**
+ *	@brief	[重載] 寫入資料，尚未連接時 (依重新連接間隔) 先連接並送出開頭資料。
+ */
+bool CarSocketEventSink::Write(const void* dataPtr, size_t size)
+{
+	if (m_nSocket < 0 && !this->Connect()) {
+		return false;
+	}
+	if (!this->Send(dataPtr, size)) {
+		this->Disconnect();
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	[重載] 關閉 socket，之後不再重新連接。
+ */
+void CarSocketEventSink::Close()
+{
+	this->Disconnect();
+	m_strPath.clear();
+}
+
+/**
+ *	@brief	連接 socket 並送出開頭資料，距離上次失敗未達 CAR_EVENT_RECONNECT_MS 時不嘗試。
+ *	@return	<b>型別: bool</b> \n 若連接成功返回值為非零值 (true)。 \n 若連接失敗或尚未到達重新連接時間返回值為零 (false)。
+ */
+bool CarSocketEventSink::Connect()
+{
+#if defined(_WIN32)
+	return false;
+#else
+	const auto now = std::chrono::steady_clock::now();
+	if (m_strPath.empty() || now < m_tRetry) {
+		return false;
+	}
+	m_tRetry = now + std::chrono::milliseconds(CAR_EVENT_RECONNECT_MS);
+
+	for (;;) {
+		struct sockaddr_un addr;
+		::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		::memcpy(addr.sun_path, m_strPath.c_str(), m_strPath.size());
+
+		m_nSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_nSocket < 0) break;
+		::fcntl(m_nSocket, F_SETFD, FD_CLOEXEC);
+
+		// 接收端停滯時寫入逾時視為斷線，背景寫入 thread 不會無限期阻塞
+		struct timeval timeout;
+		timeout.tv_sec = CAR_EVENT_RECONNECT_MS / 1000;
+		timeout.tv_usec = (CAR_EVENT_RECONNECT_MS % 1000) * 1000;
+		::setsockopt(m_nSocket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#if defined(SO_NOSIGPIPE)
+		const int on = 1;
+		::setsockopt(m_nSocket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+		if (::connect(m_nSocket, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) != 0) break;
+		if (!m_strPreamble.empty() && !this->Send(m_strPreamble.data(), m_strPreamble.size())) break;
+		return true;
+	}
+
+	this->Disconnect();
+	return false;
+#endif
+}
+
+/**
+ *	@brief	送出資料 (送出不完整時繼續送出剩餘部分)
+ *	@param[in]	dataPtr	(指標) 資料
+ *	@param[in]	size	資料大小 (bytes)
+ *	@return	<b>型別: bool</b> \n 若送出成功返回值為非零值 (true)。 \n 若連接中斷或逾時返回值為零 (false)。
+ */
+bool CarSocketEventSink::Send(const void* dataPtr, size_t size)
+{
+#if defined(_WIN32)
+	(void)dataPtr;
+	(void)size;
+	return false;
+#else
+#	if defined(MSG_NOSIGNAL)
+	const int flags = MSG_NOSIGNAL;
+#	else
+	const int flags = 0;
+#	endif
+
+	auto bytePtr = static_cast<const char*>(dataPtr);
+	while (size > 0) {
+		const ssize_t sent = ::send(m_nSocket, bytePtr, size, flags);
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent <= 0) {
+			return false;
+		}
+		bytePtr += sent;
+		size -= static_cast<size_t>(sent);
+	}
+	return true;
+#endif
+}
+
+/**
+ *	@brief	關閉目前的連接 (保留路徑，之後寫入時重新連接)
+ *	@return	此函數沒有返回值
+ */
+void CarSocketEventSink::Disconnect()
+{
+#if !defined(_WIN32)
+	if (m_nSocket >= 0) {
+		::close(m_nSocket);
+	}
+#endif
+	m_nSocket = -1;
+}
+
+/**
+ *	@brief	CarEventWriter 建構式
+ *	@return	此函數沒有返回值
+ */
+CarEventWriter::CarEventWriter()
+	: m_eFormat(EventFormat::JsonLines)
+	, m_threadPtr(nullptr)
+	, m_isKeep(false) {
+}
+
+/**
+ *	@brief	CarEventWriter 解構式
+ *	@return	此函數沒有返回值
+ */
+CarEventWriter::~CarEventWriter()
+{
+	this->Stop();
+	for (auto& sink : m_vecSinks) {
+		sink->Close();
+	}
+}
+
+/**
+ *	@brief	加入輸出端，必須於啟動前呼叫。
+ *	@param[in]	sink	輸出端物件 (已開啟)，所有權轉移至此物件。
+ *	@return	<b>型別: bool</b> \n 若加入成功返回值為非零值 (true)。 \n 若已啟動或物件無效返回值為零 (false)。
+ */
+bool CarEventWriter::AddSink(std::unique_ptr<CarEventSink> sink)
+{
+	if (sink == nullptr || this->IsRunning()) {
+		return false;
+	}
+	m_vecSinks.push_back(std::move(sink));
+	return true;
+}
+
+/**
+ *	@brief	建立事件佇列並啟動背景寫入 thread
+ *	@param[in]	format		輸出格式
+ *	@param[in]	capacity	事件佇列容量 (向上取 2 的次方)
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若沒有輸出端、佇列配置失敗或 thread 建立失敗返回值為零 (false)。
+ *	@remark	二進位格式時各輸出端的開頭資料為檔頭 (空檔案於此時寫入，socket 於每次連接後送出)。
+ */
+bool CarEventWriter::Start(EventFormat format, size_t capacity)
+{
+	this->Stop();
+	if (m_vecSinks.empty()) {
+		return false;
+	}
+
+	m_cQueue.reset(new (std::nothrow) EventQueue(capacity));
+	if (m_cQueue == nullptr || !m_cQueue->IsValid()) {
+		m_cQueue.reset();
+		return false;
+	}
+
+	m_eFormat = format;
+	std::string preamble;
+	if (format == EventFormat::Binary) {
+		CarEventLogHeader header;
+		::memset(&header, 0, sizeof(header));
+		::memcpy(header.magic, CAR_EVENT_LOG_MAGIC, sizeof(header.magic));
+		header.version = CAR_EVENT_LOG_VERSION;
+		header.headerSize = sizeof(CarEventLogHeader);
+		header.recordSize = sizeof(CarDetectEvent);
+		preamble.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	for (auto& sink : m_vecSinks) {
+		sink->m_nWritten.store(0);
+		sink->m_nFailed.store(0);
+		sink->Begin(preamble);
+	}
+
+	m_isKeep.store(true);
+	m_threadPtr = new (std::nothrow) std::thread(&CarEventWriter::WriterProcess, this);
+	if (m_threadPtr == nullptr) {
+		m_isKeep.store(false);
+		m_cQueue.reset();
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	停止背景寫入 thread (寫完佇列內所有事件並同步輸出端)
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isKeep.store(false);
+		m_cvStop.notify_all();
+	}
+
+	if (m_threadPtr != nullptr) {
+		if (m_threadPtr->joinable()) {
+			m_threadPtr->join();
+		}
+		SAFE_DELETE(m_threadPtr);
+	}
+}
+
+/**
+ *	@brief	放入一筆事件 (可由多個偵測 thread 同時呼叫，不進行 I/O、不阻塞)
+ *	@param[in]	event	偵測事件
+ *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若尚未啟動或佇列已滿 (事件丟棄) 返回值為零 (false)。
+ */
+bool CarEventWriter::Post(const CarDetectEvent& event)
+{
+	if (!this->IsRunning()) {
+		return false;
+	}
+	return m_cQueue->Push(event);
+}
+
+/**
+ *	@brief	由候選區域與單幀辨識結果建立事件
+ *	@param[out]	event		事件
+ *	@param[in]	streamId	串流編號
+ *	@param[in]	frameIndex	來源幀序
+ *	@param[in]	timestampMs	來源幀時間戳記 (ms)
+ *	@param[in]	candidate	車牌候選區域
+ *	@param[in]	readPtr		(指標) 辨識結果，nullptr 或無法辨識時文字為空字串。
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::MakeEvent(CarDetectEvent& event, int streamId, uint64_t frameIndex, double timestampMs, const CarPlateCandidate& candidate, const CarPlateRead* readPtr)
+{
+	::memset(&event, 0, sizeof(event));
+	event.frameIndex = frameIndex;
+	event.timestampMs = timestampMs;
+	event.streamId = streamId;
+	event.track = candidate.track;
+	event.x = candidate.rect.x;
+	event.y = candidate.rect.y;
+	event.width = candidate.rect.width;
+	event.height = candidate.rect.height;
+	event.frames = 1;
+	if (readPtr != nullptr && readPtr->count > 0) {
+		event.confidence = readPtr->confidence;
+		::snprintf(event.text, sizeof(event.text), "%s", readPtr->text);
+	}
+}
+
+/**
+ *	@brief	由跨幀投票產生的車牌事件建立事件
+ *	@param[out]	event		事件
+ *	@param[in]	streamId	串流編號
+ *	@param[in]	timestampMs	產生事件的幀時間戳記 (ms)
+ *	@param[in]	plateEvent	車牌事件
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::MakeEvent(CarDetectEvent& event, int streamId, double timestampMs, const CarPlateEvent& plateEvent)
+{
+	::memset(&event, 0, sizeof(event));
+	event.frameIndex = plateEvent.firstIndex;
+	event.timestampMs = timestampMs;
+	event.streamId = streamId;
+	event.track = plateEvent.track;
+	event.x = plateEvent.rect.x;
+	event.y = plateEvent.rect.y;
+	event.width = plateEvent.rect.width;
+	event.height = plateEvent.rect.height;
+	event.confidence = plateEvent.read.confidence;
+	event.frames = plateEvent.frames;
+	::snprintf(event.text, sizeof(event.text), "%s", plateEvent.read.text);
+}
+
+/**
+ *	@brief	設定事件的截圖參考
+ *	@param[in,out]	event	事件
+ *	@param[in]		cropPtr	(指標) 截圖參考，nullptr 或空字串 = 無。
+ *	@return	<b>型別: bool</b> \n 若設定成功返回值為非零值 (true)。 \n 若超過欄位長度返回值為零 (false)，截圖參考維持空字串 (不寫入截斷的參考)。
+ */
+bool CarEventWriter::SetCrop(CarDetectEvent& event, const char* cropPtr)
+{
+	const int length = ::snprintf(event.crop, sizeof(event.crop), "%s", (cropPtr != nullptr) ? cropPtr : "");
+	if (length < 0 || static_cast<size_t>(length) >= sizeof(event.crop)) {
+		event.crop[0] = '\0';
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	[重載] 設定事件的截圖參考為來源幀位置 "<來源>#<幀序>"
+ *	@param[in,out]	event		事件
+ *	@param[in]		sourcePtr	(指標) 來源 (檔案路徑、串流網址或 replay:<錄製檔>)
+ *	@param[in]		frameIndex	來源幀序
+ *	@return	<b>型別: bool</b> \n 若設定成功返回值為非零值 (true)。 \n 若來源無效或超過欄位長度返回值為零 (false)，截圖參考維持空字串。
+ *	@remark	以錄製檔為來源時可由 replay:<錄製檔> 重播並取出該幀重新產生截圖。
+ */
+bool CarEventWriter::SetCrop(CarDetectEvent& event, const char* sourcePtr, uint64_t frameIndex)
+{
+	event.crop[0] = '\0';
+	if (sourcePtr == nullptr || sourcePtr[0] == '\0') {
+		return false;
+	}
+
+	const int length = ::snprintf(event.crop, sizeof(event.crop), "%s#%llu", sourcePtr, static_cast<unsigned long long>(frameIndex));
+	if (length < 0 || static_cast<size_t>(length) >= sizeof(event.crop)) {
+		event.crop[0] = '\0';
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	將事件編碼為一行 JSON 並附加至輸出字串
+ *	@param[in]		event	事件
+ *	@param[in,out]	output	輸出字串
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::FormatJson(const CarDetectEvent& event, std::string& output)
+{
+	char buffer[256];
+	::snprintf(buffer, sizeof(buffer), "{\"stream\":%d,\"frame\":%llu,\"time_ms\":%.3f,\"track\":%d,\"frames\":%d,\"box\":[%d,%d,%d,%d],\"confidence\":%.3f,\"text\":\"",
+		event.streamId, static_cast<unsigned long long>(event.frameIndex), event.timestampMs, event.track, event.frames,
+		event.x, event.y, event.width, event.height, event.confidence);
+	output += buffer;
+	CarEventWriter::AppendString(output, event.text, sizeof(event.text));
+	output += '"';
+
+	if (event.crop[0] != '\0') {
+		output += ",\"crop\":\"";
+		CarEventWriter::AppendString(output, event.crop, sizeof(event.crop));
+		output += '"';
+	}
+	output += "}\n";
+}
+
+/**
+ *	@brief	背景寫入 thread process: 批次取出事件寫入輸出端，定期同步。
+ *	@param[in]	cThisPtr	(指標) CarEventWriter 物件
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::WriterProcess(CarEventWriter* cThisPtr)
+{
+	typedef std::chrono::steady_clock Clock;
+	auto syncTime = Clock::now() + std::chrono::milliseconds(CAR_EVENT_SYNC_MS);
+
+	while (cThisPtr->m_isKeep.load()) {
+		if (!cThisPtr->Drain()) {
+			std::unique_lock<std::mutex> lock(cThisPtr->m_mutex);
+			cThisPtr->m_cvStop.wait_for(lock, std::chrono::milliseconds(CAR_EVENT_FLUSH_MS), [cThisPtr]() {
+				return !cThisPtr->m_isKeep.load();
+			});
+		}
+
+		if (Clock::now() >= syncTime) {
+			for (auto& sink : cThisPtr->m_vecSinks) {
+				sink->Sync();
+			}
+			syncTime = Clock::now() + std::chrono::milliseconds(CAR_EVENT_SYNC_MS);
+		}
+	}
+
+	// 停止時寫完剩餘事件
+	while (cThisPtr->Drain()) {}
+	for (auto& sink : cThisPtr->m_vecSinks) {
+		sink->Sync();
+	}
+}
+
+/**
+ *	@brief	取出最多 CAR_EVENT_BATCH_MAX 筆事件，編碼後一次寫入所有輸出端。
+ *	@return	<b>型別: bool</b> \n 若有取出事件返回值為非零值 (true)。 \n 若佇列為空返回值為零 (false)。
+ *	@remark	依各輸出端的寫入結果分別計入該輸出端的已寫入或失敗數量 (寫入失敗的輸出端捨棄此批資料)。
+ */
+bool CarEventWriter::Drain()
+{
+	CarDetectEvent event;
+	size_t count = 0;
+
+	m_strBatch.clear();
+	while (count < CAR_EVENT_BATCH_MAX && m_cQueue->Pop(event)) {
+		if (m_eFormat == EventFormat::Binary) {
+			m_strBatch.append(reinterpret_cast<const char*>(&event), sizeof(event));
+		}
+		else {
+			CarEventWriter::FormatJson(event, m_strBatch);
+		}
+		count++;
+	}
+	if (count == 0) {
+		return false;
+	}
+
+	for (auto& sink : m_vecSinks) {
+		if (sink->Write(m_strBatch.data(), m_strBatch.size())) {
+			sink->m_nWritten.fetch_add(count, std::memory_order_relaxed);
+		}
+		else {
+			sink->m_nFailed.fetch_add(count, std::memory_order_relaxed);
+		}
+	}
+	return true;
+}
+
+/**
+ *	@brief	附加 JSON 字串內容 (跳脫引號、反斜線與控制字元)
+ *	@param[in,out]	output		輸出字串
+ *	@param[in]		textPtr		(指標) 字串 (以 '\0' 結尾或長度為 maxLength)
+ *	@param[in]		maxLength	最大長度
+ *	@return	此函數沒有返回值
+ */
+void CarEventWriter::AppendString(std::string& output, const char* textPtr, size_t maxLength)
+{
+	char buffer[8];
+	for (size_t i = 0; i < maxLength && textPtr[i] != '\0'; i++) {
+		const auto c = static_cast<unsigned char>(textPtr[i]);
+		if (c == '"' || c == '\\') {
+			output += '\\';
+			output += static_cast<char>(c);
+		}
+		else if (c < 0x20) {
+			::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+			output += buffer;
+		}
+		else {
+			output += static_cast<char>(c);
+		}
+	}
+}
@@ -0,0 +1,225 @@
+﻿/**************************************************************************//**
+ * @file	eventlog.hh
+ * @brief	CarEventWriter 偵測事件非同步輸出類別與事件記錄格式宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_EVENTLOG_HH
+#define	ODMC_CARPLATE_EVENTLOG_HH
+#include <string>
+#include "mpscqueue.hh"
+#include "voting.hh"
+
+#define CAR_EVENT_LOG_MAGIC		"ODMCEVT"	//!< 二進位事件記錄識別碼 (含結尾 0 共 8 bytes)
+#define CAR_EVENT_LOG_VERSION	1			//!< 二進位事件記錄版本
+#define CAR_EVENT_TEXT_CHARS	16			//!< 事件車牌文字欄位大小 (含結尾 0)
+#define CAR_EVENT_CROP_CHARS	64			//!< 事件截圖參考欄位大小 (含結尾 0)
+
+/**
+ *	@enum	EventFormat
+ *	@brief	偵測事件輸出格式
+ */
+enum class EventFormat {
+	JsonLines = 0,		//!< JSON lines (每筆事件一行)
+	Binary,				//!< 二進位記錄 (CarEventLogHeader + 固定大小 CarDetectEvent)
+};
+
+/**
+ *	@struct	CarDetectEvent
+ *	@brief	偵測事件 (little-endian，128 bytes，二進位記錄直接寫入此結構)
+ *	@remark	固定大小不含指標，可直接複製進出無鎖佇列。未辨識出文字的候選區域 text 為空字串、信心值為 0。
+ */
+struct CarDetectEvent {
+	uint64_t	frameIndex;					//!< 來源幀序 (投票事件為第一次辨識的幀序)
+	double		timestampMs;				//!< 來源幀時間戳記 (ms，由串流開始起算)
+	int32_t		streamId;					//!< 串流編號
+	int32_t		track;						//!< 車牌軌跡編號 (-1 = 未追蹤的單幀結果)
+	int32_t		x;							//!< 車牌外接矩形左邊界 (pixel)
+	int32_t		y;							//!< 車牌外接矩形上邊界 (pixel)
+	int32_t		width;						//!< 車牌外接矩形寬度 (pixel)
+	int32_t		height;						//!< 車牌外接矩形高度 (pixel)
+	float		confidence;					//!< 車牌信心值 (0 ~ 1)
+	int32_t		frames;						//!< 參與投票的幀數 (單幀結果為 1)
+	char		text[CAR_EVENT_TEXT_CHARS];	//!< 車牌文字 (以 '\0' 結尾)
+	char		crop[CAR_EVENT_CROP_CHARS];	//!< 截圖參考 (如截圖檔名或錄製檔位置，空字串 = 無)
+};
+static_assert(sizeof(CarDetectEvent) == 128, "CarDetectEvent must be 128 bytes");
+
+/**
+ *	@struct	CarEventLogHeader
+ *	@brief	二進位事件記錄檔頭 (little-endian，32 bytes)
+ *	@remark	記錄配置: [檔頭][事件 0][事件 1]...，每筆事件大小為 recordSize。
+ *			檔案輸出以附加方式開啟，只有空檔案寫入檔頭；socket 輸出每次連接後先送出檔頭。
+ */
+struct CarEventLogHeader {
+	char		magic[8];			//!< 識別碼 CAR_EVENT_LOG_MAGIC
+	uint32_t	version;			//!< 記錄版本 CAR_EVENT_LOG_VERSION
+	uint32_t	headerSize;			//!< 檔頭大小 sizeof(CarEventLogHeader)
+	uint32_t	recordSize;			//!< 每筆事件大小 sizeof(CarDetectEvent)
+	uint32_t	reserved[3];		//!< 保留 (0)
+};
+static_assert(sizeof(CarEventLogHeader) == 32, "CarEventLogHeader must be 32 bytes");
+
+/**
+ *	@class	CarEventSink
+ *	@brief	偵測事件輸出端介面 (只由背景寫入 thread 呼叫)
+ *	@remark	寫入數量與失敗數量由 CarEventWriter 依各輸出端的寫入結果分別累計，可由其他 thread 讀取。
+ */
+class CarEventSink
+{
+	friend class CarEventWriter;
+
+public:
+	CarEventSink() : m_nWritten(0), m_nFailed(0) {}
+	virtual ~CarEventSink() {}
+
+	uint64_t GetWritten() const { return m_nWritten.load(std::memory_order_relaxed); }
+	uint64_t GetFailed() const { return m_nFailed.load(std::memory_order_relaxed); }
+
+	/**
+	 *	@brief	寫入一批已編碼的事件資料
+	 *	@param[in]	dataPtr	(指標) 資料
+	 *	@param[in]	size	資料大小 (bytes)
+	 *	@return	<b>型別: bool</b> \n 若寫入成功返回值為非零值 (true)。 \n 若寫入失敗返回值為零 (false)，此批資料捨棄。
+	 */
+	virtual bool Write(const void* dataPtr, size_t size) = 0;
+
+	/**
+	 *	@brief	將已寫入的資料同步至儲存裝置 (由背景寫入 thread 定期呼叫)
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Sync() {}
+
+	/**
+	 *	@brief	關閉輸出端
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Close() = 0;
+
+	/**
+	 *	@brief	開始輸出前由 CarEventWriter::Start 呼叫，設定開頭資料 (二進位記錄檔頭)。
+	 *	@param[in]	preamble	開頭資料 (空字串 = 無)，空檔案或每次連接後先寫入。
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Begin(const std::string& preamble) { m_strPreamble = preamble; }
+
+protected:
+	std::string		m_strPreamble;		//!< 開頭資料
+
+private:
+	CarEventSink(const CarEventSink&) = delete;				//!< Disable copy construction
+	CarEventSink& operator=(const CarEventSink&) = delete;	//!< Disable assignment operator
+
+	std::atomic<uint64_t>	m_nWritten;		//!< 已寫入此輸出端的事件數量
+	std::atomic<uint64_t>	m_nFailed;		//!< 此輸出端寫入失敗 (捨棄) 的事件數量
+};
+
+/**
+ *	@class	CarFileEventSink
+ *	@brief	檔案輸出端: 以附加方式寫入，由背景寫入 thread 定期 fsync。
+ */
+class CarFileEventSink : public CarEventSink
+{
+public:
+	CarFileEventSink();
+	virtual ~CarFileEventSink();
+
+	bool Open(const char* pathPtr);
+	bool IsOpened() const { return m_nFile >= 0; }
+
+	void Begin(const std::string& preamble) override;
+	bool Write(const void* dataPtr, size_t size) override;
+	void Sync() override;
+	void Close() override;
+
+private:
+	CarFileEventSink(const CarFileEventSink&) = delete;				//!< Disable copy construction
+	CarFileEventSink& operator=(const CarFileEventSink&) = delete;	//!< Disable assignment operator
+
+	int				m_nFile;		//!< 檔案描述子
+	bool			m_isDirty;		//!< 上次同步後是否有寫入
+};
+
+/**
+ *	@class	CarSocketEventSink
+ *	@brief	本機 UNIX domain socket (SOCK_STREAM) 輸出端，供索引服務接收事件。
+ *	@remark	連接中斷或寫入失敗時關閉 socket，之後每隔 CAR_EVENT_RECONNECT_MS 於寫入時重新連接，
+ *			斷線期間的事件捨棄 (不阻塞背景寫入 thread 也不累積記憶體)。Windows 平台不支援。
+ */
+class CarSocketEventSink : public CarEventSink
+{
+public:
+	CarSocketEventSink();
+	virtual ~CarSocketEventSink();
+
+	bool Open(const char* pathPtr);
+	bool IsConnected() const { return m_nSocket >= 0; }
+
+	bool Write(const void* dataPtr, size_t size) override;
+	void Close() override;
+
+private:
+	CarSocketEventSink(const CarSocketEventSink&) = delete;				//!< Disable copy construction
+	CarSocketEventSink& operator=(const CarSocketEventSink&) = delete;	//!< Disable assignment operator
+	bool Connect();
+	bool Send(const void* dataPtr, size_t size);
+	void Disconnect();
+
+	std::string		m_strPath;		//!< socket 路徑
+	int				m_nSocket;		//!< socket 描述子
+	std::chrono::steady_clock::time_point m_tRetry;	//!< 下一次允許重新連接的時間
+};
+
+/**
+ *	@class	CarEventWriter
+ *	@brief	偵測事件非同步輸出
+ *	@remark	偵測 thread 呼叫 Post 將事件放入無鎖 MPSC 佇列後立即返回，不進行任何 I/O (佇列已滿時丟棄並計數)。
+ *			背景寫入 thread 每次最多取出 CAR_EVENT_BATCH_MAX 筆事件，編碼為 JSON lines 或二進位記錄後
+ *			一次寫入所有輸出端 (各輸出端分別計數寫入與失敗的事件，一個輸出端失敗不影響其他輸出端)，
+ *			佇列為空時休眠 CAR_EVENT_FLUSH_MS；檔案輸出端每隔 CAR_EVENT_SYNC_MS fsync 一次。
+ *			停止時先寫完佇列內所有事件並同步後才關閉輸出端。
+ */
+class CarEventWriter
+{
+public:
+	CarEventWriter();
+	virtual ~CarEventWriter();
+
+	bool AddSink(std::unique_ptr<CarEventSink> sink);
+	bool Start(EventFormat format = EventFormat::JsonLines, size_t capacity = CAR_EVENT_QUEUE_CAPACITY);
+	void Stop();
+	bool Post(const CarDetectEvent& event);
+
+	bool IsRunning() const { return m_isKeep.load(); }
+	size_t GetSinkCount() const { return m_vecSinks.size(); }
+	uint64_t GetPosted() const { return (m_cQueue != nullptr) ? m_cQueue->GetProduced() : 0; }
+	uint64_t GetDropped() const { return (m_cQueue != nullptr) ? m_cQueue->GetDropped() : 0; }
+	const CarEventSink* GetSink(size_t index) const { return (index < m_vecSinks.size()) ? m_vecSinks[index].get() : nullptr; }
+
+	static void MakeEvent(CarDetectEvent& event, int streamId, uint64_t frameIndex, double timestampMs, const CarPlateCandidate& candidate, const CarPlateRead* readPtr);
+	static void MakeEvent(CarDetectEvent& event, int streamId, double timestampMs, const CarPlateEvent& plateEvent);
+	static bool SetCrop(CarDetectEvent& event, const char* cropPtr);
+	static bool SetCrop(CarDetectEvent& event, const char* sourcePtr, uint64_t frameIndex);
+	static void FormatJson(const CarDetectEvent& event, std::string& output);
+
+private:
+	CarEventWriter(const CarEventWriter&) = delete;				//!< Disable copy construction
+	CarEventWriter& operator=(const CarEventWriter&) = delete;	//!< Disable assignment operator
+	static void WriterProcess(CarEventWriter* cThisPtr);
+	static void AppendString(std::string& output, const char* textPtr, size_t maxLength);
+	bool Drain();
+
+	typedef CarMpscQueue<CarDetectEvent> EventQueue;
+
+	std::vector<std::unique_ptr<CarEventSink> > m_vecSinks;	//!< 輸出端
+	std::unique_ptr<EventQueue>	m_cQueue;		//!< 事件佇列
+	EventFormat				m_eFormat;			//!< 輸出格式
+	std::string				m_strBatch;			//!< 編碼暫存 (只由背景寫入 thread 使用)
+	std::thread*			m_threadPtr;		//!< 背景寫入 thread
+	std::atomic<bool>		m_isKeep;			//!< 是否繼續執行
+	std::mutex				m_mutex;			//!< 休眠等待用 mutex
+	std::condition_variable	m_cvStop;			//!< 停止通知
+};
+
+#endif // !ODMC_CARPLATE_EVENTLOG_HH
@@ -0,0 +1,200 @@
+﻿/**************************************************************************//**
+ * @file	framepool.cc
+ * @brief	CarFramePool 與 CarFrame 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "framepool.hh"
+
+/**
+ *	@brief	CarFrame 建構式 (空的 handle)
+ *	@return	此函數沒有返回值
+ */
+CarFrame::CarFrame()
+	: m_poolPtr(nullptr)
+	, m_nIndex(0)
+	, m_fTimestampMs(0.0)
+	, m_isStamped(false) {
+}
+
+/**
+ *	@brief	CarFrame 移動建構式
+ *	@param[in,out]	other	來源 handle，移動後為空的 handle。
+ *	@return	此函數沒有返回值
+ */
+CarFrame::CarFrame(CarFrame&& other)
+	: m_poolPtr(other.m_poolPtr)
+	, m_nIndex(other.m_nIndex)
+	, m_fTimestampMs(other.m_fTimestampMs)
+	, m_isStamped(other.m_isStamped) {
+	std::swap(m_img, other.m_img);
+	other.m_poolPtr = nullptr;
+	other.m_isStamped = false;
+}
+
+/**
+ *	@brief	CarFrame 移動指定運算子，原本持有的緩衝區先歸還緩衝池。
+ *	@param[in,out]	other	來源 handle，移動後為空的 handle。
+ *	@return	<b>型別: CarFrame&</b> \n 自身物件參考
+ */
+CarFrame& CarFrame::operator=(CarFrame&& other)
+{
+	if (this != &other) {
+		this->Release();
+		std::swap(m_img, other.m_img);
+		m_poolPtr = other.m_poolPtr;
+		m_nIndex = other.m_nIndex;
+		m_fTimestampMs = other.m_fTimestampMs;
+		m_isStamped = other.m_isStamped;
+		other.m_poolPtr = nullptr;
+		other.m_isStamped = false;
+	}
+	return *this;
+}
+
+/**
+ *	@brief	CarFrame 解構式
+ *	@return	此函數沒有返回值
+ */
+CarFrame::~CarFrame()
+{
+	this->Release();
+}
+
+/**
+ *	@brief	歸還緩衝區至緩衝池，handle 成為空的 handle (同時清除幀序與時間戳記)。
+ *	@return	此函數沒有返回值
+ */
+void CarFrame::Release()
+{
+	if (m_poolPtr != nullptr) {
+		m_poolPtr->Recycle(m_img);
+		m_poolPtr = nullptr;
+	}
+	m_img.release();
+	m_isStamped = false;
+}
+
+/**
+ *	@brief	CarFramePool 建構式
+ *	@param[in]	maxFree	每種規格最多保留的閒置緩衝區數量
+ *	@return	此函數沒有返回值
+ */
+CarFramePool::CarFramePool(size_t maxFree)
+	: m_nMaxFree(std::max<size_t>(maxFree, 1))
+	, m_nAllocations(0) {
+}
+
+/**
+ *	@brief	CarFramePool 解構式
+ *	@return	此函數沒有返回值
+ */
+CarFramePool::~CarFramePool()
+{
+	this->Clear();
+}
+
+/**
+ *	@brief	取得影像緩衝區
+ *	@param[in]	size	影像大小，為空時返回不含緩衝區的 handle (由解碼器決定規格後配置)。
+ *	@param[in]	type	影像型別
+ *	@return	<b>型別: CarFrame</b> \n 影像緩衝區 handle，內容未初始化。
+ */
+CarFrame CarFramePool::Acquire(cv::Size size, int type)
+{
+	CarFrame frame;
+	frame.m_poolPtr = this;
+
+	if (size.width > 0 && size.height > 0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto bucketPtr = this->FindBucket(size.height, size.width, type, false);
+		if (bucketPtr != nullptr && !bucketPtr->frames.empty()) {
+			std::swap(frame.m_img, bucketPtr->frames.back());
+			bucketPtr->frames.pop_back();
+			return frame;
+		}
+	}
+
+	// 沒有閒置緩衝區，配置新的緩衝區
+	m_nAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (size.width > 0 && size.height > 0) {
+		frame.m_img.create(size, type);
+	}
+	return frame;
+}
+
+/**
+ *	@brief	釋放所有閒置緩衝區
+ *	@return	此函數沒有返回值
+ */
+void CarFramePool::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_vecBuckets.clear();
+}
+
+/**
+ *	@brief	取得閒置緩衝區數量
+ *	@return	<b>型別: size_t</b> \n 所有規格閒置緩衝區總數
+ */
+size_t CarFramePool::GetFree()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	size_t count = 0;
+	for (const auto& bucket : m_vecBuckets) {
+		count += bucket.frames.size();
+	}
+	return count;
+}
+
+/**
+ *	@brief	回收緩衝區
+ *	@param[in,out]	img	要回收的影像，返回後為空的 cv::Mat。
+ *	@return	此函數沒有返回值
+ *	@remark	只回收獨佔且自行配置的緩衝區，仍被其他 cv::Mat 共用 (如 ROI) 的緩衝區直接釋放參考。
+ */
+void CarFramePool::Recycle(cv::Mat& img)
+{
+	if (img.empty() || img.u == nullptr || img.u->refcount != 1 || !img.isContinuous()) {
+		img.release();
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto bucketPtr = this->FindBucket(img.rows, img.cols, img.type(), true);
+	if (bucketPtr != nullptr && bucketPtr->frames.size() < m_nMaxFree) {
+		bucketPtr->frames.push_back(cv::Mat());
+		std::swap(bucketPtr->frames.back(), img);
+	}
+	img.release();
+}
+
+/**
+ *	@brief	搜尋指定規格的閒置緩衝區集合 (呼叫端需持有 m_mutex)
+ *	@param[in]	rows	影像高度
+ *	@param[in]	cols	影像寬度
+ *	@param[in]	type	影像型別
+ *	@param[in]	create	不存在時是否建立
+ *	@return	<b>型別: Bucket*</b> \n 若找到或建立成功返回集合指標。 \n 若不存在返回值為 nullptr。
+ */
+CarFramePool::Bucket* CarFramePool::FindBucket(int rows, int cols, int type, bool create)
+{
+	for (auto& bucket : m_vecBuckets) {
+		if (bucket.rows == rows && bucket.cols == cols && bucket.type == type) {
+			return &bucket;
+		}
+	}
+
+	if (!create) {
+		return nullptr;
+	}
+
+	m_vecBuckets.push_back(Bucket());
+	auto& bucket = m_vecBuckets.back();
+	bucket.rows = rows;
+	bucket.cols = cols;
+	bucket.type = type;
+	bucket.frames.reserve(m_nMaxFree);
+	return &bucket;
+}
@@ -0,0 +1,92 @@
+﻿/**************************************************************************//**
+ * @file	framepool.hh
+ * @brief	CarFramePool 影像緩衝池與 CarFrame 影像緩衝區 handle 類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_FRAMEPOOL_HH
+#define	ODMC_CARPLATE_FRAMEPOOL_HH
+#include "carcore.hh"
+
+class CarFramePool;
+
+/**
+ *	@class	CarFrame
+ *	@brief	影像緩衝區 handle (只能移動，不能複製)
+ *	@remark	緩衝區所有權隨 handle 在擷取、佇列與偵測之間傳遞，handle 釋放或解構時自動歸還緩衝池。
+ *			緩衝池必須比所有由它取得的 handle 更晚銷毀。擷取端可附加來源幀序與時間戳記，隨緩衝區一起傳遞。
+ */
+class CarFrame
+{
+public:
+	CarFrame();
+	CarFrame(CarFrame&& other);
+	CarFrame& operator=(CarFrame&& other);
+	~CarFrame();
+
+	void Release();
+	bool Empty() const { return m_img.empty(); }
+	cv::Mat& Image() { return m_img; }
+	const cv::Mat& Image() const { return m_img; }
+	void SetStamp(uint64_t index, double timestampMs) { m_nIndex = index; m_fTimestampMs = timestampMs; m_isStamped = true; }
+	bool IsStamped() const { return m_isStamped; }
+	uint64_t Index() const { return m_nIndex; }
+	double TimestampMs() const { return m_fTimestampMs; }
+
+private:
+	friend class CarFramePool;
+	CarFrame(const CarFrame&) = delete;				//!< Disable copy construction
+	CarFrame& operator=(const CarFrame&) = delete;	//!< Disable assignment operator
+
+	CarFramePool*	m_poolPtr;		//!< 所屬緩衝池 (nullptr 表示不歸還)
+	cv::Mat			m_img;			//!< 影像緩衝區
+	uint64_t		m_nIndex;		//!< 來源幀序 (由 0 起算，含擷取端依解碼模式跳過的幀)
+	double			m_fTimestampMs;	//!< 來源時間戳記 (ms，由串流開始起算)
+	bool			m_isStamped;	//!< 是否已附加幀序與時間戳記
+};
+
+/**
+ *	@class	CarFramePool
+ *	@brief	影像緩衝池，依影像大小與型別分類回收緩衝區
+ *	@remark	穩定狀態下 (影像規格不變) 每幀不需要配置記憶體。取得與歸還可以在不同 thread 進行。
+ */
+class CarFramePool
+{
+public:
+	CarFramePool(size_t maxFree = CAR_POOL_MAX_FREE);
+	virtual ~CarFramePool();
+
+	CarFrame Acquire(cv::Size size, int type);
+	void Clear();
+	uint64_t GetAllocations() const { return m_nAllocations.load(std::memory_order_relaxed); }
+	size_t GetFree();
+
+protected:
+	friend class CarFrame;
+	void Recycle(cv::Mat& img);
+
+private:
+	CarFramePool(const CarFramePool&) = delete;				//!< Disable copy construction
+	CarFramePool& operator=(const CarFramePool&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Bucket
+	 *	@brief	同規格閒置緩衝區
+	 */
+	struct Bucket {
+		int		rows;					//!< 影像高度
+		int		cols;					//!< 影像寬度
+		int		type;					//!< 影像型別
+		std::vector<cv::Mat> frames;	//!< 閒置緩衝區 (預留 m_nMaxFree 容量)
+	};
+
+	Bucket* FindBucket(int rows, int cols, int type, bool create);
+
+	size_t					m_nMaxFree;			//!< 每種規格最多保留的閒置緩衝區數量
+	std::atomic<uint64_t>	m_nAllocations;		//!< 緩衝區配置次數 (未命中閒置緩衝區)
+	std::mutex				m_mutex;			//!< 保護 m_vecBuckets
+	std::vector<Bucket>		m_vecBuckets;		//!< 各規格閒置緩衝區
+};
+
+#endif // !ODMC_CARPLATE_FRAMEPOOL_HH
@@ -0,0 +1,267 @@
+﻿/**************************************************************************//**
+ * @file	labeling.cc
+ * @brief	CarLabeling 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "labeling.hh"
+
+/**
+ *	@brief	重新設定元件數量 (僅在容量不足時才會重新配置記憶體)
+ *	@param[in]	count	元件數量
+ *	@return	此函數沒有返回值
+ */
+void CarComponents::Resize(size_t count)
+{
+	left.resize(count);
+	top.resize(count);
+	width.resize(count);
+	height.resize(count);
+	area.resize(count);
+	cx.resize(count);
+	cy.resize(count);
+	fill.resize(count);
+}
+
+/**
+ *	@brief	CarLabeling 建構式
+ *	@return	此函數沒有返回值
+ */
+CarLabeling::CarLabeling()
+	: m_nThreads(CAR_PARALLEL_THREADS) {
+}
+
+/**
+ *	@brief	CarLabeling 解構式
+ *	@return	此函數沒有返回值
+ */
+CarLabeling::~CarLabeling() {}
+
+/**
+ *	@brief	標記二值化影像的連通元件並統計元件資訊
+ *	@param[in]	imgBinary	cv::Mat 物件參考，二值化影像 (CV_8UC1，非零值為前景)。
+ *	@param[out]	components	CarComponents 物件參考，存放元件統計結果。
+ *	@return	<b>型別: bool</b> \n 若標記成功返回值為非零值 (true)。 \n 若影像格式錯誤返回值為零 (false)。
+ */
+bool CarLabeling::Labeling(const cv::Mat& imgBinary, CarComponents& components)
+{
+	components.Resize(0);
+	if (imgBinary.empty() || imgBinary.type() != CV_8UC1) {
+		return false;
+	}
+
+	// 依設定的 thread 數量 (未設定時為 OpenCV 執行緒數量) 切割列帶，每個列帶至少 CAR_LABEL_BAND_ROWS 列
+	const int rows = imgBinary.rows;
+	const int threads = (m_nThreads > 0) ? m_nThreads : cv::getNumThreads();
+	const int bands = std::max(1, std::min(threads, rows / CAR_LABEL_BAND_ROWS));
+	const int step = (rows + bands - 1) / bands;
+
+	m_vecBands.resize(static_cast<size_t>(bands));
+	for (int i = 0; i < bands; i++) {
+		m_vecBands[i].rowBegin = std::min(rows, i * step);
+		m_vecBands[i].rowEnd = std::min(rows, (i + 1) * step);
+	}
+
+	// 各列帶平行擷取線段並合併
+	cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; i++) {
+			this->LabelBand(imgBinary, m_vecBands[i]);
+		}
+	});
+
+	// 串接各列帶的 union-find 至全域陣列
+	int total = 0;
+	for (auto& band : m_vecBands) {
+		band.offset = total;
+		total += static_cast<int>(band.runs.size());
+	}
+
+	m_vecParent.resize(static_cast<size_t>(total));
+	for (const auto& band : m_vecBands) {
+		const int count = static_cast<int>(band.runs.size());
+		for (int i = 0; i < count; i++) {
+			m_vecParent[band.offset + i] = band.parent[i] + band.offset;
+		}
+	}
+
+	// 合併列帶接縫
+	for (size_t i = 1; i < m_vecBands.size(); i++) {
+		this->MergeSeam(m_vecBands[i - 1], m_vecBands[i]);
+	}
+
+	// 壓平 union-find，根節點必為集合中最小索引，因此單趟即可完成編號
+	int labels = 0;
+	m_vecLabel.resize(static_cast<size_t>(total));
+	for (int i = 0; i < total; i++) {
+		const int root = this->FindRoot(i);
+		m_vecLabel[i] = (root == i) ? labels++ : m_vecLabel[root];
+	}
+
+	// 統計元件資訊 (width/height 暫存右、下邊界)
+	const size_t count = static_cast<size_t>(labels);
+	components.Resize(count);
+	std::fill(components.left.begin(), components.left.end(), INT_MAX);
+	std::fill(components.top.begin(), components.top.end(), INT_MAX);
+	std::fill(components.width.begin(), components.width.end(), -1);
+	std::fill(components.height.begin(), components.height.end(), -1);
+	std::fill(components.area.begin(), components.area.end(), 0);
+	m_vecSumX.assign(count, 0);
+	m_vecSumY.assign(count, 0);
+
+	for (const auto& band : m_vecBands) {
+		const int* labelPtr = m_vecLabel.data() + band.offset;
+		for (const auto& run : band.runs) {
+			const int label = *labelPtr++;
+			const int len = run.x1 - run.x0;
+			components.left[label] = std::min(components.left[label], run.x0);
+			components.width[label] = std::max(components.width[label], run.x1 - 1);
+			components.top[label] = std::min(components.top[label], run.y);
+			components.height[label] = std::max(components.height[label], run.y);
+			components.area[label] += len;
+			m_vecSumX[label] += static_cast<int64_t>(run.x0 + run.x1 - 1) * len;
+			m_vecSumY[label] += static_cast<int64_t>(run.y) * len;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const float area = static_cast<float>(components.area[i]);
+		components.width[i] = components.width[i] - components.left[i] + 1;
+		components.height[i] = components.height[i] - components.top[i] + 1;
+		components.cx[i] = static_cast<float>(m_vecSumX[i]) / (2.0f * area);
+		components.cy[i] = static_cast<float>(m_vecSumY[i]) / area;
+		components.fill[i] = area / static_cast<float>(components.width[i] * components.height[i]);
+	}
+	return true;
+}
+
+/**
+ *	@brief	擷取單一列帶內的前景線段，並與上一列相鄰線段合併 (8-連通)
+ *	@param[in]		imgBinary	cv::Mat 物件參考，二值化影像。
+ *	@param[in,out]	band		Band 結構參考，指定列帶範圍並存放擷取結果。
+ *	@return	此函數沒有返回值
+ */
+void CarLabeling::LabelBand(const cv::Mat& imgBinary, Band& band)
+{
+	const int cols = imgBinary.cols;
+	int prevBegin = 0;
+	int prevEnd = 0;
+
+	band.runs.clear();
+	band.parent.clear();
+	band.firstRowEnd = 0;
+	band.lastRowBegin = 0;
+
+	for (int y = band.rowBegin; y < band.rowEnd; y++) {
+		const uint8_t* rowPtr = imgBinary.ptr<uint8_t>(y);
+		const int curBegin = static_cast<int>(band.runs.size());
+		int x = 0;
+
+		while (x < cols) {
+			// 以 8 bytes 為單位略過背景
+			for (uint64_t word; x + 8 <= cols; x += 8) {
+				::memcpy(&word, rowPtr + x, sizeof(word));
+				if (word != 0) break;
+			}
+			while (x < cols && rowPtr[x] == 0) x++;
+			if (x >= cols) break;
+
+			const int x0 = x;
+			while (x < cols && rowPtr[x] != 0) x++;
+			band.parent.push_back(static_cast<int>(band.runs.size()));
+			band.runs.push_back({ y, x0, x });
+		}
+
+		// 與上一列線段合併，兩列線段皆依 x 遞增排列
+		const int curEnd = static_cast<int>(band.runs.size());
+		int p = prevBegin;
+		for (int c = curBegin; c < curEnd; c++) {
+			const Run& cur = band.runs[c];
+			while (p < prevEnd && band.runs[p].x1 < cur.x0) p++;
+			for (int q = p; q < prevEnd && band.runs[q].x0 <= cur.x1; q++) {
+				CarLabeling::Union(band.parent, q, c);
+			}
+		}
+
+		if (y == band.rowBegin) band.firstRowEnd = curEnd;
+		band.lastRowBegin = curBegin;
+		prevBegin = curBegin;
+		prevEnd = curEnd;
+	}
+}
+
+/**
+ *	@brief	合併相鄰兩列帶接縫處的線段
+ *	@param[in]	upper	上方列帶
+ *	@param[in]	lower	下方列帶
+ *	@return	此函數沒有返回值
+ */
+void CarLabeling::MergeSeam(const Band& upper, const Band& lower)
+{
+	const int upperEnd = static_cast<int>(upper.runs.size());
+	int p = upper.lastRowBegin;
+
+	// 上方列帶最後一列必須緊鄰下方列帶第一列
+	if (upper.rowEnd != lower.rowBegin || upper.rowEnd <= upper.rowBegin) {
+		return;
+	}
+
+	for (int c = 0; c < lower.firstRowEnd; c++) {
+		const Run& cur = lower.runs[c];
+		while (p < upperEnd && upper.runs[p].x1 < cur.x0) p++;
+		for (int q = p; q < upperEnd && upper.runs[q].x0 <= cur.x1; q++) {
+			this->Union(upper.offset + q, lower.offset + c);
+		}
+	}
+}
+
+/**
+ *	@brief	取得全域 union-find 根節點
+ *	@param[in]	index	線段全域索引
+ *	@return	<b>型別: int</b> \n 根節點索引
+ */
+int CarLabeling::FindRoot(int index)
+{
+	return CarLabeling::FindRoot(m_vecParent, index);
+}
+
+/**
+ *	@brief	合併全域 union-find 兩集合
+ *	@param[in]	a	線段全域索引
+ *	@param[in]	b	線段全域索引
+ *	@return	此函數沒有返回值
+ */
+void CarLabeling::Union(int a, int b)
+{
+	CarLabeling::Union(m_vecParent, a, b);
+}
+
+/**
+ *	@brief	取得 union-find 根節點 (路徑減半)
+ *	@param[in,out]	parent	父節點陣列
+ *	@param[in]		index	節點索引
+ *	@return	<b>型別: int</b> \n 根節點索引
+ */
+int CarLabeling::FindRoot(std::vector<int>& parent, int index)
+{
+	while (parent[index] != index) {
+		parent[index] = parent[parent[index]];
+		index = parent[index];
+	}
+	return index;
+}
+
+/**
+ *	@brief	合併 union-find 兩集合，以較小索引作為根節點
+ *	@param[in,out]	parent	父節點陣列
+ *	@param[in]		a		節點索引
+ *	@param[in]		b		節點索引
+ *	@return	此函數沒有返回值
+ */
+void CarLabeling::Union(std::vector<int>& parent, int a, int b)
+{
+	a = CarLabeling::FindRoot(parent, a);
+	b = CarLabeling::FindRoot(parent, b);
+	if (a < b) parent[b] = a;
+	else if (b < a) parent[a] = b;
+}
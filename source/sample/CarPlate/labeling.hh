@@ -0,0 +1,94 @@
+﻿/**************************************************************************//**
+ * @file	labeling.hh
+ * @brief	CarLabeling 連通元件標記類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_LABELING_HH
+#define	ODMC_CARPLATE_LABELING_HH
+#include "carcore.hh"
+
+/**
+ *	@struct	CarComponents
+ *	@brief	連通元件統計資料 (SoA 排列，每個欄位為一個連續陣列，索引即元件編號)
+ */
+struct CarComponents {
+	std::vector<int>	left;		//!< 外接矩形左邊界 (pixel)
+	std::vector<int>	top;		//!< 外接矩形上邊界 (pixel)
+	std::vector<int>	width;		//!< 外接矩形寬度 (pixel)
+	std::vector<int>	height;		//!< 外接矩形高度 (pixel)
+	std::vector<int>	area;		//!< 元件面積 (前景 pixel 數量)
+	std::vector<float>	cx;			//!< 重心座標 X
+	std::vector<float>	cy;			//!< 重心座標 Y
+	std::vector<float>	fill;		//!< 填充率 = 面積 / 外接矩形面積
+
+	void Resize(size_t count);
+	size_t Count() const { return area.size(); }
+	cv::Rect Rect(size_t i) const { return cv::Rect(left[i], top[i], width[i], height[i]); }
+};
+
+/**
+ *	@class	CarLabeling
+ *	@brief	二值化影像連通元件標記 (8-連通)
+ *	@remark	影像依列切割為數個列帶 (row band)，每個列帶平行擷取水平前景線段 (run) 並以 union-find 合併，
+ *			最後再合併列帶接縫並統計每個元件資訊。只輸出統計值，不保存元件輪廓。
+ *			列帶數量即平行處理的 thread 數量 (SetThreads)，1 = 於呼叫端 thread 依序處理。
+ *			所有暫存緩衝區皆為成員變數，解析度不變時重複使用，不會每幀重新配置。
+ */
+class CarLabeling
+{
+public:
+	CarLabeling();
+	virtual ~CarLabeling();
+
+	bool Labeling(const cv::Mat& imgBinary, CarComponents& components);
+
+	void SetThreads(int threads) { m_nThreads = std::max(threads, 0); }
+	int GetThreads() const { return m_nThreads; }
+
+private:
+	CarLabeling(const CarLabeling&) = delete;				//!< Disable copy construction
+	CarLabeling& operator=(const CarLabeling&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Run
+	 *	@brief	水平前景線段
+	 */
+	struct Run {
+		int	y;		//!< 所在列
+		int	x0;		//!< 起始行 (包含)
+		int	x1;		//!< 結束行 (不包含)
+	};
+
+	/**
+	 *	@struct	Band
+	 *	@brief	列帶處理暫存資料
+	 */
+	struct Band {
+		int	rowBegin;				//!< 起始列 (包含)
+		int	rowEnd;					//!< 結束列 (不包含)
+		int	firstRowEnd;			//!< 第一列線段結束索引 (不包含)
+		int	lastRowBegin;			//!< 最後一列線段起始索引
+		int	offset;					//!< 線段於全域陣列的起始索引
+		std::vector<Run> runs;		//!< 列帶內所有線段
+		std::vector<int> parent;	//!< 列帶內 union-find 父節點 (區域索引)
+	};
+
+	void LabelBand(const cv::Mat& imgBinary, Band& band);
+	void MergeSeam(const Band& upper, const Band& lower);
+	int  FindRoot(int index);
+	void Union(int a, int b);
+
+	static int FindRoot(std::vector<int>& parent, int index);
+	static void Union(std::vector<int>& parent, int a, int b);
+
+	int					m_nThreads;		//!< 列帶平行處理 thread 數量上限，0 = 所有核心
+	std::vector<Band>	m_vecBands;		//!< 列帶暫存資料
+	std::vector<int>	m_vecParent;	//!< 全域 union-find 父節點
+	std::vector<int>	m_vecLabel;		//!< 每個線段對應的元件編號
+	std::vector<int64_t> m_vecSumX;		//!< 元件 X 座標總和 (兩倍值，避免浮點累加)
+	std::vector<int64_t> m_vecSumY;		//!< 元件 Y 座標總和
+};
+
+#endif // !ODMC_CARPLATE_LABELING_HH
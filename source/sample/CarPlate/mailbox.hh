@@ -0,0 +1,176 @@
+﻿/**************************************************************************//**
+ * @file	mailbox.hh
+ * @brief	CarMailbox 最新項目信箱 (triple buffer) 樣板 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_MAILBOX_HH
+#define	ODMC_CARPLATE_MAILBOX_HH
+#include "carcore.hh"
+
+/**
+ *	@class	CarMailbox
+ *	@brief	單一生產者/單一消費者最新項目信箱
+ *	@remark	以三個槽位實作 triple buffer: 生產者持有 back、消費者持有 front，中間槽位索引與「有新項目」旗標
+ *			存放於同一個 atomic 變數，雙方以 exchange 交換槽位，不需要鎖。生產者永遠覆寫最新項目，
+ *			消費者永遠取得最新項目，未被取出即被覆寫的項目計入 overwritten。
+ *			放入與取出皆以 swap 交換內容，換回的物件可作為可重複使用的緩衝區。
+ */
+template <typename T>
+class CarMailbox
+{
+public:
+	CarMailbox();
+	virtual ~CarMailbox() {}
+
+	bool Push(T& item);
+	bool Pop(T& item, int timeoutMs = -1);
+	void Close();
+
+	bool HasNew() const { return (m_nMiddle.load(std::memory_order_acquire) & NewFlag) != 0; }
+	bool IsClosed() const { return m_isClosed.load(std::memory_order_acquire); }
+	uint64_t GetProduced() const { return m_nProduced.load(std::memory_order_relaxed); }
+	uint64_t GetConsumed() const { return m_nConsumed.load(std::memory_order_relaxed); }
+	uint64_t GetOverwritten() const { return m_nOverwritten.load(std::memory_order_relaxed); }
+
+private:
+	CarMailbox(const CarMailbox&) = delete;				//!< Disable copy construction
+	CarMailbox& operator=(const CarMailbox&) = delete;	//!< Disable assignment operator
+
+	enum {
+		SlotMask = 0x03,			//!< 槽位索引遮罩
+		NewFlag = 0x04,				//!< 中間槽位為尚未取出的新項目
+	};
+
+	void WakeConsumer();
+
+	T						m_slots[3];				//!< 槽位
+	int						m_nBack;				//!< 生產者持有的槽位 (只有生產者存取)
+	char					m_padBack[64];			//!< 分隔 cache line，避免 false sharing
+	int						m_nFront;				//!< 消費者持有的槽位 (只有消費者存取)
+	char					m_padFront[64];			//!< 分隔 cache line，避免 false sharing
+	std::atomic<int>		m_nMiddle;				//!< 中間槽位索引 | NewFlag
+	char					m_padMiddle[64];		//!< 分隔 cache line，避免 false sharing
+
+	std::atomic<bool>		m_isClosed;				//!< 信箱是否已關閉
+	std::atomic<bool>		m_isConsumerWaiting;	//!< 消費者是否休眠中
+	std::atomic<uint64_t>	m_nProduced;			//!< 放入項目數量
+	std::atomic<uint64_t>	m_nConsumed;			//!< 取出項目數量
+	std::atomic<uint64_t>	m_nOverwritten;			//!< 未取出即被覆寫的項目數量
+	std::mutex				m_mutex;				//!< 休眠等待用 mutex
+	std::condition_variable	m_cvNotEmpty;			//!< 新項目通知
+};
+
+/**
+ *	@brief	CarMailbox 建構式
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+CarMailbox<T>::CarMailbox()
+	: m_nBack(2)
+	, m_nFront(0)
+	, m_nMiddle(1)
+	, m_isClosed(false)
+	, m_isConsumerWaiting(false)
+	, m_nProduced(0)
+	, m_nConsumed(0)
+	, m_nOverwritten(0) {
+}
+
+/**
+ *	@brief	放入最新項目 (只能由生產者呼叫)，尚未取出的舊項目會被覆寫。
+ *	@param[in,out]	item	要放入的項目，返回時換成槽位原本的內容 (被覆寫或已取出的舊項目)。
+ *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若信箱已關閉返回值為零 (false)。
+ */
+template <typename T>
+bool CarMailbox<T>::Push(T& item)
+{
+	if (m_isClosed.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	using std::swap;
+	swap(m_slots[m_nBack], item);
+
+	const int prev = m_nMiddle.exchange(m_nBack | NewFlag, std::memory_order_acq_rel);
+	m_nBack = prev & SlotMask;
+	m_nProduced.fetch_add(1, std::memory_order_relaxed);
+	if ((prev & NewFlag) != 0) {
+		m_nOverwritten.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	this->WakeConsumer();
+	return true;
+}
+
+/**
+ *	@brief	取出最新項目 (只能由消費者呼叫)
+ *	@param[in,out]	item		存放取出的項目，原本的內容換入槽位供生產者重複使用。
+ *	@param[in]		timeoutMs	沒有新項目時最長等待時間 (ms)，0 = 不等待，負值 = 持續等待至有新項目或信箱關閉。
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或信箱已關閉返回值為零 (false)。
+ */
+template <typename T>
+bool CarMailbox<T>::Pop(T& item, int timeoutMs)
+{
+	auto isReady = [this]() {
+		return this->HasNew() || m_isClosed.load(std::memory_order_acquire);
+	};
+
+	if (!this->HasNew()) {
+		if (timeoutMs == 0 || m_isClosed.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_isConsumerWaiting.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (timeoutMs < 0) {
+			m_cvNotEmpty.wait(lock, isReady);
+		}
+		else {
+			m_cvNotEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs), isReady);
+		}
+		m_isConsumerWaiting.store(false);
+
+		if (!this->HasNew()) {
+			return false;
+		}
+	}
+
+	const int prev = m_nMiddle.exchange(m_nFront, std::memory_order_acq_rel);
+	m_nFront = prev & SlotMask;
+
+	using std::swap;
+	swap(m_slots[m_nFront], item);
+	m_nConsumed.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+/**
+ *	@brief	關閉信箱，喚醒等待中的消費者
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+void CarMailbox<T>::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_isClosed.store(true, std::memory_order_release);
+	m_cvNotEmpty.notify_all();
+}
+
+/**
+ *	@brief	若消費者休眠中則喚醒
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+void CarMailbox<T>::WakeConsumer()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_isConsumerWaiting.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cvNotEmpty.notify_one();
+	}
+}
+
+#endif // !ODMC_CARPLATE_MAILBOX_HH
@@ -0,0 +1,130 @@
+﻿/**************************************************************************//**
+ * @file	mapfile.cc
+ * @brief	CarMappedFile 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "mapfile.hh"
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#	define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+/**
+ *	@brief	CarMappedFile 建構式
+ *	@return	此函數沒有返回值
+ */
+CarMappedFile::CarMappedFile()
+	: m_dataPtr(nullptr)
+	, m_nSize(0)
+#if defined(_WIN32)
+	, m_hFile(nullptr)
+	, m_hMapping(nullptr) {
+#else
+	, m_nFile(-1) {
+#endif
+}
+
+/**
+ *	@brief	CarMappedFile 解構式
+ *	@return	此函數沒有返回值
+ */
+CarMappedFile::~CarMappedFile() { this->Close(); }
+
+/**
+ *	@brief	開啟並映射檔案 (唯讀)
+ *	@param[in]	pathPtr	(指標) 檔案路徑
+ *	@return	<b>型別: bool</b> \n 若映射成功返回值為非零值 (true)。 \n 若檔案不存在、為空檔案或映射失敗返回值為零 (false)。
+ */
+bool CarMappedFile::Open(const char* pathPtr)
+{
+	this->Close();
+	if (pathPtr == nullptr) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	for (;;) {
+		LARGE_INTEGER size;
+
+		HANDLE hFile = ::CreateFileA(pathPtr, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) break;
+		m_hFile = hFile;
+
+		if (!::GetFileSizeEx(hFile, &size) || size.QuadPart <= 0) break;
+
+		HANDLE hMapping = ::CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (hMapping == nullptr) break;
+		m_hMapping = hMapping;
+
+		auto dataPtr = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (dataPtr == nullptr) break;
+
+		m_dataPtr = reinterpret_cast<const uint8_t*>(dataPtr);
+		m_nSize = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+#else
+	for (;;) {
+		struct stat st;
+
+		m_nFile = ::open(pathPtr, O_RDONLY);
+		if (m_nFile < 0) break;
+
+		if (::fstat(m_nFile, &st) != 0 || st.st_size <= 0) break;
+
+		auto dataPtr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, m_nFile, 0);
+		if (dataPtr == MAP_FAILED) break;
+
+		m_dataPtr = reinterpret_cast<const uint8_t*>(dataPtr);
+		m_nSize = static_cast<size_t>(st.st_size);
+		return true;
+	}
+#endif
+
+	this->Close();
+	return false;
+}
+
+/**
+ *	@brief	解除映射並關閉檔案
+ *	@return	此函數沒有返回值
+ */
+void CarMappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_dataPtr != nullptr) {
+		::UnmapViewOfFile(m_dataPtr);
+	}
+
+	if (m_hMapping != nullptr) {
+		::CloseHandle(reinterpret_cast<HANDLE>(m_hMapping));
+	}
+
+	if (m_hFile != nullptr && m_hFile != INVALID_HANDLE_VALUE) {
+		::CloseHandle(reinterpret_cast<HANDLE>(m_hFile));
+	}
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+#else
+	if (m_dataPtr != nullptr) {
+		::munmap(const_cast<uint8_t*>(m_dataPtr), m_nSize);
+	}
+
+	if (m_nFile >= 0) {
+		::close(m_nFile);
+	}
+	m_nFile = -1;
+#endif
+	m_dataPtr = nullptr;
+	m_nSize = 0;
+}
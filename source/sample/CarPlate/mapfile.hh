@@ -0,0 +1,43 @@
+﻿/**************************************************************************//**
+ * @file	mapfile.hh
+ * @brief	CarMappedFile 唯讀記憶體映射檔案類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_MAPFILE_HH
+#define	ODMC_CARPLATE_MAPFILE_HH
+#include "carcore.hh"
+
+/**
+ *	@class	CarMappedFile
+ *	@brief	唯讀記憶體映射檔案 (Windows: MapViewOfFile, POSIX: mmap)
+ *	@remark	開啟檔案只建立映射，不讀取內容，資料於第一次存取時由作業系統分頁載入。
+ */
+class CarMappedFile
+{
+public:
+	CarMappedFile();
+	virtual ~CarMappedFile();
+
+	bool Open(const char* pathPtr);
+	void Close();
+	bool IsOpened() const { return m_dataPtr != nullptr; }
+	const uint8_t* GetData() const { return m_dataPtr; }
+	size_t GetSize() const { return m_nSize; }
+
+private:
+	CarMappedFile(const CarMappedFile&) = delete;				//!< Disable copy construction
+	CarMappedFile& operator=(const CarMappedFile&) = delete;	//!< Disable assignment operator
+
+	const uint8_t*	m_dataPtr;		//!< 映射起始位址
+	size_t			m_nSize;		//!< 檔案大小 (bytes)
+#if defined(_WIN32)
+	void*			m_hFile;		//!< 檔案 handle
+	void*			m_hMapping;		//!< 映射物件 handle
+#else
+	int				m_nFile;		//!< 檔案描述子
+#endif
+};
+
+#endif // !ODMC_CARPLATE_MAPFILE_HH
@@ -0,0 +1,570 @@
+﻿/**************************************************************************//**
+ * @file	metrics.cc
+ * @brief	CarLatencyHistogram、CarStreamMetrics 與 CarMetricsRegistry 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include "metrics.hh"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ *	@brief	取得最高位元位置 (value 必須大於 0)
+ *	@param[in]	value	數值
+ *	@return	<b>型別: int</b> \n 最高位元位置 (0 ~ 63)
+ */
+static inline int HighestBit(uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return static_cast<int>(index);
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+/**
+ *	@brief	CarLatencyHistogram 建構式
+ *	@return	此函數沒有返回值
+ */
+CarLatencyHistogram::CarLatencyHistogram()
+{
+	this->Reset();
+}
+
+/**
+ *	@brief	取得數值所屬區間: 小於 2^(SUB_BITS+1) 時每個數值一格，其後每個 2 的冪次區間等分為 2^SUB_BITS 格。
+ *	@param[in]	value	數值
+ *	@return	<b>型別: size_t</b> \n 區間索引
+ */
+size_t CarLatencyHistogram::GetIndex(uint64_t value)
+{
+	const uint64_t subCount = 1ull << CAR_HISTOGRAM_SUB_BITS;
+	if (value < (subCount << 1)) {
+		return static_cast<size_t>(value);
+	}
+
+	const int shift = HighestBit(value) - CAR_HISTOGRAM_SUB_BITS;
+	return static_cast<size_t>((static_cast<uint64_t>(shift + 1) << CAR_HISTOGRAM_SUB_BITS) + ((value >> shift) - subCount));
+}
+
+/**
+ *	@brief	取得區間內的最大數值
+ *	@param[in]	index	區間索引
+ *	@return	<b>型別: uint64_t</b> \n 區間內的最大數值
+ */
+uint64_t CarLatencyHistogram::GetUpperValue(size_t index)
+{
+	const uint64_t subCount = 1ull << CAR_HISTOGRAM_SUB_BITS;
+	if (index < (subCount << 1)) {
+		return static_cast<uint64_t>(index);
+	}
+
+	const int shift = static_cast<int>(index >> CAR_HISTOGRAM_SUB_BITS) - 1;
+	const uint64_t lower = ((index & (subCount - 1)) + subCount) << shift;
+	return lower + (1ull << shift) - 1;
+}
+
+/**
+ *	@brief	記錄一個數值 (超過可記錄範圍時以最大值記錄)
+ *	@param[in]	value	數值 (微秒)
+ *	@return	此函數沒有返回值
+ */
+void CarLatencyHistogram::Record(uint64_t value)
+{
+	const uint64_t maxValue = (1ull << CAR_HISTOGRAM_MAX_BITS) - 1;
+	value = std::min(value, maxValue);
+
+	m_nBuckets[CarLatencyHistogram::GetIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_nCount.fetch_add(1, std::memory_order_relaxed);
+	m_nSum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t current = m_nMin.load(std::memory_order_relaxed);
+	while (value < current && !m_nMin.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+
+	current = m_nMax.load(std::memory_order_relaxed);
+	while (value > current && !m_nMax.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+/**
+ *	@brief	取得直方圖快照 (百分位數以區間最大值表示，不超過記錄的最大值)
+ *	@param[out]	snapshot	存放快照
+ *	@return	此函數沒有返回值
+ */
+void CarLatencyHistogram::GetSnapshot(CarHistogramSnapshot& snapshot) const
+{
+	static const double percents[] = { 0.50, 0.90, 0.99, 0.999 };
+	uint64_t* const values[] = { &snapshot.p50, &snapshot.p90, &snapshot.p99, &snapshot.p999 };
+
+	::memset(&snapshot, 0, sizeof(CarHistogramSnapshot));
+
+	// 以各區間總和作為次數，避免與記錄同時進行時百分位數超出範圍
+	uint64_t count = 0;
+	for (const auto& bucket : m_nBuckets) {
+		count += bucket.load(std::memory_order_relaxed);
+	}
+	if (count == 0) {
+		return;
+	}
+
+	snapshot.count = count;
+	snapshot.mean = static_cast<double>(m_nSum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+	snapshot.min = m_nMin.load(std::memory_order_relaxed);
+	snapshot.max = m_nMax.load(std::memory_order_relaxed);
+
+	size_t level = 0;
+	uint64_t total = 0;
+	for (size_t i = 0; i < CAR_HISTOGRAM_BUCKETS && level < 4; i++) {
+		total += m_nBuckets[i].load(std::memory_order_relaxed);
+		while (level < 4 && static_cast<double>(total) >= percents[level] * static_cast<double>(count)) {
+			*values[level] = std::min(CarLatencyHistogram::GetUpperValue(i), snapshot.max);
+			level++;
+		}
+	}
+}
+
+/**
+ *	@brief	清除所有記錄
+ *	@return	此函數沒有返回值
+ */
+void CarLatencyHistogram::Reset()
+{
+	for (auto& bucket : m_nBuckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_nCount.store(0, std::memory_order_relaxed);
+	m_nSum.store(0, std::memory_order_relaxed);
+	m_nMin.store(UINT64_MAX, std::memory_order_relaxed);
+	m_nMax.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *	@brief	CarStreamMetrics 建構式
+ *	@param[in]	name	串流名稱
+ *	@return	此函數沒有返回值
+ */
+CarStreamMetrics::CarStreamMetrics(const std::string& name)
+	: m_nCaptured(0)
+	, m_nProcessed(0)
+	, m_nSkipped(0)
+	, m_nIdle(0)
+	, m_nTracked(0)
+	, m_nReconnects(0)
+	, m_nStalls(0)
+	, m_nScratch(0)
+	, m_nQueueMax(0)
+	, m_strName(name)
+	, m_channelPtr(nullptr)
+	, m_poolPtr(nullptr)
+	, m_nDroppedBase(0)
+	, m_nAllocBase(0) {
+}
+
+/**
+ *	@brief	CarStreamMetrics 解構式
+ *	@return	此函數沒有返回值
+ */
+CarStreamMetrics::~CarStreamMetrics() {}
+
+/**
+ *	@brief	記錄階段處理時間
+ *	@param[in]	stage	計時階段
+ *	@param[in]	elapsed	經過時間
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::Record(MetricStage stage, std::chrono::steady_clock::duration elapsed)
+{
+	const auto index = static_cast<int>(stage);
+	if (index < 0 || index >= CAR_METRIC_STAGES) {
+		return;
+	}
+
+	const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	m_cStages[index].Record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+}
+
+/**
+ *	@brief	記錄目前待處理幀數 (由偵測端取幀時呼叫)，保留最大值。
+ *	@param[in]	depth	待處理幀數
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::SampleQueue(size_t depth)
+{
+	size_t current = m_nQueueMax.load(std::memory_order_relaxed);
+	while (depth > current && !m_nQueueMax.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {}
+}
+
+/**
+ *	@brief	設定串流名稱
+ *	@param[in]	name	串流名稱
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::SetName(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_strName = name;
+}
+
+/**
+ *	@brief	設定快照時讀取佇列深度、丟幀與配置次數的來源，來源銷毀前必須設為 nullptr。
+ *			更換來源時保留原來源的丟幀與配置次數，快照為所有來源的累計值。
+ *	@param[in]	channelPtr	(指標) 傳輸通道，可為 nullptr。
+ *	@param[in]	poolPtr		(指標) 影像緩衝池，可為 nullptr。
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::SetSources(const CarFrameChannel* channelPtr, const CarFramePool* poolPtr)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_channelPtr != nullptr && m_channelPtr != channelPtr) {
+		CarChannelStats stats;
+		m_channelPtr->GetStats(stats);
+		m_nDroppedBase += stats.dropped;
+	}
+	if (m_poolPtr != nullptr && m_poolPtr != poolPtr) {
+		m_nAllocBase += m_poolPtr->GetAllocations();
+	}
+
+	m_channelPtr = channelPtr;
+	m_poolPtr = poolPtr;
+}
+
+/**
+ *	@brief	取得統計資料快照
+ *	@param[out]	snapshot	存放快照
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::GetSnapshot(CarMetricsSnapshot& snapshot)
+{
+	snapshot.captured = m_nCaptured.load(std::memory_order_relaxed);
+	snapshot.processed = m_nProcessed.load(std::memory_order_relaxed);
+	snapshot.skipped = m_nSkipped.load(std::memory_order_relaxed);
+	snapshot.idle = m_nIdle.load(std::memory_order_relaxed);
+	snapshot.tracked = m_nTracked.load(std::memory_order_relaxed);
+	snapshot.reconnects = m_nReconnects.load(std::memory_order_relaxed);
+	snapshot.stalls = m_nStalls.load(std::memory_order_relaxed);
+	snapshot.scratch = m_nScratch.load(std::memory_order_relaxed);
+	snapshot.queueDepth = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		snapshot.name = m_strName;
+		snapshot.dropped = m_nDroppedBase;
+		snapshot.allocations = m_nAllocBase;
+
+		if (m_channelPtr != nullptr) {
+			CarChannelStats stats;
+			m_channelPtr->GetStats(stats);
+			snapshot.dropped += stats.dropped;
+			snapshot.queueDepth = stats.pending;
+			this->SampleQueue(stats.pending);
+		}
+
+		if (m_poolPtr != nullptr) {
+			snapshot.allocations += m_poolPtr->GetAllocations();
+		}
+	}
+	snapshot.queueMax = m_nQueueMax.load(std::memory_order_relaxed);
+
+	for (int i = 0; i < CAR_METRIC_STAGES; i++) {
+		m_cStages[i].GetSnapshot(snapshot.stages[i]);
+	}
+}
+
+/**
+ *	@brief	清除所有計時與計數 (統計來源的累計值不受影響)
+ *	@return	此函數沒有返回值
+ */
+void CarStreamMetrics::Reset()
+{
+	for (auto& stage : m_cStages) {
+		stage.Reset();
+	}
+	m_nCaptured.store(0, std::memory_order_relaxed);
+	m_nProcessed.store(0, std::memory_order_relaxed);
+	m_nSkipped.store(0, std::memory_order_relaxed);
+	m_nIdle.store(0, std::memory_order_relaxed);
+	m_nTracked.store(0, std::memory_order_relaxed);
+	m_nReconnects.store(0, std::memory_order_relaxed);
+	m_nStalls.store(0, std::memory_order_relaxed);
+	m_nScratch.store(0, std::memory_order_relaxed);
+	m_nQueueMax.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *	@brief	取得計時階段名稱
+ *	@param[in]	stage	計時階段
+ *	@return	<b>型別: const char*</b> \n 階段名稱
+ */
+const char* CarStreamMetrics::GetStageName(MetricStage stage)
+{
+	static const char* const names[CAR_METRIC_STAGES] = {
+		"capture", "decode", "motion", "gray", "contrast", "blur", "threshold",
+		"tiled", "contours", "candidates", "recognize", "overlay", "reorder", "present",
+	};
+
+	const auto index = static_cast<int>(stage);
+	return (index >= 0 && index < CAR_METRIC_STAGES) ? names[index] : "unknown";
+}
+
+/**
+ *	@brief	CarMetricsRegistry 建構式
+ *	@return	此函數沒有返回值
+ */
+CarMetricsRegistry::CarMetricsRegistry()
+	: m_cProcDump(nullptr)
+	, m_isDumping(false)
+	, m_outputPtr(nullptr)
+	, m_nInterval(0)
+	, m_eFormat(MetricsFormat::Text) {
+}
+
+/**
+ *	@brief	CarMetricsRegistry 解構式
+ *	@return	此函數沒有返回值
+ */
+CarMetricsRegistry::~CarMetricsRegistry()
+{
+	this->StopDump();
+}
+
+/**
+ *	@brief	登錄統計物件 (統計物件銷毀前必須取消登錄)
+ *	@param[in]	metricsPtr	(指標) 統計物件
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::Register(CarStreamMetrics* metricsPtr)
+{
+	if (metricsPtr == nullptr) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (std::find(m_vecMetrics.begin(), m_vecMetrics.end(), metricsPtr) == m_vecMetrics.end()) {
+		m_vecMetrics.push_back(metricsPtr);
+	}
+}
+
+/**
+ *	@brief	取消登錄統計物件
+ *	@param[in]	metricsPtr	(指標) 統計物件
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::Unregister(CarStreamMetrics* metricsPtr)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_vecMetrics.erase(std::remove(m_vecMetrics.begin(), m_vecMetrics.end(), metricsPtr), m_vecMetrics.end());
+}
+
+/**
+ *	@brief	取得所有已登錄串流的統計資料快照
+ *	@param[out]	snapshots	存放快照 (依登錄順序)
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::GetSnapshots(std::vector<CarMetricsSnapshot>& snapshots)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	snapshots.resize(m_vecMetrics.size());
+	for (size_t i = 0; i < m_vecMetrics.size(); i++) {
+		m_vecMetrics[i]->GetSnapshot(snapshots[i]);
+	}
+}
+
+/**
+ *	@brief	輸出目前統計資料
+ *	@param[out]	output	輸出目標
+ *	@param[in]	format	輸出格式
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::Dump(std::ostream& output, MetricsFormat format)
+{
+	std::vector<CarMetricsSnapshot> snapshots;
+	this->GetSnapshots(snapshots);
+
+	if (format == MetricsFormat::Json) {
+		CarMetricsRegistry::WriteJson(output, snapshots);
+	}
+	else CarMetricsRegistry::WriteText(output, snapshots);
+	output.flush();
+}
+
+/**
+ *	@brief	開始定期輸出統計資料
+ *	@param[out]	output		輸出目標 (停止前必須保持有效)
+ *	@param[in]	intervalMs	輸出間隔 (ms)
+ *	@param[in]	format		輸出格式
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若啟動失敗返回值為零 (false)。
+ */
+bool CarMetricsRegistry::StartDump(std::ostream& output, int intervalMs, MetricsFormat format)
+{
+	this->StopDump();
+	if (intervalMs <= 0) {
+		return false;
+	}
+
+	m_outputPtr = &output;
+	m_nInterval = intervalMs;
+	m_eFormat = format;
+	m_isDumping = true;
+
+	m_cProcDump = new (std::nothrow) std::thread(&CarMetricsRegistry::DumpProcess, this);
+	if (m_cProcDump == nullptr) {
+		m_isDumping = false;
+		return false;
+	}
+	return true;
+}
+
+/**
+ *	@brief	停止定期輸出統計資料
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::StopDump()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutexDump);
+		m_isDumping = false;
+		m_cvDump.notify_all();
+	}
+
+	if (m_cProcDump != nullptr) {
+		if (m_cProcDump->joinable()) {
+			m_cProcDump->join();
+		}
+		SAFE_DELETE(m_cProcDump);
+	}
+	m_outputPtr = nullptr;
+}
+
+/**
+ *	@brief	定期輸出 thread process
+ *	@param[in]	cThisPtr	(指標) CarMetricsRegistry 物件
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::DumpProcess(CarMetricsRegistry* cThisPtr)
+{
+	const auto interval = std::chrono::milliseconds(cThisPtr->m_nInterval);
+
+	std::unique_lock<std::mutex> lock(cThisPtr->m_mutexDump);
+	while (cThisPtr->m_isDumping) {
+		if (cThisPtr->m_cvDump.wait_for(lock, interval, [cThisPtr]() { return !cThisPtr->m_isDumping; })) {
+			break;
+		}
+
+		lock.unlock();
+		cThisPtr->Dump(*cThisPtr->m_outputPtr, cThisPtr->m_eFormat);
+		lock.lock();
+	}
+}
+
+/**
+ *	@brief	以純文字輸出統計資料，每路串流一個區塊，沒有記錄的階段不輸出。
+ *	@param[out]	output		輸出目標
+ *	@param[in]	snapshots	統計資料快照
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::WriteText(std::ostream& output, const std::vector<CarMetricsSnapshot>& snapshots)
+{
+	char buffer[384];
+
+	for (const auto& snapshot : snapshots) {
+		::snprintf(buffer, sizeof(buffer),
+			"[%s] captured=%llu processed=%llu skipped=%llu idle=%llu tracked=%llu reconnects=%llu stalls=%llu dropped=%llu queue=%zu (max %zu) allocations=%llu scratch=%llu\n",
+			snapshot.name.c_str(),
+			static_cast<unsigned long long>(snapshot.captured),
+			static_cast<unsigned long long>(snapshot.processed),
+			static_cast<unsigned long long>(snapshot.skipped),
+			static_cast<unsigned long long>(snapshot.idle),
+			static_cast<unsigned long long>(snapshot.tracked),
+			static_cast<unsigned long long>(snapshot.reconnects),
+			static_cast<unsigned long long>(snapshot.stalls),
+			static_cast<unsigned long long>(snapshot.dropped),
+			snapshot.queueDepth, snapshot.queueMax,
+			static_cast<unsigned long long>(snapshot.allocations),
+			static_cast<unsigned long long>(snapshot.scratch));
+		output << buffer;
+
+		for (int i = 0; i < CAR_METRIC_STAGES; i++) {
+			const auto& stage = snapshot.stages[i];
+			if (stage.count == 0) continue;
+
+			::snprintf(buffer, sizeof(buffer),
+				"  %-10s n=%-8llu mean=%9.1fus p50=%7lluus p90=%7lluus p99=%7lluus p99.9=%7lluus max=%7lluus\n",
+				CarStreamMetrics::GetStageName(static_cast<MetricStage>(i)),
+				static_cast<unsigned long long>(stage.count), stage.mean,
+				static_cast<unsigned long long>(stage.p50),
+				static_cast<unsigned long long>(stage.p90),
+				static_cast<unsigned long long>(stage.p99),
+				static_cast<unsigned long long>(stage.p999),
+				static_cast<unsigned long long>(stage.max));
+			output << buffer;
+		}
+	}
+}
+
+/**
+ *	@brief	以 JSON 輸出統計資料 (一行一個物件，時間單位為微秒)
+ *	@param[out]	output		輸出目標
+ *	@param[in]	snapshots	統計資料快照
+ *	@return	此函數沒有返回值
+ */
+void CarMetricsRegistry::WriteJson(std::ostream& output, const std::vector<CarMetricsSnapshot>& snapshots)
+{
+	char buffer[384];
+	const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	::snprintf(buffer, sizeof(buffer), "{\"time_ms\":%lld,\"streams\":[", static_cast<long long>(now));
+	output << buffer;
+
+	for (size_t n = 0; n < snapshots.size(); n++) {
+		const auto& snapshot = snapshots[n];
+
+		// 名稱只跳脫引號、反斜線與控制字元
+		output << (n > 0 ? ",{\"name\":\"" : "{\"name\":\"");
+		for (const char c : snapshot.name) {
+			if (c == '"' || c == '\\') output << '\\' << c;
+			else if (static_cast<unsigned char>(c) < 0x20) output << ' ';
+			else output << c;
+		}
+
+		::snprintf(buffer, sizeof(buffer),
+			"\",\"captured\":%llu,\"processed\":%llu,\"skipped\":%llu,\"idle\":%llu,\"tracked\":%llu,\"reconnects\":%llu,\"stalls\":%llu,\"dropped\":%llu,\"queue\":%zu,\"queue_max\":%zu,\"allocations\":%llu,\"scratch\":%llu,\"stages\":{",
+			static_cast<unsigned long long>(snapshot.captured),
+			static_cast<unsigned long long>(snapshot.processed),
+			static_cast<unsigned long long>(snapshot.skipped),
+			static_cast<unsigned long long>(snapshot.idle),
+			static_cast<unsigned long long>(snapshot.tracked),
+			static_cast<unsigned long long>(snapshot.reconnects),
+			static_cast<unsigned long long>(snapshot.stalls),
+			static_cast<unsigned long long>(snapshot.dropped),
+			snapshot.queueDepth, snapshot.queueMax,
+			static_cast<unsigned long long>(snapshot.allocations),
+			static_cast<unsigned long long>(snapshot.scratch));
+		output << buffer;
+
+		bool isFirst = true;
+		for (int i = 0; i < CAR_METRIC_STAGES; i++) {
+			const auto& stage = snapshot.stages[i];
+			if (stage.count == 0) continue;
+
+			::snprintf(buffer, sizeof(buffer),
+				"%s\"%s\":{\"count\":%llu,\"mean\":%.1f,\"min\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+				isFirst ? "" : ",",
+				CarStreamMetrics::GetStageName(static_cast<MetricStage>(i)),
+				static_cast<unsigned long long>(stage.count), stage.mean,
+				static_cast<unsigned long long>(stage.min),
+				static_cast<unsigned long long>(stage.p50),
+				static_cast<unsigned long long>(stage.p90),
+				static_cast<unsigned long long>(stage.p99),
+				static_cast<unsigned long long>(stage.p999),
+				static_cast<unsigned long long>(stage.max));
+			output << buffer;
+			isFirst = false;
+		}
+		output << "}}";
+	}
+	output << "]}\n";
+}
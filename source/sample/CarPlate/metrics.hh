@@ -0,0 +1,240 @@
+﻿/**************************************************************************//**
+ * @file	metrics.hh
+ * @brief	車牌偵測效能統計 (各階段延遲直方圖、佇列與丟幀計數) 類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_METRICS_HH
+#define	ODMC_CARPLATE_METRICS_HH
+#include <ostream>
+#include <string>
+#include "channel.hh"
+
+#define CAR_HISTOGRAM_SUB_BITS	5		//!< 直方圖每個 2 的冪次區間細分位元數 (32 格，相對誤差約 3%)
+#define CAR_HISTOGRAM_MAX_BITS	36		//!< 直方圖可記錄的最大值位元數 (微秒，約 19 小時)
+#define CAR_HISTOGRAM_BUCKETS	((CAR_HISTOGRAM_MAX_BITS - CAR_HISTOGRAM_SUB_BITS + 1) << CAR_HISTOGRAM_SUB_BITS)
+
+/**
+ *	@enum	MetricStage
+ *	@brief	計時階段列表
+ */
+enum class MetricStage {
+	Capture = 0,	//!< 擷取 (grab，等待串流或讀取檔案)
+	Decode,			//!< 解碼 (retrieve 與縮放)
+	Motion,			//!< 畫面變化偵測
+	Grayscale,		//!< 灰階轉換
+	Contrast,		//!< 提高對比
+	Blur,			//!< 平滑化
+	Threshold,		//!< 二值化 (邊緣強化)
+	Tiled,			//!< 分塊融合預處理 (灰階至二值化)
+	Contours,		//!< 連通元件標記
+	Candidates,		//!< 車牌候選區域篩選
+	Recognize,		//!< 車牌字元辨識
+	Overlay,		//!< 疊合輪廓圖層
+	Reorder,		//!< 幀平行模式等待前面的幀完成 (重新排序)
+	Present,		//!< 顯示影像
+	Count,			//!< 階段數量
+};
+
+#define CAR_METRIC_STAGES		static_cast<int>(MetricStage::Count)
+
+/**
+ *	@enum	MetricsFormat
+ *	@brief	統計資料輸出格式
+ */
+enum class MetricsFormat {
+	Text = 0,		//!< 純文字 (每路串流一個區塊)
+	Json,			//!< JSON (每次輸出一行)
+};
+
+/**
+ *	@struct	CarHistogramSnapshot
+ *	@brief	延遲直方圖快照 (微秒)
+ */
+struct CarHistogramSnapshot {
+	uint64_t	count;		//!< 記錄次數
+	double		mean;		//!< 平均值
+	uint64_t	min;		//!< 最小值
+	uint64_t	p50;		//!< 50 百分位數
+	uint64_t	p90;		//!< 90 百分位數
+	uint64_t	p99;		//!< 99 百分位數
+	uint64_t	p999;		//!< 99.9 百分位數
+	uint64_t	max;		//!< 最大值
+};
+
+/**
+ *	@class	CarLatencyHistogram
+ *	@brief	HDR 形式 (對數分段、線性細分) 延遲直方圖
+ *	@remark	記錄只使用 relaxed atomic 累加，不需要鎖，可由多個 thread 同時記錄。
+ *			快照與記錄同時進行時結果為近似值 (各計數之間不保證一致)。
+ */
+class CarLatencyHistogram
+{
+public:
+	CarLatencyHistogram();
+
+	void Record(uint64_t value);
+	void GetSnapshot(CarHistogramSnapshot& snapshot) const;
+	void Reset();
+	uint64_t GetCount() const { return m_nCount.load(std::memory_order_relaxed); }
+
+	static size_t GetIndex(uint64_t value);
+	static uint64_t GetUpperValue(size_t index);
+
+private:
+	CarLatencyHistogram(const CarLatencyHistogram&) = delete;				//!< Disable copy construction
+	CarLatencyHistogram& operator=(const CarLatencyHistogram&) = delete;	//!< Disable assignment operator
+
+	std::atomic<uint64_t>	m_nBuckets[CAR_HISTOGRAM_BUCKETS];	//!< 各區間記錄次數
+	std::atomic<uint64_t>	m_nCount;		//!< 記錄次數
+	std::atomic<uint64_t>	m_nSum;			//!< 記錄值總和
+	std::atomic<uint64_t>	m_nMin;			//!< 最小值
+	std::atomic<uint64_t>	m_nMax;			//!< 最大值
+};
+
+/**
+ *	@struct	CarMetricsSnapshot
+ *	@brief	單一路串流統計資料快照
+ */
+struct CarMetricsSnapshot {
+	std::string	name;			//!< 串流名稱
+	uint64_t	captured;		//!< 已擷取幀數
+	uint64_t	processed;		//!< 已偵測幀數
+	uint64_t	skipped;		//!< 偵測端跳過不處理的幀數
+	uint64_t	idle;			//!< 畫面靜止略過偵測的幀數
+	uint64_t	tracked;		//!< 只搜尋追蹤區域 (非全畫面) 的幀數
+	uint64_t	reconnects;		//!< 影像來源重新連接次數
+	uint64_t	stalls;			//!< 偵測端等待停滯影像來源恢復的次數
+	uint64_t	dropped;		//!< 傳輸通道丟棄或覆寫的幀數
+	uint64_t	allocations;	//!< 影像緩衝池配置次數
+	uint64_t	scratch;		//!< 偵測暫存影像配置次數 (穩定運作時不增加)
+	size_t		queueDepth;		//!< 目前待處理幀數
+	size_t		queueMax;		//!< 待處理幀數最大值
+	CarHistogramSnapshot stages[CAR_METRIC_STAGES];	//!< 各階段延遲 (微秒)
+};
+
+/**
+ *	@class	CarStreamMetrics
+ *	@brief	單一路串流效能統計
+ *	@remark	計時與計數由處理中的 threads 直接寫入 (不需要鎖)，佇列深度、丟幀與緩衝區配置次數於取得快照時
+ *			由設定的傳輸通道與緩衝池讀取，不增加每幀負擔。
+ */
+class CarStreamMetrics
+{
+public:
+	CarStreamMetrics(const std::string& name = std::string());
+	virtual ~CarStreamMetrics();
+
+	void Record(MetricStage stage, std::chrono::steady_clock::duration elapsed);
+	void AddCaptured() { m_nCaptured.fetch_add(1, std::memory_order_relaxed); }
+	void AddProcessed() { m_nProcessed.fetch_add(1, std::memory_order_relaxed); }
+	void AddSkipped() { m_nSkipped.fetch_add(1, std::memory_order_relaxed); }
+	void AddIdle() { m_nIdle.fetch_add(1, std::memory_order_relaxed); }
+	void AddTracked() { m_nTracked.fetch_add(1, std::memory_order_relaxed); }
+	void AddReconnect() { m_nReconnects.fetch_add(1, std::memory_order_relaxed); }
+	void AddStall() { m_nStalls.fetch_add(1, std::memory_order_relaxed); }
+	void AddScratch(uint64_t count) { m_nScratch.fetch_add(count, std::memory_order_relaxed); }
+	void SampleQueue(size_t depth);
+
+	void SetName(const std::string& name);
+	void SetSources(const CarFrameChannel* channelPtr, const CarFramePool* poolPtr);
+	void GetSnapshot(CarMetricsSnapshot& snapshot);
+	void Reset();
+
+	const CarLatencyHistogram& GetHistogram(MetricStage stage) const { return m_cStages[static_cast<int>(stage)]; }
+
+	static const char* GetStageName(MetricStage stage);
+
+private:
+	CarStreamMetrics(const CarStreamMetrics&) = delete;				//!< Disable copy construction
+	CarStreamMetrics& operator=(const CarStreamMetrics&) = delete;	//!< Disable assignment operator
+
+	CarLatencyHistogram		m_cStages[CAR_METRIC_STAGES];	//!< 各階段延遲直方圖 (微秒)
+	std::atomic<uint64_t>	m_nCaptured;		//!< 已擷取幀數
+	std::atomic<uint64_t>	m_nProcessed;		//!< 已偵測幀數
+	std::atomic<uint64_t>	m_nSkipped;			//!< 跳過不處理的幀數
+	std::atomic<uint64_t>	m_nIdle;			//!< 畫面靜止略過偵測的幀數
+	std::atomic<uint64_t>	m_nTracked;			//!< 只搜尋追蹤區域的幀數
+	std::atomic<uint64_t>	m_nReconnects;		//!< 影像來源重新連接次數
+	std::atomic<uint64_t>	m_nStalls;			//!< 等待停滯影像來源恢復的次數
+	std::atomic<uint64_t>	m_nScratch;			//!< 偵測暫存影像配置次數
+	std::atomic<size_t>		m_nQueueMax;		//!< 待處理幀數最大值
+
+	std::mutex				m_mutex;			//!< 保護名稱與統計來源
+	std::string				m_strName;			//!< 串流名稱
+	const CarFrameChannel*	m_channelPtr;		//!< 傳輸通道 (可為 nullptr)
+	const CarFramePool*		m_poolPtr;			//!< 影像緩衝池 (可為 nullptr)
+	uint64_t				m_nDroppedBase;		//!< 已更換的傳輸通道丟幀數量
+	uint64_t				m_nAllocBase;		//!< 已更換的緩衝池配置次數
+};
+
+/**
+ *	@class	CarStageTimer
+ *	@brief	區塊計時，解構時記錄經過時間 (統計物件為 nullptr 時不計時)
+ */
+class CarStageTimer
+{
+public:
+	CarStageTimer(CarStreamMetrics* metricsPtr, MetricStage stage)
+		: m_metricsPtr(metricsPtr)
+		, m_eStage(stage) {
+		if (m_metricsPtr != nullptr) {
+			m_tStart = std::chrono::steady_clock::now();
+		}
+	}
+
+	~CarStageTimer() {
+		if (m_metricsPtr != nullptr) {
+			m_metricsPtr->Record(m_eStage, std::chrono::steady_clock::now() - m_tStart);
+		}
+	}
+
+private:
+	CarStageTimer(const CarStageTimer&) = delete;				//!< Disable copy construction
+	CarStageTimer& operator=(const CarStageTimer&) = delete;	//!< Disable assignment operator
+
+	CarStreamMetrics*	m_metricsPtr;		//!< 統計物件
+	MetricStage			m_eStage;			//!< 計時階段
+	std::chrono::steady_clock::time_point m_tStart;	//!< 開始時間
+};
+
+/**
+ *	@class	CarMetricsRegistry
+ *	@brief	統計資料登錄，提供取得快照 (pull) 與定期輸出文字或 JSON
+ */
+class CarMetricsRegistry
+{
+public:
+	CarMetricsRegistry();
+	virtual ~CarMetricsRegistry();
+
+	void Register(CarStreamMetrics* metricsPtr);
+	void Unregister(CarStreamMetrics* metricsPtr);
+	void GetSnapshots(std::vector<CarMetricsSnapshot>& snapshots);
+
+	void Dump(std::ostream& output, MetricsFormat format);
+	bool StartDump(std::ostream& output, int intervalMs, MetricsFormat format = MetricsFormat::Text);
+	void StopDump();
+
+	static void WriteText(std::ostream& output, const std::vector<CarMetricsSnapshot>& snapshots);
+	static void WriteJson(std::ostream& output, const std::vector<CarMetricsSnapshot>& snapshots);
+
+private:
+	CarMetricsRegistry(const CarMetricsRegistry&) = delete;				//!< Disable copy construction
+	CarMetricsRegistry& operator=(const CarMetricsRegistry&) = delete;	//!< Disable assignment operator
+	static void DumpProcess(CarMetricsRegistry* cThisPtr);
+
+	std::mutex				m_mutex;			//!< 保護登錄列表
+	std::vector<CarStreamMetrics*> m_vecMetrics;	//!< 已登錄的統計物件
+
+	std::mutex				m_mutexDump;		//!< 定期輸出等待用 mutex
+	std::condition_variable	m_cvDump;			//!< 停止定期輸出通知
+	std::thread*			m_cProcDump;		//!< 定期輸出 thread
+	bool					m_isDumping;		//!< 定期輸出運作識別
+	std::ostream*			m_outputPtr;		//!< 定期輸出目標
+	int						m_nInterval;		//!< 定期輸出間隔 (ms)
+	MetricsFormat			m_eFormat;			//!< 定期輸出格式
+};
+
+#endif // !ODMC_CARPLATE_METRICS_HH
@@ -0,0 +1,233 @@
+﻿/**************************************************************************//**
+ * @file	motion.cc
+ * @brief	CarMotionGate 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "motion.hh"
+#include "opencv2/core/hal/intrin.hpp"
+
+/**
+ *	@brief	比較一列亮度與背景並更新背景
+ *	@param[in]		curPtr		目前亮度
+ *	@param[in,out]	bgPtr		背景亮度，依差值比例逼近目前亮度 (至少 1 階)。
+ *	@param[in]		maskPtr		偵測區域遮罩 (0 / 255)
+ *	@param[in]		len			像素數量
+ *	@param[in]		threshold	差值門檻
+ *	@return	<b>型別: int</b> \n 偵測區域內差值超過門檻的像素數量
+ */
+static int MotionRow(const uint8_t* curPtr, uint8_t* bgPtr, const uint8_t* maskPtr, int len, uint8_t threshold)
+{
+	int count = 0;
+	int i = 0;
+
+#if CV_SIMD
+	const int lanes = cv::v_uint8::nlanes;
+	const cv::v_uint8 vThresh = cv::vx_setall_u8(threshold);
+	const cv::v_uint8 vOne = cv::vx_setall_u8(1);
+	cv::v_uint32 acc = cv::vx_setzero_u32();
+	for (; i <= len - lanes; i += lanes) {
+		const cv::v_uint8 cur = cv::vx_load(curPtr + i);
+		const cv::v_uint8 bg = cv::vx_load(bgPtr + i);
+		const cv::v_uint8 diff = cv::v_absdiff(cur, bg);
+
+		// 變化像素計數 (比較結果為 0xFF，遮罩後取最低位元累加)
+		const cv::v_uint8 changed = (diff > vThresh) & cv::vx_load(maskPtr + i) & vOne;
+		cv::v_uint16 c0, c1;
+		cv::v_expand(changed, c0, c1);
+		cv::v_uint32 d0, d1;
+		cv::v_expand(c0 + c1, d0, d1);
+		acc += d0 + d1;
+
+		// 背景更新: step = max(diff >> shift, min(diff, 1))
+		cv::v_uint16 s0, s1;
+		cv::v_expand(diff, s0, s1);
+		const cv::v_uint8 step = cv::v_max(cv::v_pack(cv::v_shr<CAR_MOTION_LEARN_SHIFT>(s0), cv::v_shr<CAR_MOTION_LEARN_SHIFT>(s1)), cv::v_min(diff, vOne));
+		cv::v_store(bgPtr + i, cv::v_select(cur > bg, bg + step, bg - step));
+	}
+	count = static_cast<int>(cv::v_reduce_sum(acc));
+	cv::vx_cleanup();
+#endif
+
+	for (; i < len; i++) {
+		const int cur = curPtr[i];
+		const int bg = bgPtr[i];
+		const int diff = std::abs(cur - bg);
+
+		if (diff > threshold && maskPtr[i] != 0) {
+			count++;
+		}
+
+		const int step = std::max(diff >> CAR_MOTION_LEARN_SHIFT, std::min(diff, 1));
+		bgPtr[i] = static_cast<uint8_t>(cur > bg ? bg + step : bg - step);
+	}
+	return count;
+}
+
+/**
+ *	@brief	CarMotionGate 建構式
+ *	@return	此函數沒有返回值
+ */
+CarMotionGate::CarMotionGate()
+	: m_sOptions()
+	, m_sFrameSize()
+	, m_nMaskPixels(0)
+	, m_nChanged(0)
+	, m_nStatic(0)
+	, m_nIdle(0)
+	, m_fRatio(0.0)
+	, m_isActive(true) {
+}
+
+/**
+ *	@brief	CarMotionGate 解構式
+ *	@return	此函數沒有返回值
+ */
+CarMotionGate::~CarMotionGate() {}
+
+/**
+ *	@brief	設定畫面變化偵測選項，背景模型於下一幀重建。
+ *	@param[in]	options	畫面變化偵測選項
+ *	@return	此函數沒有返回值
+ */
+void CarMotionGate::SetOptions(const CarMotionOptions& options)
+{
+	m_sOptions = options;
+	m_sOptions.scale = std::max(options.scale, 1);
+	m_sOptions.threshold = std::min(std::max(options.threshold, 0), 255);
+	m_sOptions.offRatio = std::min(options.offRatio, options.onRatio);
+	m_sOptions.onFrames = std::max(options.onFrames, 1);
+	m_sOptions.holdFrames = std::max(options.holdFrames, 1);
+	m_sOptions.refreshFrames = std::max(options.refreshFrames, 0);
+	this->Reset();
+}
+
+/**
+ *	@brief	清除背景模型，下一幀視為有變化。
+ *	@return	此函數沒有返回值
+ */
+void CarMotionGate::Reset()
+{
+	m_sFrameSize = cv::Size();
+	m_imgBackground.release();
+	m_nChanged = 0;
+	m_nStatic = 0;
+	m_nIdle = 0;
+	m_fRatio = 0.0;
+	m_isActive = true;
+}
+
+/**
+ *	@brief	加入一幀影像並判斷是否需要進行車牌偵測
+ *	@param[in]	imgFrame	原始影像 (BGR 或灰階)
+ *	@return	<b>型別: bool</b> \n 若畫面有變化 (或未啟用、需定期偵測) 返回值為非零值 (true)。 \n 若畫面靜止返回值為零 (false)。
+ */
+bool CarMotionGate::Update(const cv::Mat& imgFrame)
+{
+	if (!m_sOptions.isEnabled || imgFrame.empty()) {
+		return true;
+	}
+
+	// 縮小後轉為亮度平面 (面積平均同時降低雜訊)
+	const int scale = m_sOptions.scale;
+	const cv::Size smallSize(std::max(imgFrame.cols / scale, 1), std::max(imgFrame.rows / scale, 1));
+	if (imgFrame.channels() == 1) {
+		cv::resize(imgFrame, m_imgLuma, smallSize, 0, 0, cv::INTER_AREA);
+	}
+	else {
+		cv::resize(imgFrame, m_imgSmall, smallSize, 0, 0, cv::INTER_AREA);
+		cv::cvtColor(m_imgSmall, m_imgLuma, cv::COLOR_BGR2GRAY);
+	}
+
+	// 第一幀或尺寸改變時重建背景與遮罩，視為有變化
+	if (m_imgBackground.empty() || m_sFrameSize != imgFrame.size()) {
+		m_sFrameSize = imgFrame.size();
+		m_imgLuma.copyTo(m_imgBackground);
+		this->BuildMask(m_sFrameSize);
+		m_nChanged = 0;
+		m_nStatic = 0;
+		m_fRatio = 1.0;
+		m_isActive = true;
+		return true;
+	}
+
+	int changed = 0;
+	const auto threshold = static_cast<uint8_t>(m_sOptions.threshold);
+	for (int y = 0; y < m_imgLuma.rows; y++) {
+		changed += MotionRow(m_imgLuma.ptr<uint8_t>(y), m_imgBackground.ptr<uint8_t>(y), m_imgMask.ptr<uint8_t>(y), m_imgLuma.cols, threshold);
+	}
+	m_fRatio = (m_nMaskPixels > 0) ? static_cast<double>(changed) / m_nMaskPixels : 0.0;
+
+	// 遲滯: 連續 onFrames 幀變化才開始偵測，連續 holdFrames 幀靜止才停止偵測
+	if (m_fRatio >= m_sOptions.onRatio) {
+		m_nStatic = 0;
+		if (++m_nChanged >= m_sOptions.onFrames) {
+			m_isActive = true;
+		}
+	}
+	else if (m_fRatio < m_sOptions.offRatio) {
+		m_nChanged = 0;
+		if (++m_nStatic >= m_sOptions.holdFrames) {
+			m_isActive = false;
+		}
+	}
+	else {
+		m_nChanged = 0;
+		m_nStatic = 0;
+	}
+
+	// 靜止期間定期偵測一幀 (光線緩慢變化或緩慢移動的車輛)
+	if (m_isActive) {
+		m_nIdle = 0;
+		return true;
+	}
+	m_nIdle++;
+	return m_sOptions.refreshFrames > 0 && (m_nIdle % m_sOptions.refreshFrames) == 0;
+}
+
+/**
+ *	@brief	依偵測區域與遮罩建立縮小遮罩
+ *	@param[in]	frameSize	原始影像尺寸
+ *	@return	此函數沒有返回值
+ */
+void CarMotionGate::BuildMask(const cv::Size& frameSize)
+{
+	const auto& regions = m_sOptions.regions;
+	const auto& mask = m_sOptions.mask;
+	const cv::Size smallSize = m_imgLuma.size();
+
+	// 未指定偵測區域時偵測全畫面
+	if (regions.empty() && mask.empty()) {
+		m_imgMask.create(smallSize, CV_8UC1);
+		m_imgMask.setTo(cv::Scalar(255));
+		m_nMaskPixels = smallSize.area();
+		return;
+	}
+
+	m_imgMask.create(smallSize, CV_8UC1);
+	m_imgMask.setTo(cv::Scalar(0));
+
+	// 遮罩縮小後只要區塊內有任何偵測像素即納入
+	if (!mask.empty()) {
+		cv::Mat imgMask;
+		cv::resize(mask, imgMask, smallSize, 0, 0, cv::INTER_AREA);
+		cv::threshold(imgMask, m_imgMask, 0, 255, cv::THRESH_BINARY);
+	}
+
+	const double fx = static_cast<double>(smallSize.width) / frameSize.width;
+	const double fy = static_cast<double>(smallSize.height) / frameSize.height;
+	const cv::Rect bounds(0, 0, smallSize.width, smallSize.height);
+	for (const auto& region : regions) {
+		const int x0 = static_cast<int>(region.x * fx);
+		const int y0 = static_cast<int>(region.y * fy);
+		const int x1 = static_cast<int>(std::ceil((region.x + region.width) * fx));
+		const int y1 = static_cast<int>(std::ceil((region.y + region.height) * fy));
+		const cv::Rect rect = cv::Rect(x0, y0, x1 - x0, y1 - y0) & bounds;
+		if (rect.area() > 0) {
+			m_imgMask(rect).setTo(cv::Scalar(255));
+		}
+	}
+
+	m_nMaskPixels = cv::countNonZero(m_imgMask);
+}
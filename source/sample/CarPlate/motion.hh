@@ -0,0 +1,82 @@
+﻿/**************************************************************************//**
+ * @file	motion.hh
+ * @brief	CarMotionGate 畫面變化偵測 (靜止畫面略過車牌偵測) 類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_MOTION_HH
+#define	ODMC_CARPLATE_MOTION_HH
+#include "carcore.hh"
+
+/**
+ *	@struct	CarMotionOptions
+ *	@brief	畫面變化偵測選項
+ */
+struct CarMotionOptions {
+	bool		isEnabled;		//!< 是否啟用 (停用時每一幀都進行偵測)
+	int			scale;			//!< 亮度平面縮小倍數
+	int			threshold;		//!< 像素亮度與背景差值門檻
+	double		onRatio;		//!< 變化像素比例達到此值視為有變化
+	double		offRatio;		//!< 變化像素比例低於此值視為靜止
+	int			onFrames;		//!< 連續變化幀數達到此值開始偵測
+	int			holdFrames;		//!< 連續靜止幀數達到此值停止偵測
+	int			refreshFrames;	//!< 靜止期間每隔此幀數仍偵測一幀，0 = 不偵測
+	std::vector<cv::Rect> regions;	//!< 偵測區域 (原始影像座標)，空列表 = 全畫面
+	cv::Mat		mask;			//!< 偵測區域遮罩 (CV_8UC1，非零 = 偵測)，與 regions 聯集
+
+	CarMotionOptions()
+		: isEnabled(false)
+		, scale(CAR_MOTION_SCALE)
+		, threshold(CAR_MOTION_THRESHOLD)
+		, onRatio(CAR_MOTION_ON_RATIO)
+		, offRatio(CAR_MOTION_OFF_RATIO)
+		, onFrames(CAR_MOTION_ON_FRAMES)
+		, holdFrames(CAR_MOTION_HOLD_FRAMES)
+		, refreshFrames(0)
+		, regions()
+		, mask() {
+	}
+};
+
+/**
+ *	@class	CarMotionGate
+ *	@brief	畫面變化偵測
+ *	@remark	影像縮小為亮度平面後與背景模型比較，計算偵測區域內變化像素比例，背景模型每幀依差值比例逼近目前畫面。
+ *			變化判斷使用遲滯 (開始與停止使用不同比例與連續幀數)，避免雜訊造成偵測頻繁開關。
+ *			比較與背景更新使用 OpenCV universal intrinsics (SIMD)，每幀成本遠小於預處理。
+ */
+class CarMotionGate
+{
+public:
+	CarMotionGate();
+	virtual ~CarMotionGate();
+
+	void SetOptions(const CarMotionOptions& options);
+	void Reset();
+	bool Update(const cv::Mat& imgFrame);
+
+	bool IsEnabled() const { return m_sOptions.isEnabled; }
+	bool IsActive() const { return m_isActive; }
+	double GetRatio() const { return m_fRatio; }
+
+private:
+	CarMotionGate(const CarMotionGate&) = delete;				//!< Disable copy construction
+	CarMotionGate& operator=(const CarMotionGate&) = delete;	//!< Disable assignment operator
+	void BuildMask(const cv::Size& frameSize);
+
+	CarMotionOptions	m_sOptions;			//!< 畫面變化偵測選項
+	cv::Size			m_sFrameSize;		//!< 原始影像尺寸 (尺寸改變時重建背景)
+	cv::Mat				m_imgSmall;			//!< 縮小影像
+	cv::Mat				m_imgLuma;			//!< 縮小亮度平面
+	cv::Mat				m_imgBackground;	//!< 背景模型 (亮度)
+	cv::Mat				m_imgMask;			//!< 縮小偵測區域遮罩 (0 / 255)
+	int					m_nMaskPixels;		//!< 偵測區域像素數量
+	int					m_nChanged;			//!< 連續變化幀數
+	int					m_nStatic;			//!< 連續靜止幀數
+	int					m_nIdle;			//!< 停止偵測後經過的幀數
+	double				m_fRatio;			//!< 最近一幀變化像素比例
+	bool				m_isActive;			//!< 目前是否進行偵測
+};
+
+#endif // !ODMC_CARPLATE_MOTION_HH
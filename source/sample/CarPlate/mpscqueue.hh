@@ -0,0 +1,146 @@
+﻿/**************************************************************************//**
+ * @file	mpscqueue.hh
+ * @brief	CarMpscQueue 多生產者/單一消費者無鎖佇列樣板 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_MPSCQUEUE_HH
+#define	ODMC_CARPLATE_MPSCQUEUE_HH
+#include <memory>
+#include "carcore.hh"
+
+/**
+ *	@class	CarMpscQueue
+ *	@brief	固定容量多生產者/單一消費者無鎖佇列
+ *	@remark	每個槽位帶有序號 (sequence)，生產者以 CAS 取得 head 位置後寫入槽位，再以 release 發布序號，
+ *			消費者依 tail 位置的序號判斷項目是否已完成寫入。放入與取出都不使用鎖也不休眠，
+ *			佇列已滿時直接丟棄要放入的項目並計數，生產者 (偵測 thread) 永遠不會被消費者 (I/O thread) 阻塞。
+ *			項目以複製方式放入與取出，適合固定大小的 POD 結構。
+ */
+template <typename T>
+class CarMpscQueue
+{
+public:
+	explicit CarMpscQueue(size_t capacity = CAR_EVENT_QUEUE_CAPACITY);
+	virtual ~CarMpscQueue() {}
+
+	bool Push(const T& item);
+	bool Pop(T& item);
+
+	bool IsValid() const { return m_slots != nullptr; }
+	size_t GetCapacity() const { return m_nCapacity; }
+	uint64_t GetProduced() const { return m_nProduced.load(std::memory_order_relaxed); }
+	uint64_t GetConsumed() const { return m_nConsumed.load(std::memory_order_relaxed); }
+	uint64_t GetDropped() const { return m_nDropped.load(std::memory_order_relaxed); }
+
+private:
+	CarMpscQueue(const CarMpscQueue&) = delete;				//!< Disable copy construction
+	CarMpscQueue& operator=(const CarMpscQueue&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Slot
+	 *	@brief	佇列槽位
+	 */
+	struct Slot {
+		std::atomic<size_t>	seq;	//!< 槽位序號: 等於 head 表示可寫入，等於 tail + 1 表示可讀取
+		T					item;	//!< 槽位內容
+	};
+
+	std::unique_ptr<Slot[]>	m_slots;					//!< 槽位陣列
+	size_t					m_nCapacity;				//!< 容量 (2 的次方)
+	size_t					m_nMask;					//!< 索引遮罩
+
+	char					m_padHead[64];				//!< 分隔 cache line，避免 false sharing
+	std::atomic<size_t>		m_nHead;					//!< 下一個寫入位置 (生產者 CAS 更新)
+	char					m_padTail[64];				//!< 分隔 cache line，避免 false sharing
+	size_t					m_nTail;					//!< 下一個讀取位置 (只有消費者存取)
+	char					m_padState[64];				//!< 分隔 cache line，避免 false sharing
+
+	std::atomic<uint64_t>	m_nProduced;				//!< 放入項目數量
+	std::atomic<uint64_t>	m_nConsumed;				//!< 取出項目數量
+	std::atomic<uint64_t>	m_nDropped;					//!< 佇列已滿丟棄的項目數量
+};
+
+/**
+ *	@brief	CarMpscQueue 建構式
+ *	@param[in]	capacity	容量 (向上取 2 的次方，最小為 2)
+ *	@return	此函數沒有返回值
+ *	@remark	槽位陣列配置失敗時容量為 0，IsValid 返回 false，不可放入或取出。
+ */
+template <typename T>
+CarMpscQueue<T>::CarMpscQueue(size_t capacity)
+	: m_nCapacity(2)
+	, m_nHead(0)
+	, m_nTail(0)
+	, m_nProduced(0)
+	, m_nConsumed(0)
+	, m_nDropped(0) {
+	while (m_nCapacity < capacity) m_nCapacity <<= 1;
+	m_nMask = m_nCapacity - 1;
+	m_slots.reset(new (std::nothrow) Slot[m_nCapacity]);
+	if (m_slots == nullptr) {
+		m_nCapacity = 0;
+		m_nMask = 0;
+		return;
+	}
+	for (size_t i = 0; i < m_nCapacity; i++) {
+		m_slots[i].seq.store(i, std::memory_order_relaxed);
+	}
+}
+
+/**
+ *	@brief	放入項目 (可由多個生產者同時呼叫，不會阻塞)
+ *	@param[in]	item	要放入的項目 (複製至槽位)
+ *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若佇列已滿 (項目被丟棄) 返回值為零 (false)。
+ */
+template <typename T>
+bool CarMpscQueue<T>::Push(const T& item)
+{
+	size_t head = m_nHead.load(std::memory_order_relaxed);
+	for (;;) {
+		Slot& slot = m_slots[head & m_nMask];
+		const size_t seq = slot.seq.load(std::memory_order_acquire);
+		const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(head);
+
+		if (diff == 0) {
+			// 槽位可寫入，取得 head 位置 (失敗時 head 更新為最新值後重試)
+			if (m_nHead.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+				slot.item = item;
+				slot.seq.store(head + 1, std::memory_order_release);
+				m_nProduced.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			// 槽位尚未被消費者取出: 佇列已滿
+			m_nDropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else {
+			head = m_nHead.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ *	@brief	取出項目 (只能由消費者呼叫，不會阻塞)
+ *	@param[out]	item	存放取出的項目
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若佇列為空 (或下一個項目尚未完成寫入) 返回值為零 (false)。
+ */
+template <typename T>
+bool CarMpscQueue<T>::Pop(T& item)
+{
+	Slot& slot = m_slots[m_nTail & m_nMask];
+	if (slot.seq.load(std::memory_order_acquire) != m_nTail + 1) {
+		return false;
+	}
+
+	item = slot.item;
+	slot.seq.store(m_nTail + m_nCapacity, std::memory_order_release);
+	m_nTail++;
+	m_nConsumed.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+#endif // !ODMC_CARPLATE_MPSCQUEUE_HH
@@ -0,0 +1,508 @@
+﻿/**************************************************************************//**
+ * @file	ocr.cc
+ * @brief	CarPlateOcr 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include "ocr.hh"
+#include "opencv2/core/hal/intrin.hpp"
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#	define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <windows.h>
+#endif
+
+/**
+ *	@brief	計算兩特徵列距離平方 (float)
+ *	@param[in]	aPtr	特徵列 A
+ *	@param[in]	bPtr	特徵列 B
+ *	@param[in]	len		特徵長度
+ *	@return	<b>型別: float</b> \n 距離平方
+ */
+static float DistanceF32(const float* aPtr, const float* bPtr, int len)
+{
+	float sum = 0.0f;
+	int i = 0;
+
+#if CV_SIMD
+	const int lanes = cv::v_float32::nlanes;
+	cv::v_float32 acc0 = cv::vx_setzero_f32();
+	cv::v_float32 acc1 = cv::vx_setzero_f32();
+	for (; i <= len - 2 * lanes; i += 2 * lanes) {
+		cv::v_float32 d0 = cv::vx_load(aPtr + i) - cv::vx_load(bPtr + i);
+		cv::v_float32 d1 = cv::vx_load(aPtr + i + lanes) - cv::vx_load(bPtr + i + lanes);
+		acc0 = cv::v_muladd(d0, d0, acc0);
+		acc1 = cv::v_muladd(d1, d1, acc1);
+	}
+	sum = cv::v_reduce_sum(acc0 + acc1);
+	cv::vx_cleanup();
+#endif
+
+	for (; i < len; i++) {
+		const float d = aPtr[i] - bPtr[i];
+		sum += d * d;
+	}
+	return sum;
+}
+
+/**
+ *	@brief	計算兩特徵列距離平方 (8-bit 量化)
+ *	@param[in]	aPtr	特徵列 A
+ *	@param[in]	bPtr	特徵列 B
+ *	@param[in]	len		特徵長度
+ *	@return	<b>型別: float</b> \n 距離平方
+ */
+static float DistanceU8(const uint8_t* aPtr, const uint8_t* bPtr, int len)
+{
+	int sum = 0;
+	int i = 0;
+
+#if CV_SIMD
+	const int lanes = cv::v_uint8::nlanes;
+	cv::v_int32 acc = cv::vx_setzero_s32();
+	for (; i <= len - lanes; i += lanes) {
+		cv::v_uint16 d0, d1;
+		cv::v_expand(cv::v_absdiff(cv::vx_load(aPtr + i), cv::vx_load(bPtr + i)), d0, d1);
+		cv::v_int16 s0 = cv::v_reinterpret_as_s16(d0);
+		cv::v_int16 s1 = cv::v_reinterpret_as_s16(d1);
+		acc += cv::v_dotprod(s0, s0) + cv::v_dotprod(s1, s1);
+	}
+	sum = cv::v_reduce_sum(acc);
+	cv::vx_cleanup();
+#endif
+
+	for (; i < len; i++) {
+		const int d = static_cast<int>(aPtr[i]) - static_cast<int>(bPtr[i]);
+		sum += d * d;
+	}
+	return static_cast<float>(sum);
+}
+
+/**
+ *	@brief	CarPlateOcr 建構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateOcr::CarPlateOcr()
+	: m_nSamples(0)
+	, m_nFeatures(0)
+	, m_nStride(0)
+	, m_nNeighbors(CAR_OCR_NEIGHBORS)
+	, m_labelPtr(nullptr)
+	, m_trainF32Ptr(nullptr)
+	, m_trainU8Ptr(nullptr) {
+}
+
+/**
+ *	@brief	CarPlateOcr 解構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateOcr::~CarPlateOcr() { this->Release(); }
+
+/**
+ *	@brief	釋放訓練資料
+ *	@return	此函數沒有返回值
+ */
+void CarPlateOcr::Release()
+{
+	m_nSamples = 0;
+	m_nFeatures = 0;
+	m_nStride = 0;
+	m_labelPtr = nullptr;
+	m_trainF32Ptr = nullptr;
+	m_trainU8Ptr = nullptr;
+	m_vecLabels.clear();
+	m_matTrain.release();
+	m_cModelFile.Close();
+}
+
+/**
+ *	@brief	由 OpenCV XML 檔案載入訓練資料
+ *	@param[in]	classFile	classifications.xml 檔案路徑 (每個樣本的字元標籤)
+ *	@param[in]	imageFile	images.xml 檔案路徑 (每個樣本 20x30 字元影像展開為一列)
+ *	@param[in]	quantize	是否將特徵量化為 8-bit 儲存 (訓練影像原本即為 0 ~ 255 整數，量化不損失精度)
+ *	@return	<b>型別: bool</b> \n 若載入成功返回值為非零值 (true)。 \n 若載入失敗返回值為零 (false)。
+ */
+bool CarPlateOcr::LoadXml(const cv::String& classFile, const cv::String& imageFile, bool quantize)
+{
+	cv::Mat matLabels;
+	cv::Mat matImages;
+
+	this->Release();
+	for (;;) {
+		cv::FileStorage fsLabels(classFile, cv::FileStorage::READ);
+		if (!fsLabels.isOpened()) break;
+		fsLabels["classifications"] >> matLabels;
+		fsLabels.release();
+
+		cv::FileStorage fsImages(imageFile, cv::FileStorage::READ);
+		if (!fsImages.isOpened()) break;
+		fsImages["images"] >> matImages;
+		fsImages.release();
+
+		return this->SetTraining(matLabels, matImages, quantize);
+	}
+	return false;
+}
+
+/**
+ *	@brief	映射載入二進位模型檔，載入時間與模型大小無關
+ *	@param[in]	modelPtr	(指標) 模型檔路徑
+ *	@return	<b>型別: bool</b> \n 若載入成功返回值為非零值 (true)。 \n 若檔案不存在或格式錯誤返回值為零 (false)。
+ */
+bool CarPlateOcr::LoadModel(const char* modelPtr)
+{
+	this->Release();
+	for (;;) {
+		if (!m_cModelFile.Open(modelPtr)) break;
+
+		const uint8_t* basePtr = m_cModelFile.GetData();
+		const uint64_t size = static_cast<uint64_t>(m_cModelFile.GetSize());
+		if (size < sizeof(CarOcrModelHeader)) break;
+
+		// 驗證檔頭
+		const auto& header = *reinterpret_cast<const CarOcrModelHeader*>(basePtr);
+		if (::memcmp(header.magic, CAR_OCR_MODEL_MAGIC, sizeof(header.magic)) != 0) break;
+		if (header.version != CAR_OCR_MODEL_VERSION || header.headerSize != sizeof(CarOcrModelHeader)) break;
+		if (header.charWidth != CAR_OCR_CHAR_WD || header.charHeight != CAR_OCR_CHAR_HT) break;
+		if (header.features != header.charWidth * header.charHeight || header.stride < header.features) break;
+		if (header.elemSize != 1 && header.elemSize != sizeof(float)) break;
+		if (header.samples == 0 || header.fileSize != size) break;
+
+		// 驗證區段範圍與對齊
+		const uint64_t labelBytes = static_cast<uint64_t>(header.samples) * sizeof(int32_t);
+		const uint64_t featureBytes = static_cast<uint64_t>(header.samples) * header.stride * header.elemSize;
+		if (header.labelOffset % sizeof(int32_t) != 0 || header.labelOffset + labelBytes > size) break;
+		if (header.featureOffset % CAR_OCR_ALIGN != 0 || header.featureOffset + featureBytes > size) break;
+
+		m_nSamples = static_cast<int>(header.samples);
+		m_nFeatures = static_cast<int>(header.features);
+		m_nStride = static_cast<int>(header.stride);
+		m_labelPtr = reinterpret_cast<const int*>(basePtr + header.labelOffset);
+		if (header.elemSize == 1) {
+			m_trainU8Ptr = basePtr + header.featureOffset;
+		}
+		else {
+			m_trainF32Ptr = reinterpret_cast<const float*>(basePtr + header.featureOffset);
+		}
+		return true;
+	}
+
+	this->Release();
+	return false;
+}
+
+/**
+ *	@brief	將目前載入的訓練資料存為二進位模型檔
+ *	@param[in]	modelPtr	(指標) 模型檔路徑
+ *	@return	<b>型別: bool</b> \n 若儲存成功返回值為非零值 (true)。 \n 若尚未載入訓練資料或寫入失敗返回值為零 (false)。
+ *	@remark	先寫入同目錄的暫存檔 (檔名含 thread 識別)，完成後以 rename 取代模型檔，
+ *			其他 thread 或行程已映射的模型檔內容不會被截斷，同時轉換時以最後完成者為準。
+ */
+bool CarPlateOcr::SaveModel(const char* modelPtr) const
+{
+	const uint8_t zeros[CAR_OCR_ALIGN] = { 0 };
+	CarOcrModelHeader header;
+	FILE* filePtr = nullptr;
+
+	if (!this->IsLoaded() || modelPtr == nullptr) {
+		return false;
+	}
+
+	const uint32_t elemSize = (m_trainU8Ptr != nullptr) ? 1 : static_cast<uint32_t>(sizeof(float));
+	const uint64_t labelBytes = static_cast<uint64_t>(m_nSamples) * sizeof(int32_t);
+	const uint64_t featureBytes = static_cast<uint64_t>(m_nSamples) * m_nStride * elemSize;
+
+	::memset(&header, 0, sizeof(header));
+	::memcpy(header.magic, CAR_OCR_MODEL_MAGIC, sizeof(header.magic));
+	header.version = CAR_OCR_MODEL_VERSION;
+	header.headerSize = sizeof(CarOcrModelHeader);
+	header.samples = static_cast<uint32_t>(m_nSamples);
+	header.features = static_cast<uint32_t>(m_nFeatures);
+	header.charWidth = CAR_OCR_CHAR_WD;
+	header.charHeight = CAR_OCR_CHAR_HT;
+	header.elemSize = elemSize;
+	header.stride = static_cast<uint32_t>(m_nStride);
+	header.labelOffset = sizeof(CarOcrModelHeader);
+	header.featureOffset = (header.labelOffset + labelBytes + CAR_OCR_ALIGN - 1) / CAR_OCR_ALIGN * CAR_OCR_ALIGN;
+	header.fileSize = header.featureOffset + featureBytes;
+
+	const std::string strTemp = std::string(modelPtr) + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	for (;;) {
+		if ((filePtr = ::fopen(strTemp.c_str(), "wb")) == nullptr) break;
+
+		const auto padding = static_cast<size_t>(header.featureOffset - header.labelOffset - labelBytes);
+		const void* featurePtr = (elemSize == 1)
+			? static_cast<const void*>(m_trainU8Ptr)
+			: static_cast<const void*>(m_trainF32Ptr);
+
+		if (::fwrite(&header, sizeof(header), 1, filePtr) != 1) break;
+		if (::fwrite(m_labelPtr, static_cast<size_t>(labelBytes), 1, filePtr) != 1) break;
+		if (padding > 0 && ::fwrite(zeros, padding, 1, filePtr) != 1) break;
+		if (::fwrite(featurePtr, static_cast<size_t>(featureBytes), 1, filePtr) != 1) break;
+
+		const bool okey = ::fclose(filePtr) == 0;
+		filePtr = nullptr;
+		if (!okey) break;
+
+#if defined(_WIN32)
+		if (!::MoveFileExA(strTemp.c_str(), modelPtr, MOVEFILE_REPLACE_EXISTING)) break;
+#else
+		if (::rename(strTemp.c_str(), modelPtr) != 0) break;
+#endif
+		return true;
+	}
+
+	if (filePtr != nullptr) {
+		::fclose(filePtr);
+	}
+	::remove(strTemp.c_str());
+	return false;
+}
+
+/**
+ *	@brief	將 OpenCV XML 訓練資料轉換為二進位模型檔
+ *	@param[in]	classFile	classifications.xml 檔案路徑
+ *	@param[in]	imageFile	images.xml 檔案路徑
+ *	@param[in]	modelPtr	(指標) 輸出模型檔路徑
+ *	@param[in]	quantize	是否量化為 8-bit
+ *	@return	<b>型別: bool</b> \n 若轉換成功返回值為非零值 (true)。 \n 若轉換失敗返回值為零 (false)。
+ */
+bool CarPlateOcr::ConvertXml(const cv::String& classFile, const cv::String& imageFile, const char* modelPtr, bool quantize)
+{
+	CarPlateOcr cOcr;
+	if (!cOcr.LoadXml(classFile, imageFile, quantize)) {
+		return false;
+	}
+	return cOcr.SaveModel(modelPtr);
+}
+
+/**
+ *	@brief	設定訓練資料，轉存為對齊的連續特徵列
+ *	@param[in]	matLabels	樣本標籤 (N x 1, CV_32S)
+ *	@param[in]	matImages	樣本特徵 (N x 600, CV_32F)
+ *	@param[in]	quantize	是否量化為 8-bit
+ *	@return	<b>型別: bool</b> \n 若設定成功返回值為非零值 (true)。 \n 若資料格式錯誤返回值為零 (false)。
+ */
+bool CarPlateOcr::SetTraining(const cv::Mat& matLabels, const cv::Mat& matImages, bool quantize)
+{
+	const int features = CAR_OCR_CHAR_WD * CAR_OCR_CHAR_HT;
+
+	this->Release();
+	if (matImages.empty() || matImages.type() != CV_32FC1 || matImages.cols != features) {
+		return false;
+	}
+
+	if (matLabels.type() != CV_32SC1 || static_cast<int>(matLabels.total()) != matImages.rows) {
+		return false;
+	}
+
+	// 每列對齊至 CAR_OCR_ALIGN bytes，補齊部分填 0 (查詢列亦填 0，不影響距離)
+	const int elemSize = quantize ? 1 : static_cast<int>(sizeof(float));
+	const int align = CAR_OCR_ALIGN / elemSize;
+	const int stride = (features + align - 1) / align * align;
+
+	m_matTrain.create(matImages.rows, stride, quantize ? CV_8UC1 : CV_32FC1);
+	m_matTrain.setTo(cv::Scalar::all(0));
+	m_vecLabels.resize(static_cast<size_t>(matImages.rows));
+
+	for (int y = 0; y < matImages.rows; y++) {
+		const float* srcPtr = matImages.ptr<float>(y);
+		if (quantize) {
+			uint8_t* dstPtr = m_matTrain.ptr<uint8_t>(y);
+			for (int x = 0; x < features; x++) {
+				dstPtr[x] = cv::saturate_cast<uint8_t>(srcPtr[x]);
+			}
+		}
+		else {
+			::memcpy(m_matTrain.ptr<float>(y), srcPtr, sizeof(float) * features);
+		}
+		m_vecLabels[y] = matLabels.ptr<int>(0)[y];
+	}
+
+	m_nSamples = matImages.rows;
+	m_nFeatures = features;
+	m_nStride = stride;
+	m_labelPtr = m_vecLabels.data();
+	m_trainF32Ptr = quantize ? nullptr : m_matTrain.ptr<float>(0);
+	m_trainU8Ptr = quantize ? m_matTrain.ptr<uint8_t>(0) : nullptr;
+	return true;
+}
+
+/**
+ *	@brief	切割車牌區域內的字元
+ *	@param[in]	imgGrayscale	cv::Mat 物件參考，灰階影像。
+ *	@param[in]	roi				車牌區域
+ *	@param[out]	charPtr			(指標) 存放字元位置的緩衝區 (影像座標，由左至右排列)
+ *	@param[in]	maxChars		緩衝區可存放字元數量
+ *	@return	<b>型別: int</b> \n 切割出的字元數量
+ *	@remark	車牌區域以 Otsu 反向二值化，字元為白色、背景為黑色，與訓練資料相同。
+ */
+int CarPlateOcr::Segment(const cv::Mat& imgGrayscale, const cv::Rect& roi, CarOcrChar* charPtr, int maxChars)
+{
+	const cv::Rect rect = roi & cv::Rect(0, 0, imgGrayscale.cols, imgGrayscale.rows);
+	const int minHeight = rect.height * 35 / 100;
+	const int maxHeight = rect.height * 95 / 100;
+	cv::Rect chars[CAR_OCR_MAX_CHARS * 4];
+	int count = 0;
+
+	if (charPtr == nullptr || maxChars <= 0 || rect.width < CAR_OCR_CHAR_WD || rect.height < 8) {
+		return 0;
+	}
+
+	// 車牌尺寸每幀不同，使用緩衝區子區域避免重新配置
+	if (m_imgPlateBuffer.cols < rect.width || m_imgPlateBuffer.rows < rect.height) {
+		m_imgPlateBuffer.create(std::max(m_imgPlateBuffer.rows, rect.height), std::max(m_imgPlateBuffer.cols, rect.width), CV_8UC1);
+	}
+	m_imgPlate = m_imgPlateBuffer(cv::Rect(0, 0, rect.width, rect.height));
+	cv::threshold(imgGrayscale(rect), m_imgPlate, 0.0, 255.0, cv::THRESH_BINARY_INV | cv::THRESH_OTSU);
+	m_cLabeling.Labeling(m_imgPlate, m_cComponents);
+
+	// 挑選高度合理、直立且不貼齊車牌邊框的元件
+	const size_t components = m_cComponents.Count();
+	for (size_t i = 0; i < components && count < CAR_OCR_MAX_CHARS * 4; i++) {
+		const cv::Rect box = m_cComponents.Rect(i);
+		if (box.height < minHeight || box.height > maxHeight) continue;
+		if (box.width < 2 || box.width > box.height) continue;
+		if (box.x == 0 || box.y == 0 || box.br().x == rect.width || box.br().y == rect.height) continue;
+		chars[count++] = box;
+	}
+
+	std::sort(chars, chars + count, [](const cv::Rect& a, const cv::Rect& b) { return a.x < b.x; });
+
+	// 略過被前一字元包含的元件 (如 0、8 內部的孔洞雜訊)
+	int output = 0;
+	for (int i = 0; i < count && output < maxChars; i++) {
+		if (output > 0) {
+			const cv::Rect& prev = charPtr[output - 1].rect;
+			const cv::Rect box = chars[i] + rect.tl();
+			if ((prev & box).area() * 2 > box.area()) continue;
+		}
+
+		charPtr[output].rect = chars[i] + rect.tl();
+		charPtr[output].label = 0;
+		charPtr[output].confidence = 0.0f;
+		output++;
+	}
+	return output;
+}
+
+/**
+ *	@brief	辨識車牌區域文字
+ *	@param[in]	imgGrayscale	cv::Mat 物件參考，灰階影像。
+ *	@param[in]	roi				車牌區域
+ *	@param[out]	plateRead		CarPlateRead 結構參考，存放辨識結果。
+ *	@return	<b>型別: bool</b> \n 若辨識出至少一個字元返回值為非零值 (true)。 \n 否則返回值為零 (false)。
+ */
+bool CarPlateOcr::Recognize(const cv::Mat& imgGrayscale, const cv::Rect& roi, CarPlateRead& plateRead)
+{
+	const cv::Rect rect = roi & cv::Rect(0, 0, imgGrayscale.cols, imgGrayscale.rows);
+
+	plateRead.count = 0;
+	plateRead.confidence = 0.0f;
+	plateRead.text[0] = '\0';
+	if (!this->IsLoaded()) {
+		return false;
+	}
+
+	const int count = this->Segment(imgGrayscale, rect, plateRead.chars, CAR_OCR_MAX_CHARS);
+	float confidence = 1.0f;
+	for (int i = 0; i < count; i++) {
+		auto& item = plateRead.chars[i];
+		cv::resize(m_imgPlate(item.rect - rect.tl()), m_imgChar, cv::Size(CAR_OCR_CHAR_WD, CAR_OCR_CHAR_HT), 0, 0, cv::INTER_LINEAR);
+		item.label = this->Classify(m_imgChar, item.confidence);
+		plateRead.text[i] = item.label;
+		confidence = std::min(confidence, item.confidence);
+	}
+
+	plateRead.count = count;
+	plateRead.confidence = count > 0 ? confidence : 0.0f;
+	plateRead.text[count] = '\0';
+	return count > 0;
+}
+
+/**
+ *	@brief	以 k-NN 辨識單一字元
+ *	@param[in]	imgChar		cv::Mat 物件參考，20x30 字元影像 (CV_8UC1)。
+ *	@param[out]	confidence	信心值 (0 ~ 1)，最近鄰與其他字元最近距離的差距比例乘上投票比例。
+ *	@return	<b>型別: char</b> \n 辨識字元，若失敗返回值為零。
+ */
+char CarPlateOcr::Classify(const cv::Mat& imgChar, float& confidence)
+{
+	const int maxNeighbors = 16;
+	const int k = std::min(std::min(m_nNeighbors, maxNeighbors), m_nSamples);
+	float nearDist[maxNeighbors];
+	int nearLabel[maxNeighbors];
+	float labelDist[128];
+	int neighbors = 0;
+
+	confidence = 0.0f;
+	if (!this->IsLoaded() || imgChar.type() != CV_8UC1 || imgChar.total() != static_cast<size_t>(m_nFeatures)) {
+		return 0;
+	}
+
+	// 查詢列與訓練列相同型別與對齊長度
+	const bool quantize = m_trainU8Ptr != nullptr;
+	m_matQuery.create(1, m_nStride, quantize ? CV_8UC1 : CV_32FC1);
+	m_matQuery.setTo(cv::Scalar::all(0));
+	for (int y = 0; y < imgChar.rows; y++) {
+		const uint8_t* srcPtr = imgChar.ptr<uint8_t>(y);
+		if (quantize) {
+			::memcpy(m_matQuery.ptr<uint8_t>(0) + y * imgChar.cols, srcPtr, imgChar.cols);
+		}
+		else {
+			float* dstPtr = m_matQuery.ptr<float>(0) + y * imgChar.cols;
+			for (int x = 0; x < imgChar.cols; x++) dstPtr[x] = static_cast<float>(srcPtr[x]);
+		}
+	}
+
+	std::fill(labelDist, labelDist + 128, FLT_MAX);
+	for (int i = 0; i < m_nSamples; i++) {
+		const float dist = quantize
+			? DistanceU8(m_trainU8Ptr + static_cast<size_t>(i) * m_nStride, m_matQuery.ptr<uint8_t>(0), m_nStride)
+			: DistanceF32(m_trainF32Ptr + static_cast<size_t>(i) * m_nStride, m_matQuery.ptr<float>(0), m_nStride);
+		const int label = m_labelPtr[i] & 0x7F;
+
+		labelDist[label] = std::min(labelDist[label], dist);
+
+		// 插入排序維護最近的 k 個鄰居
+		if (neighbors < k || dist < nearDist[neighbors - 1]) {
+			int j = (neighbors < k) ? neighbors++ : neighbors - 1;
+			for (; j > 0 && nearDist[j - 1] > dist; j--) {
+				nearDist[j] = nearDist[j - 1];
+				nearLabel[j] = nearLabel[j - 1];
+			}
+			nearDist[j] = dist;
+			nearLabel[j] = label;
+		}
+	}
+
+	// 多數決，票數相同時取距離較近者 (鄰居已依距離排序)
+	int bestLabel = 0;
+	int bestVotes = 0;
+	for (int i = 0; i < neighbors; i++) {
+		int votes = 0;
+		for (int j = 0; j < neighbors; j++) {
+			if (nearLabel[j] == nearLabel[i]) votes++;
+		}
+		if (votes > bestVotes) {
+			bestVotes = votes;
+			bestLabel = nearLabel[i];
+		}
+	}
+
+	float otherDist = FLT_MAX;
+	for (int i = 0; i < 128; i++) {
+		if (i != bestLabel) otherDist = std::min(otherDist, labelDist[i]);
+	}
+
+	const float bestDist = labelDist[bestLabel];
+	const float margin = (otherDist == FLT_MAX) ? 1.0f : (otherDist - bestDist) / std::max(otherDist + bestDist, 1.0f);
+	confidence = std::max(0.0f, margin) * static_cast<float>(bestVotes) / static_cast<float>(neighbors);
+	return static_cast<char>(bestLabel);
+}
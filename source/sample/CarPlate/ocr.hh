@@ -0,0 +1,111 @@
+﻿/**************************************************************************//**
+ * @file	ocr.hh
+ * @brief	CarPlateOcr 車牌字元切割與辨識類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_OCR_HH
+#define	ODMC_CARPLATE_OCR_HH
+#include "labeling.hh"
+#include "mapfile.hh"
+
+#define CAR_OCR_MODEL_MAGIC		"ODMCOCR"	//!< 二進位模型識別碼 (含結尾 0 共 8 bytes)
+#define CAR_OCR_MODEL_VERSION	1			//!< 二進位模型版本
+
+/**
+ *	@struct	CarOcrChar
+ *	@brief	單一字元辨識結果
+ */
+struct CarOcrChar {
+	cv::Rect	rect;			//!< 字元於影像中的位置
+	char		label;			//!< 辨識字元 (ASCII)
+	float		confidence;		//!< 信心值 (0 ~ 1)
+};
+
+/**
+ *	@struct	CarPlateRead
+ *	@brief	車牌辨識結果 (固定大小，不需配置記憶體)
+ */
+struct CarPlateRead {
+	int			count;								//!< 字元數量
+	float		confidence;							//!< 車牌信心值 (各字元最低值)
+	char		text[CAR_OCR_MAX_CHARS + 1];		//!< 車牌文字 (以 '\0' 結尾)
+	CarOcrChar	chars[CAR_OCR_MAX_CHARS];			//!< 各字元辨識結果
+};
+
+/**
+ *	@struct	CarOcrModelHeader
+ *	@brief	OCR 二進位模型檔頭 (little-endian，64 bytes)
+ *	@remark	檔案配置: [檔頭][標籤 int32 x samples][補齊][特徵矩陣 samples x stride]，
+ *			特徵矩陣起始位置對齊 CAR_OCR_ALIGN bytes，可直接映射使用不需解析。
+ */
+struct CarOcrModelHeader {
+	char		magic[8];			//!< 識別碼 CAR_OCR_MODEL_MAGIC
+	uint32_t	version;			//!< 模型版本 CAR_OCR_MODEL_VERSION
+	uint32_t	headerSize;			//!< 檔頭大小 sizeof(CarOcrModelHeader)
+	uint32_t	samples;			//!< 樣本數量
+	uint32_t	features;			//!< 特徵長度 (charWidth x charHeight)
+	uint32_t	charWidth;			//!< 字元影像寬度
+	uint32_t	charHeight;			//!< 字元影像高度
+	uint32_t	elemSize;			//!< 特徵元素大小: 1 = uint8, 4 = float
+	uint32_t	stride;				//!< 特徵列長度 (元素數量，含補齊)
+	uint64_t	labelOffset;		//!< 標籤陣列起始位置 (bytes)
+	uint64_t	featureOffset;		//!< 特徵矩陣起始位置 (bytes)
+	uint64_t	fileSize;			//!< 檔案總長度 (bytes)
+};
+static_assert(sizeof(CarOcrModelHeader) == 64, "CarOcrModelHeader must be 64 bytes");
+
+/**
+ *	@class	CarPlateOcr
+ *	@brief	車牌字元切割與 k-NN 字元辨識
+ *	@remark	訓練資料為 20x30 字元影像展開後的特徵列，儲存為連續且對齊的列 (float 或 8-bit 量化)，
+ *			距離計算使用 OpenCV universal intrinsics 向量化。訓練資料可由 XML 解析載入，
+ *			或由二進位模型檔映射載入 (不需解析與配置記憶體)。
+ */
+class CarPlateOcr
+{
+public:
+	CarPlateOcr();
+	virtual ~CarPlateOcr();
+
+	bool LoadXml(const cv::String& classFile, const cv::String& imageFile, bool quantize = true);
+	bool LoadModel(const char* modelPtr);
+	bool SaveModel(const char* modelPtr) const;
+	static bool ConvertXml(const cv::String& classFile, const cv::String& imageFile, const char* modelPtr, bool quantize = true);
+	void Release();
+	bool IsLoaded() const { return m_nSamples > 0; }
+	void SetNeighbors(int k) { m_nNeighbors = std::max(1, k); }
+
+	int  Segment(const cv::Mat& imgGrayscale, const cv::Rect& roi, CarOcrChar* charPtr, int maxChars);
+	bool Recognize(const cv::Mat& imgGrayscale, const cv::Rect& roi, CarPlateRead& plateRead);
+	char Classify(const cv::Mat& imgChar, float& confidence);
+
+protected:
+	bool SetTraining(const cv::Mat& matLabels, const cv::Mat& matImages, bool quantize);
+
+private:
+	CarPlateOcr(const CarPlateOcr&) = delete;				//!< Disable copy construction
+	CarPlateOcr& operator=(const CarPlateOcr&) = delete;	//!< Disable assignment operator
+
+	int				m_nSamples;			//!< 訓練樣本數量
+	int				m_nFeatures;		//!< 特徵長度 (20 x 30)
+	int				m_nStride;			//!< 特徵列長度 (對齊後元素數量)
+	int				m_nNeighbors;		//!< k-NN 鄰居數量
+	const int*		m_labelPtr;			//!< 訓練樣本標籤
+	const float*	m_trainF32Ptr;		//!< 訓練特徵 (float)，量化時為 nullptr
+	const uint8_t*	m_trainU8Ptr;		//!< 訓練特徵 (8-bit 量化)，未量化時為 nullptr
+
+	std::vector<int> m_vecLabels;		//!< 訓練樣本標籤 (自行配置時使用)
+	cv::Mat			m_matTrain;			//!< 訓練特徵矩陣 (自行配置時使用)
+	CarMappedFile	m_cModelFile;		//!< 二進位模型映射檔 (映射載入時使用)
+
+	CarLabeling		m_cLabeling;		//!< 車牌區域連通元件標記
+	CarComponents	m_cComponents;		//!< 車牌區域連通元件統計資料
+	cv::Mat			m_imgPlateBuffer;	//!< 車牌區域二值化影像緩衝區 (只增大，不隨車牌尺寸重新配置)
+	cv::Mat			m_imgPlate;			//!< 車牌區域二值化影像 (緩衝區左上角子區域)
+	cv::Mat			m_imgChar;			//!< 字元縮放影像 (20 x 30)
+	cv::Mat			m_matQuery;			//!< 查詢特徵列 (對齊長度)
+};
+
+#endif // !ODMC_CARPLATE_OCR_HH
@@ -0,0 +1,215 @@
+﻿/**************************************************************************//**
+ * @file	preprocess.cc
+ * @brief	CarTiledPreprocess 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "preprocess.hh"
+#include "opencv2/core/hal/intrin.hpp"
+
+/**
+ *	@brief	CarTiledPreprocess 建構式
+ *	@return	此函數沒有返回值
+ */
+CarTiledPreprocess::CarTiledPreprocess()
+	: m_nTiles(0)
+	, m_nThreads(CAR_PARALLEL_THREADS) {
+	m_imgElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+}
+
+/**
+ *	@brief	CarTiledPreprocess 解構式
+ *	@return	此函數沒有返回值
+ */
+CarTiledPreprocess::~CarTiledPreprocess() {}
+
+/**
+ *	@brief	分塊完成搜尋區域內的所有預處理，區域外內容不更新。
+ *	@param[in]	imgFrame		cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[in]	regions			搜尋區域 (互不重疊)
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，存放灰階影像 (與原始影像同尺寸，字元辨識使用)。
+ *	@param[out]	imgThresh		cv::Mat 物件參考，存放二值化影像 (與原始影像同尺寸)。
+ *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若影像格式不符返回值為零 (false)。
+ */
+bool CarTiledPreprocess::Process(const cv::Mat& imgFrame, const std::vector<cv::Rect>& regions, cv::Mat& imgGrayscale, cv::Mat& imgThresh)
+{
+	if (imgFrame.empty() || imgFrame.type() != CV_8UC3) {
+		return false;
+	}
+	imgGrayscale.create(imgFrame.size(), CV_8UC1);
+	imgThresh.create(imgFrame.size(), CV_8UC1);
+
+	// 依列切割各搜尋區域 (區塊不跨區域，區域邊界即為濾波邊界)，區塊數量少於 thread 數量時縮小區塊使每個 thread 都有工作
+	const cv::Rect frameRect(cv::Point(), imgFrame.size());
+	const int threads = (m_nThreads > 0) ? m_nThreads : cv::getNumThreads();
+	m_nTiles = 0;
+	for (const auto& searchRegion : regions) {
+		const cv::Rect region = searchRegion & frameRect;
+		if (region.area() <= 0) continue;
+
+		const int bandRows = (region.height + threads - 1) / threads;
+		const int tileRows = std::min(CarTiledPreprocess::GetTileRows(region.width), std::max(bandRows, CAR_TILE_MIN_ROWS));
+		for (int y = region.y; y < region.y + region.height; y += tileRows) {
+			if (m_nTiles == m_vecTiles.size()) {
+				m_vecTiles.emplace_back();
+			}
+			auto& tile = m_vecTiles[m_nTiles++];
+			tile.region = region;
+			tile.rowBegin = y;
+			tile.rowEnd = std::min(y + tileRows, region.y + region.height);
+		}
+	}
+
+	// 連續區塊合併為 threads 個列帶 (nstripes)，每個 thread 處理畫面中相鄰的列
+	const int tiles = static_cast<int>(m_nTiles);
+	if (threads <= 1 || tiles <= 1) {
+		for (int i = 0; i < tiles; i++) {
+			this->ProcessTile(imgFrame, m_vecTiles[i], imgGrayscale, imgThresh);
+		}
+		return true;
+	}
+
+	cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; i++) {
+			this->ProcessTile(imgFrame, m_vecTiles[i], imgGrayscale, imgThresh);
+		}
+	}, static_cast<double>(std::min(threads, tiles)));
+	return true;
+}
+
+/**
+ *	@brief	依區域寬度計算每個區塊的輸出列數，使包含重疊列的工作集不超過 CAR_TILE_CACHE_BYTES。
+ *	@param[in]	width	區域寬度 (pixel)
+ *	@return	<b>型別: int</b> \n 區塊輸出列數 (至少 CAR_TILE_MIN_ROWS)
+ */
+int CarTiledPreprocess::GetTileRows(int width)
+{
+	const int rows = CAR_TILE_CACHE_BYTES / (std::max(width, 1) * CAR_TILE_PIXEL_BYTES) - CAR_TILE_HALO * 2;
+	return std::max(rows, CAR_TILE_MIN_ROWS);
+}
+
+/**
+ *	@brief	處理單一區塊: 讀取含重疊列的範圍，依序完成所有步驟後寫出區塊本身的列。
+ *	@param[in]	imgFrame		cv::Mat 物件參考，原始影像 (BGR)。
+ *	@param[in]	tile			Tile 結構參考，區塊範圍與暫存影像。
+ *	@param[out]	imgGrayscale	cv::Mat 物件參考，灰階影像 (只寫入區塊列)。
+ *	@param[out]	imgThresh		cv::Mat 物件參考，二值化影像 (只寫入區塊列)。
+ *	@return	此函數沒有返回值
+ *	@remark	各步驟於重疊列邊界產生的誤差最多向內傳遞 CAR_TILE_HALO 列 (對比 2 列、平滑化與自適應閥值各為核心半徑)，
+ *			寫出的列不受影響。自適應閥值與 cv::adaptiveThreshold (ADAPTIVE_THRESH_GAUSSIAN_C、THRESH_BINARY_INV) 相同，
+ *			區域平均 (float 高斯加權後四捨五入) 寫入區塊暫存影像，不於每次呼叫配置。
+ */
+void CarTiledPreprocess::ProcessTile(const cv::Mat& imgFrame, Tile& tile, cv::Mat& imgGrayscale, cv::Mat& imgThresh) const
+{
+	const auto& region = tile.region;
+	const int top = std::max(region.y, tile.rowBegin - CAR_TILE_HALO);
+	const int bottom = std::min(region.y + region.height, tile.rowEnd + CAR_TILE_HALO);
+	const cv::Rect input(region.x, top, region.width, bottom - top);
+	const cv::Size size = input.size();
+
+	cv::Mat imgGray = CarTiledPreprocess::View(tile.imgGrayscale, size);
+	cv::Mat imgTophat = CarTiledPreprocess::View(tile.imgTophat, size);
+	cv::Mat imgBlackhat = CarTiledPreprocess::View(tile.imgBlackhat, size);
+	cv::Mat imgContrast = CarTiledPreprocess::View(tile.imgContrast, size);
+	cv::Mat imgBlurred = CarTiledPreprocess::View(tile.imgBlurred, size);
+	cv::Mat imgFloat = CarTiledPreprocess::View(tile.imgFloat, size, CV_32FC1);
+	cv::Mat imgMeanFloat = CarTiledPreprocess::View(tile.imgMeanFloat, size, CV_32FC1);
+	cv::Mat imgMean = CarTiledPreprocess::View(tile.imgMean, size);
+	cv::Mat imgBinary = CarTiledPreprocess::View(tile.imgThresh, size);
+
+	// 灰階與提高對比 (top-hat 加上原圖再減去 black-hat)
+	cv::cvtColor(imgFrame(input), imgGray, cv::COLOR_BGR2GRAY);
+	cv::morphologyEx(imgGray, imgTophat, cv::MORPH_TOPHAT, m_imgElement, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+	cv::morphologyEx(imgGray, imgBlackhat, cv::MORPH_BLACKHAT, m_imgElement, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+	cv::add(imgGray, imgTophat, imgContrast);
+	cv::subtract(imgContrast, imgBlackhat, imgContrast);
+
+	// 平滑化與自適應閥值 (區域平均與 cv::adaptiveThreshold 相同，以 float 計算後四捨五入)
+	cv::GaussianBlur(imgContrast, imgBlurred, cv::Size(CAR_PLATE_BLUE_WD, CAR_PLATE_BLUE_HT), 0, 0, cv::BORDER_DEFAULT | cv::BORDER_ISOLATED);
+	imgBlurred.convertTo(imgFloat, CV_32F);
+	cv::GaussianBlur(imgFloat, imgMeanFloat, cv::Size(CAR_PLATE_THRESH_BLOCK_SIZE, CAR_PLATE_THRESH_BLOCK_SIZE), 0, 0, cv::BORDER_REPLICATE | cv::BORDER_ISOLATED);
+	imgMeanFloat.convertTo(imgMean, CV_8U);
+
+	const int rowOffset = tile.rowBegin - top;
+	const int rows = tile.rowEnd - tile.rowBegin;
+	const int delta = static_cast<int>(std::floor(static_cast<double>(CAR_PLATE_THRESH_WEIGHT)));
+	for (int y = 0; y < rows; y++) {
+		CarTiledPreprocess::ThresholdRow(imgBlurred.ptr<uint8_t>(rowOffset + y), imgMean.ptr<uint8_t>(rowOffset + y), imgBinary.ptr<uint8_t>(rowOffset + y), size.width, delta);
+	}
+
+	// 只寫出區塊本身的列 (各區塊寫入範圍互不重疊)
+	const cv::Rect core(0, rowOffset, size.width, rows);
+	const cv::Rect output(region.x, tile.rowBegin, size.width, rows);
+	imgGray(core).copyTo(imgGrayscale(output));
+	imgBinary(core).copyTo(imgThresh(output));
+}
+
+/**
+ *	@brief	取得緩衝區左上角指定尺寸的子區域，緩衝區不足時增大 (不縮小)。
+ *	@param[in,out]	imgBuffer	cv::Mat 物件參考，單通道緩衝區。
+ *	@param[in]		size		子區域尺寸
+ *	@param[in]		type		緩衝區格式
+ *	@return	<b>型別: cv::Mat</b> \n 子區域 (與緩衝區共用記憶體)
+ */
+cv::Mat CarTiledPreprocess::View(cv::Mat& imgBuffer, const cv::Size& size, int type)
+{
+	if (imgBuffer.cols < size.width || imgBuffer.rows < size.height || imgBuffer.type() != type) {
+		imgBuffer.create(std::max(imgBuffer.rows, size.height), std::max(imgBuffer.cols, size.width), type);
+	}
+	return imgBuffer(cv::Rect(cv::Point(), size));
+}
+
+/**
+ *	@brief	自適應閥值 (與 cv::adaptiveThreshold 的 ADAPTIVE_THRESH_GAUSSIAN_C、THRESH_BINARY_INV 結果相同)
+ *	@param[in]	imgBlurred		cv::Mat 物件參考，平滑化影像 (8-bit，可為子區域，以子區域邊界為影像邊界)。
+ *	@param[out]	imgFloat		cv::Mat 物件參考，平滑化影像 (float) 暫存，與平滑化影像同尺寸。
+ *	@param[out]	imgMeanFloat	cv::Mat 物件參考，區域平均 (float) 暫存，與平滑化影像同尺寸。
+ *	@param[out]	imgMean			cv::Mat 物件參考，區域平均 (8-bit) 暫存，與平滑化影像同尺寸。
+ *	@param[out]	imgThresh		cv::Mat 物件參考，二值化結果，與平滑化影像同尺寸。
+ *	@return	此函數沒有返回值
+ *	@remark	與區塊處理相同的計算 (區域平均以 float 高斯加權後四捨五入)，暫存影像由呼叫端提供，不於每次呼叫配置。
+ *			供分段處理路徑使用；區塊處理只對輸出列進行二值化，直接呼叫 ThresholdRow。
+ */
+void CarTiledPreprocess::AdaptiveThreshold(const cv::Mat& imgBlurred, cv::Mat& imgFloat, cv::Mat& imgMeanFloat, cv::Mat& imgMean, cv::Mat& imgThresh)
+{
+	imgBlurred.convertTo(imgFloat, CV_32F);
+	cv::GaussianBlur(imgFloat, imgMeanFloat, cv::Size(CAR_PLATE_THRESH_BLOCK_SIZE, CAR_PLATE_THRESH_BLOCK_SIZE), 0, 0, cv::BORDER_REPLICATE | cv::BORDER_ISOLATED);
+	imgMeanFloat.convertTo(imgMean, CV_8U);
+
+	const int delta = static_cast<int>(std::floor(static_cast<double>(CAR_PLATE_THRESH_WEIGHT)));
+	for (int y = 0; y < imgBlurred.rows; y++) {
+		CarTiledPreprocess::ThresholdRow(imgBlurred.ptr<uint8_t>(y), imgMean.ptr<uint8_t>(y), imgThresh.ptr<uint8_t>(y), imgBlurred.cols, delta);
+	}
+}
+
+/**
+ *	@brief	自適應閥值一列 (THRESH_BINARY_INV): 區域平均減去 pixel 值不小於 delta 時為 255，否則為 0。
+ *	@param[in]	srcPtr	平滑化影像
+ *	@param[in]	meanPtr	區域平均 (高斯加權)
+ *	@param[out]	dstPtr	二值化結果
+ *	@param[in]	len		像素數量
+ *	@param[in]	delta	閥值偏移 (cv::adaptiveThreshold 的 C 取 floor)
+ *	@return	此函數沒有返回值
+ */
+void CarTiledPreprocess::ThresholdRow(const uint8_t* srcPtr, const uint8_t* meanPtr, uint8_t* dstPtr, int len, int delta)
+{
+	int i = 0;
+
+#if CV_SIMD
+	// 飽和減法只在 delta > 0 時與整數比較相同 (mean < src 時結果為 0，不會達到門檻)
+	if (delta > 0 && delta <= 255) {
+		const int lanes = cv::v_uint8::nlanes;
+		const cv::v_uint8 vLimit = cv::vx_setall_u8(static_cast<uint8_t>(delta - 1));
+		for (; i <= len - lanes; i += lanes) {
+			const cv::v_uint8 diff = cv::vx_load(meanPtr + i) - cv::vx_load(srcPtr + i);
+			cv::v_store(dstPtr + i, diff > vLimit);
+		}
+		cv::vx_cleanup();
+	}
+#endif
+
+	for (; i < len; i++) {
+		dstPtr[i] = (meanPtr[i] - srcPtr[i] >= delta) ? 255 : 0;
+	}
+}
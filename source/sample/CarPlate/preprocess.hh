@@ -0,0 +1,71 @@
+﻿/**************************************************************************//**
+ * @file	preprocess.hh
+ * @brief	CarTiledPreprocess 分塊融合預處理類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_PREPROCESS_HH
+#define	ODMC_CARPLATE_PREPROCESS_HH
+#include "carcore.hh"
+
+/**
+ *	@class	CarTiledPreprocess
+ *	@brief	分塊融合預處理 (灰階、提高對比、平滑化、自適應閥值)
+ *	@remark	搜尋區域依列切割為工作集約為 L2 快取大小的區塊，每個區塊上下各多讀取 CAR_TILE_HALO 列，
+ *			依序完成所有預處理步驟後只寫出區塊本身的灰階與二值化結果，中間影像不離開快取。
+ *			各區塊平行處理 (cv::parallel_for_)，每個區塊持有只增大的暫存影像，解析度不變時不配置記憶體。
+ *			連續的區塊合併為與 thread 數量 (SetThreads) 相同的水平列帶分配給各 thread，區塊不足時縮小區塊列數，
+ *			單一高解析度串流的每幀處理時間隨 thread 數量縮短；1 = 於呼叫端 thread 依序處理。
+ *			區塊邊界以重疊列吸收各步驟的邊界效應，搜尋區域邊界與分段處理相同視為影像邊界，
+ *			使用相同的 OpenCV 濾波函數時結果與分段處理 (ImageGrayscale、ImageContrast、ImageThreshold) 完全相同；
+ *			OpenCV 依影像尺寸改用 IPP / OpenCL 實作時平滑化結果可能相差 1 階，只影響閥值邊緣的少數 pixel。
+ */
+class CarTiledPreprocess
+{
+public:
+	CarTiledPreprocess();
+	virtual ~CarTiledPreprocess();
+
+	bool Process(const cv::Mat& imgFrame, const std::vector<cv::Rect>& regions, cv::Mat& imgGrayscale, cv::Mat& imgThresh);
+
+	size_t GetTileCount() const { return m_nTiles; }
+	void SetThreads(int threads) { m_nThreads = std::max(threads, 0); }
+	int GetThreads() const { return m_nThreads; }
+	static int GetTileRows(int width);
+	static void AdaptiveThreshold(const cv::Mat& imgBlurred, cv::Mat& imgFloat, cv::Mat& imgMeanFloat, cv::Mat& imgMean, cv::Mat& imgThresh);
+	static void ThresholdRow(const uint8_t* srcPtr, const uint8_t* meanPtr, uint8_t* dstPtr, int len, int delta);
+
+private:
+	CarTiledPreprocess(const CarTiledPreprocess&) = delete;				//!< Disable copy construction
+	CarTiledPreprocess& operator=(const CarTiledPreprocess&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Tile
+	 *	@brief	單一區塊範圍與暫存影像
+	 */
+	struct Tile {
+		cv::Rect	region;			//!< 所屬搜尋區域 (影像座標)
+		int			rowBegin;		//!< 輸出起始列 (包含)
+		int			rowEnd;			//!< 輸出結束列 (不包含)
+		cv::Mat		imgGrayscale;	//!< 灰階影像緩衝區
+		cv::Mat		imgTophat;		//!< top-hat 緩衝區
+		cv::Mat		imgBlackhat;	//!< black-hat 緩衝區
+		cv::Mat		imgContrast;	//!< 提高對比緩衝區
+		cv::Mat		imgBlurred;		//!< 平滑化緩衝區
+		cv::Mat		imgFloat;		//!< 平滑化影像 (float) 緩衝區
+		cv::Mat		imgMeanFloat;	//!< 自適應閥值區域平均 (float) 緩衝區
+		cv::Mat		imgMean;		//!< 自適應閥值區域平均緩衝區
+		cv::Mat		imgThresh;		//!< 二值化緩衝區
+	};
+
+	void ProcessTile(const cv::Mat& imgFrame, Tile& tile, cv::Mat& imgGrayscale, cv::Mat& imgThresh) const;
+	static cv::Mat View(cv::Mat& imgBuffer, const cv::Size& size, int type = CV_8UC1);
+
+	std::vector<Tile>	m_vecTiles;		//!< 區塊 (只增加，保留暫存影像)
+	size_t				m_nTiles;		//!< 此幀使用的區塊數量
+	int					m_nThreads;		//!< 平行處理 thread 數量上限，0 = 所有核心
+	cv::Mat				m_imgElement;	//!< 形態學運算結構元素 (3 x 3)
+};
+
+#endif // !ODMC_CARPLATE_PREPROCESS_HH
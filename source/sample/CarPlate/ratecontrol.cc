@@ -0,0 +1,105 @@
+﻿/**************************************************************************//**
+ * @file	ratecontrol.cc
+ * @brief	CarRateController 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "ratecontrol.hh"
+
+/**
+ *	@brief	CarRateController 建構式
+ *	@return	此函數沒有返回值
+ */
+CarRateController::CarRateController()
+	: m_sOptions()
+	, m_fCost(0.0)
+	, m_fWork(0.0)
+	, m_fLatency(0.0)
+	, m_fBackoff(1.0)
+	, m_isSampled(false)
+	, m_nInterval(0) {
+}
+
+/**
+ *	@brief	CarRateController 解構式
+ *	@return	此函數沒有返回值
+ */
+CarRateController::~CarRateController() {}
+
+/**
+ *	@brief	設定速率控制選項並清除量測資料 (不可與 Update 同時呼叫)
+ *	@param[in]	options	速率控制選項
+ *	@return	此函數沒有返回值
+ */
+void CarRateController::SetOptions(const CarRateOptions& options)
+{
+	m_sOptions = options;
+	m_sOptions.utilization = std::min(std::max(options.utilization, 0.0), 1.0);
+	m_sOptions.latencyMs = std::max(options.latencyMs, 0);
+	m_sOptions.minIntervalMs = std::max(options.minIntervalMs, 0);
+	m_sOptions.maxIntervalMs = std::max(options.maxIntervalMs, m_sOptions.minIntervalMs);
+	this->Reset();
+}
+
+/**
+ *	@brief	清除量測資料，處理間隔回到最小間隔 (不可與 Update 同時呼叫)
+ *	@return	此函數沒有返回值
+ */
+void CarRateController::Reset()
+{
+	m_fCost = 0.0;
+	m_fWork = 0.0;
+	m_fLatency = 0.0;
+	m_fBackoff = 1.0;
+	m_isSampled = false;
+	m_nInterval.store(static_cast<int64_t>(m_sOptions.minIntervalMs) * 1000, std::memory_order_relaxed);
+}
+
+/**
+ *	@brief	加入一幀量測資料並重新計算處理間隔 (由輸出端 thread 呼叫)
+ *	@param[in]	cost	此幀處理成本 (瓶頸節點處理時間)
+ *	@param[in]	work	此幀各節點處理時間總和
+ *	@param[in]	latency	此幀端到端延遲 (由來源取出至處理完成)
+ *	@return	此函數沒有返回值
+ */
+void CarRateController::Update(std::chrono::steady_clock::duration cost, std::chrono::steady_clock::duration work, std::chrono::steady_clock::duration latency)
+{
+	if (!this->IsEnabled()) {
+		return;
+	}
+
+	const double costUs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(cost).count());
+	const double workUs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(work).count());
+	const double latencyUs = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+
+	// 第一筆資料直接作為平均值，避免啟動時由 0 緩慢爬升
+	if (!m_isSampled) {
+		m_fCost = costUs;
+		m_fWork = workUs;
+		m_fLatency = latencyUs;
+		m_isSampled = true;
+	}
+	else {
+		m_fCost += (costUs - m_fCost) * CAR_RATE_COST_ALPHA;
+		m_fWork += (workUs - m_fWork) * CAR_RATE_COST_ALPHA;
+		m_fLatency += (latencyUs - m_fLatency) * CAR_RATE_LATENCY_ALPHA;
+	}
+
+	// 延遲超過上限且排隊等待超過一幀處理成本時倍數放大間隔；低於上限一定比例或已無排隊時逐步恢復
+	if (m_sOptions.latencyMs > 0) {
+		const double budgetUs = m_sOptions.latencyMs * 1000.0;
+		const bool isQueued = (m_fLatency - m_fWork) > m_fCost;
+		if (m_fLatency > budgetUs && isQueued) {
+			m_fBackoff = std::min(m_fBackoff * CAR_RATE_BACKOFF, CAR_RATE_BACKOFF_MAX);
+		}
+		else if (m_fLatency < budgetUs * CAR_RATE_RECOVER_LEVEL || !isQueued) {
+			m_fBackoff = std::max(m_fBackoff * CAR_RATE_RECOVER, 1.0);
+		}
+	}
+
+	const double minUs = m_sOptions.minIntervalMs * 1000.0;
+	const double maxUs = m_sOptions.maxIntervalMs * 1000.0;
+	const double intervalUs = m_fCost / m_sOptions.utilization * m_fBackoff;
+	m_nInterval.store(static_cast<int64_t>(std::min(std::max(intervalUs, minUs), maxUs)), std::memory_order_relaxed);
+}
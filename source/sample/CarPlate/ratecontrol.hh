@@ -0,0 +1,68 @@
+﻿/**************************************************************************//**
+ * @file	ratecontrol.hh
+ * @brief	CarRateController 依處理成本調整偵測間隔的回授控制類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_RATECONTROL_HH
+#define	ODMC_CARPLATE_RATECONTROL_HH
+#include "carcore.hh"
+
+/**
+ *	@struct	CarRateOptions
+ *	@brief	偵測速率控制選項
+ */
+struct CarRateOptions {
+	double	utilization;	//!< 目標使用率 (瓶頸節點忙碌時間比例，0 ~ 1)，0 = 不控制 (只套用最小間隔)
+	int		latencyMs;		//!< 端到端延遲上限 (ms)，超過時放慢處理速率，0 = 不限制
+	int		minIntervalMs;	//!< 最小處理間隔 (ms)，0 = 有餘裕時處理每一幀
+	int		maxIntervalMs;	//!< 最大處理間隔 (ms)，負載過高時至少以此間隔處理
+
+	CarRateOptions()
+		: utilization(0.0)
+		, latencyMs(0)
+		, minIntervalMs(0)
+		, maxIntervalMs(CAR_RATE_MAX_INTERVAL_MS) {
+	}
+};
+
+/**
+ *	@class	CarRateController
+ *	@brief	偵測速率回授控制
+ *	@remark	以指數移動平均估計每幀處理成本 (瓶頸節點處理時間) 與端到端延遲，處理間隔 = 成本 / 目標使用率，
+ *			瓶頸節點保留閒置時間，佇列不會累積。延遲超過上限且主要來自排隊等待 (而非處理本身) 時
+ *			間隔每幀放大 CAR_RATE_BACKOFF 倍，恢復後每幀將放大倍數縮小為 CAR_RATE_RECOVER 倍直到 1
+ *			(放大與縮回都是乘法，MIMD)；處理時間本身已超過上限時放大間隔無助於延遲，不會放大。
+ *			處理速度快於影像來源時間隔小於幀間隔，每一幀都會處理；負載過高時依比例跳幀而不是落後。
+ *			Update 只能由單一 thread 呼叫，GetInterval 可由任何 thread 呼叫。
+ */
+class CarRateController
+{
+public:
+	CarRateController();
+	virtual ~CarRateController();
+
+	void SetOptions(const CarRateOptions& options);
+	void Reset();
+	void Update(std::chrono::steady_clock::duration cost, std::chrono::steady_clock::duration work, std::chrono::steady_clock::duration latency);
+
+	bool IsEnabled() const { return m_sOptions.utilization > 0.0; }
+	std::chrono::microseconds GetInterval() const { return std::chrono::microseconds(m_nInterval.load(std::memory_order_relaxed)); }
+	double GetCostMs() const { return m_fCost / 1000.0; }
+	double GetLatencyMs() const { return m_fLatency / 1000.0; }
+
+private:
+	CarRateController(const CarRateController&) = delete;				//!< Disable copy construction
+	CarRateController& operator=(const CarRateController&) = delete;	//!< Disable assignment operator
+
+	CarRateOptions			m_sOptions;			//!< 速率控制選項
+	double					m_fCost;			//!< 每幀處理成本平均值 (us)
+	double					m_fWork;			//!< 每幀各節點處理時間總和平均值 (us)
+	double					m_fLatency;			//!< 端到端延遲平均值 (us)
+	double					m_fBackoff;			//!< 延遲超過上限時的間隔倍數 (>= 1)
+	bool					m_isSampled;		//!< 是否已有量測資料
+	std::atomic<int64_t>	m_nInterval;		//!< 目前處理間隔 (us)
+};
+
+#endif // !ODMC_CARPLATE_RATECONTROL_HH
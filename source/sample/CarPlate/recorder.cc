@@ -0,0 +1,139 @@
+﻿/**************************************************************************//**
+ * @file	recorder.cc
+ * @brief	CarFrameRecorder 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "recorder.hh"
+
+/**
+ *	@brief	CarFrameRecorder 建構式
+ *	@return	此函數沒有返回值
+ */
+CarFrameRecorder::CarFrameRecorder()
+	: m_filePtr(nullptr) {
+	::memset(&m_sHeader, 0, sizeof(m_sHeader));
+}
+
+/**
+ *	@brief	CarFrameRecorder 解構式
+ *	@return	此函數沒有返回值
+ */
+CarFrameRecorder::~CarFrameRecorder() { this->Close(); }
+
+/**
+ *	@brief	建立錄製檔並寫入檔頭 (影像規格於第一幀寫入時決定)
+ *	@param[in]	pathPtr	(指標) 錄製檔路徑
+ *	@return	<b>型別: bool</b> \n 若建立成功返回值為非零值 (true)。 \n 若建立失敗返回值為零 (false)。
+ */
+bool CarFrameRecorder::Open(const char* pathPtr)
+{
+	this->Close();
+	if (pathPtr == nullptr) {
+		return false;
+	}
+
+	::memset(&m_sHeader, 0, sizeof(m_sHeader));
+	::memcpy(m_sHeader.magic, CAR_RECORD_MAGIC, sizeof(m_sHeader.magic));
+	m_sHeader.version = CAR_RECORD_VERSION;
+	m_sHeader.headerSize = sizeof(CarRecordHeader);
+	m_sHeader.dataOffset = sizeof(CarRecordHeader);
+
+	for (;;) {
+		if ((m_filePtr = ::fopen(pathPtr, "wb")) == nullptr) break;
+		if (::fwrite(&m_sHeader, sizeof(m_sHeader), 1, m_filePtr) != 1) break;
+		return true;
+	}
+
+	if (m_filePtr != nullptr) {
+		::fclose(m_filePtr);
+		m_filePtr = nullptr;
+	}
+	return false;
+}
+
+/**
+ *	@brief	寫入一幀影像與其幀序、時間戳記
+ *	@param[in]	frame	影像緩衝區 handle (未附加幀序時以錄製順序與 0 代替)
+ *	@return	<b>型別: bool</b> \n 若寫入成功返回值為非零值 (true)。 \n 若尚未開啟、影像規格與錄製檔不同或寫入失敗返回值為零 (false)。
+ */
+bool CarFrameRecorder::Write(const CarFrame& frame)
+{
+	static const uint8_t zeros[CAR_RECORD_ALIGN] = { 0 };
+	const auto& img = frame.Image();
+
+	if (m_filePtr == nullptr || img.empty() || img.dims != 2) {
+		return false;
+	}
+
+	// 第一幀決定錄製檔影像規格
+	const uint64_t rowBytes = static_cast<uint64_t>(img.cols) * img.elemSize();
+	if (m_sHeader.recordSize == 0) {
+		m_sHeader.width = static_cast<uint32_t>(img.cols);
+		m_sHeader.height = static_cast<uint32_t>(img.rows);
+		m_sHeader.type = static_cast<uint32_t>(img.type());
+		m_sHeader.frameBytes = static_cast<uint32_t>(rowBytes * img.rows);
+		m_sHeader.recordSize = CarFrameRecorder::GetRecordSize(m_sHeader.frameBytes);
+	}
+	else if (m_sHeader.width != static_cast<uint32_t>(img.cols) || m_sHeader.height != static_cast<uint32_t>(img.rows) || m_sHeader.type != static_cast<uint32_t>(img.type())) {
+		return false;
+	}
+
+	CarRecordFrame info;
+	info.index = frame.IsStamped() ? frame.Index() : m_sHeader.frames;
+	info.timestampMs = frame.IsStamped() ? frame.TimestampMs() : 0.0;
+
+	const uint64_t infoBytes = CarFrameRecorder::GetRecordSize(0);
+	const auto infoPadding = static_cast<size_t>(infoBytes - sizeof(CarRecordFrame));
+	const auto dataPadding = static_cast<size_t>(m_sHeader.recordSize - infoBytes - m_sHeader.frameBytes);
+	for (;;) {
+		if (::fwrite(&info, sizeof(info), 1, m_filePtr) != 1) break;
+		if (infoPadding > 0 && ::fwrite(zeros, infoPadding, 1, m_filePtr) != 1) break;
+		if (img.isContinuous()) {
+			if (::fwrite(img.data, static_cast<size_t>(m_sHeader.frameBytes), 1, m_filePtr) != 1) break;
+		}
+		else {
+			int y = 0;
+			for (; y < img.rows; y++) {
+				if (::fwrite(img.ptr(y), static_cast<size_t>(rowBytes), 1, m_filePtr) != 1) break;
+			}
+			if (y < img.rows) break;
+		}
+		if (dataPadding > 0 && ::fwrite(zeros, dataPadding, 1, m_filePtr) != 1) break;
+
+		m_sHeader.frames++;
+		return true;
+	}
+
+	// 寫入失敗 (磁碟已滿)，停止錄製並保留已完整寫入的幀
+	this->Close();
+	return false;
+}
+
+/**
+ *	@brief	更新檔頭幀數並關閉錄製檔
+ *	@return	<b>型別: bool</b> \n 若關閉成功返回值為非零值 (true)。 \n 若尚未開啟或寫入失敗返回值為零 (false)。
+ */
+bool CarFrameRecorder::Close()
+{
+	if (m_filePtr == nullptr) {
+		return false;
+	}
+
+	bool okey = ::fseek(m_filePtr, 0, SEEK_SET) == 0 && ::fwrite(&m_sHeader, sizeof(m_sHeader), 1, m_filePtr) == 1;
+	okey = (::fclose(m_filePtr) == 0) && okey;
+	m_filePtr = nullptr;
+	return okey;
+}
+
+/**
+ *	@brief	計算每幀紀錄大小 (幀資訊與影像資料各自補齊至 CAR_RECORD_ALIGN)
+ *	@param[in]	frameBytes	每幀影像資料大小 (bytes)
+ *	@return	<b>型別: uint64_t</b> \n 每幀紀錄大小 (bytes)
+ */
+uint64_t CarFrameRecorder::GetRecordSize(uint64_t frameBytes)
+{
+	const uint64_t infoBytes = (sizeof(CarRecordFrame) + CAR_RECORD_ALIGN - 1) / CAR_RECORD_ALIGN * CAR_RECORD_ALIGN;
+	return infoBytes + (frameBytes + CAR_RECORD_ALIGN - 1) / CAR_RECORD_ALIGN * CAR_RECORD_ALIGN;
+}
@@ -0,0 +1,74 @@
+﻿/**************************************************************************//**
+ * @file	recorder.hh
+ * @brief	CarFrameRecorder 影像錄製類別與錄製檔格式宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_RECORDER_HH
+#define	ODMC_CARPLATE_RECORDER_HH
+#include "framepool.hh"
+
+#define CAR_RECORD_MAGIC		"ODMCREC"	//!< 錄製檔識別碼 (含結尾 0 共 8 bytes)
+#define CAR_RECORD_VERSION		1			//!< 錄製檔版本
+#define CAR_RECORD_ALIGN		64			//!< 錄製檔各幀影像資料起始位置對齊 (bytes)
+
+/**
+ *	@struct	CarRecordHeader
+ *	@brief	錄製檔檔頭 (little-endian，64 bytes)
+ *	@remark	檔案配置: [檔頭][幀 0][幀 1]...，每幀為 [CarRecordFrame][補齊至 CAR_RECORD_ALIGN][影像資料][補齊]，
+ *			所有幀大小相同 (recordSize)，第 i 幀位於 dataOffset + i x recordSize，可直接映射隨機存取。
+ *			frames 為 0 時 (錄製未正常結束) 由檔案大小推算幀數。
+ */
+struct CarRecordHeader {
+	char		magic[8];			//!< 識別碼 CAR_RECORD_MAGIC
+	uint32_t	version;			//!< 錄製檔版本 CAR_RECORD_VERSION
+	uint32_t	headerSize;			//!< 檔頭大小 sizeof(CarRecordHeader)
+	uint32_t	width;				//!< 影像寬度
+	uint32_t	height;				//!< 影像高度
+	uint32_t	type;				//!< 影像型別 (OpenCV type，如 CV_8UC3)
+	uint32_t	frameBytes;			//!< 每幀影像資料大小 (bytes，連續儲存不含列補齊)
+	uint64_t	recordSize;			//!< 每幀紀錄大小 (bytes，CAR_RECORD_ALIGN 倍數)
+	uint64_t	frames;				//!< 幀數，0 = 由檔案大小推算
+	uint64_t	dataOffset;			//!< 第一幀起始位置 (bytes)
+	uint64_t	reserved;			//!< 保留 (0)
+};
+static_assert(sizeof(CarRecordHeader) == 64, "CarRecordHeader must be 64 bytes");
+
+/**
+ *	@struct	CarRecordFrame
+ *	@brief	錄製檔每幀資訊 (位於每幀紀錄起始位置)
+ */
+struct CarRecordFrame {
+	uint64_t	index;				//!< 來源幀序
+	double		timestampMs;		//!< 擷取時間戳記 (ms)
+};
+
+/**
+ *	@class	CarFrameRecorder
+ *	@brief	將擷取的原始影像與時間戳記依序寫入錄製檔，供 CarReplaySource 重播
+ *	@remark	錄製檔只保存單一影像規格，第一幀決定規格，之後規格不同的影像不寫入 (串流重新連接後解析度改變)。
+ */
+class CarFrameRecorder
+{
+public:
+	CarFrameRecorder();
+	virtual ~CarFrameRecorder();
+
+	bool Open(const char* pathPtr);
+	bool Write(const CarFrame& frame);
+	bool Close();
+	bool IsOpened() const { return m_filePtr != nullptr; }
+	uint64_t GetFrames() const { return m_sHeader.frames; }
+
+	static uint64_t GetRecordSize(uint64_t frameBytes);
+
+private:
+	CarFrameRecorder(const CarFrameRecorder&) = delete;				//!< Disable copy construction
+	CarFrameRecorder& operator=(const CarFrameRecorder&) = delete;	//!< Disable assignment operator
+
+	FILE*			m_filePtr;		//!< 錄製檔
+	CarRecordHeader	m_sHeader;		//!< 錄製檔檔頭 (第一幀寫入時決定影像規格)
+};
+
+#endif // !ODMC_CARPLATE_RECORDER_HH
@@ -0,0 +1,177 @@
+﻿/**************************************************************************//**
+ * @file	reorder.hh
+ * @brief	CarReorderBuffer 依序號重新排序緩衝區樣板 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_REORDER_HH
+#define	ODMC_CARPLATE_REORDER_HH
+#include "carcore.hh"
+
+/**
+ *	@class	CarReorderBuffer
+ *	@brief	多生產者/單一消費者重新排序緩衝區
+ *	@remark	生產者以任意順序放入附帶序號 (由 0 起算、連續不中斷) 的項目，消費者依序號順序取出，
+ *			下一個序號尚未放入時即使後續項目已完成也不會取出。同時存在的序號範圍不得超過容量
+ *			(呼叫端以處理中的項目數量上限保證)，第 n 號項目固定存放於 n % capacity 槽位。
+ *			項目以幀為單位交換，競爭很少，以單一 mutex 保護。放入與取出皆以 swap 交換內容。
+ */
+template <typename T>
+class CarReorderBuffer
+{
+public:
+	CarReorderBuffer();
+	virtual ~CarReorderBuffer() {}
+
+	void Reset(size_t capacity);
+	bool Push(uint64_t sequence, T& item);
+	bool Pop(T& item, int timeoutMs = -1);
+	void Close();
+
+	size_t GetCapacity() const { return m_vecSlots.size(); }
+	size_t GetPending() const { return m_nPending.load(std::memory_order_relaxed); }
+	size_t GetMaxPending() const { return m_nMaxPending.load(std::memory_order_relaxed); }
+
+private:
+	CarReorderBuffer(const CarReorderBuffer&) = delete;				//!< Disable copy construction
+	CarReorderBuffer& operator=(const CarReorderBuffer&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Slot
+	 *	@brief	重新排序槽位
+	 */
+	struct Slot {
+		bool	isReady;	//!< 槽位已放入項目
+		T		item;		//!< 槽位內容
+	};
+
+	std::vector<Slot>		m_vecSlots;			//!< 槽位陣列
+	uint64_t				m_nNext;			//!< 下一個取出的序號
+	bool					m_isClosed;			//!< 緩衝區是否已關閉
+	std::atomic<size_t>		m_nPending;			//!< 已放入尚未取出的項目數量
+	std::atomic<size_t>		m_nMaxPending;		//!< 已放入尚未取出的項目數量最大值
+	std::mutex				m_mutex;			//!< 保護槽位與序號
+	std::condition_variable	m_cvReady;			//!< 下一個序號已放入通知
+};
+
+/**
+ *	@brief	CarReorderBuffer 建構式
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+CarReorderBuffer<T>::CarReorderBuffer()
+	: m_nNext(0)
+	, m_isClosed(false)
+	, m_nPending(0)
+	, m_nMaxPending(0) {
+}
+
+/**
+ *	@brief	清除所有項目並重新配置槽位，下一個取出的序號回到 0。
+ *	@param[in]	capacity	容量 (同時存在的序號範圍上限，最小為 1)
+ *	@return	此函數沒有返回值
+ *	@remark	不可與 Push、Pop 同時呼叫。
+ */
+template <typename T>
+void CarReorderBuffer<T>::Reset(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_vecSlots.clear();
+	m_vecSlots.resize(std::max<size_t>(capacity, 1));
+	for (auto& slot : m_vecSlots) {
+		slot.isReady = false;
+	}
+	m_nNext = 0;
+	m_isClosed = false;
+	m_nPending.store(0);
+	m_nMaxPending.store(0);
+}
+
+/**
+ *	@brief	放入指定序號的項目 (可由多個生產者同時呼叫)
+ *	@param[in]		sequence	項目序號
+ *	@param[in,out]	item		要放入的項目，返回時換成槽位原本的內容。
+ *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若已關閉、序號已取出或超出容量範圍返回值為零 (false)。
+ */
+template <typename T>
+bool CarReorderBuffer<T>::Push(uint64_t sequence, T& item)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_isClosed || sequence < m_nNext || sequence - m_nNext >= m_vecSlots.size()) {
+		return false;
+	}
+
+	Slot& slot = m_vecSlots[static_cast<size_t>(sequence % m_vecSlots.size())];
+	if (slot.isReady) {
+		return false;
+	}
+
+	using std::swap;
+	swap(slot.item, item);
+	slot.isReady = true;
+
+	const size_t pending = m_nPending.fetch_add(1, std::memory_order_relaxed) + 1;
+	if (pending > m_nMaxPending.load(std::memory_order_relaxed)) {
+		m_nMaxPending.store(pending, std::memory_order_relaxed);
+	}
+
+	// 只有下一個序號放入時消費者才能取出
+	if (sequence == m_nNext) {
+		m_cvReady.notify_one();
+	}
+	return true;
+}
+
+/**
+ *	@brief	依序號順序取出項目 (只能由消費者呼叫)
+ *	@param[out]	item		存放取出的項目 (原本的內容換入槽位)
+ *	@param[in]	timeoutMs	最長等待時間 (ms)，0 = 不等待，負值 = 持續等待。
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或已關閉返回值為零 (false)。
+ */
+template <typename T>
+bool CarReorderBuffer<T>::Pop(T& item, int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_vecSlots.empty()) {
+		return false;
+	}
+
+	auto isReady = [this]() {
+		return m_isClosed || m_vecSlots[static_cast<size_t>(m_nNext % m_vecSlots.size())].isReady;
+	};
+
+	if (timeoutMs < 0) {
+		m_cvReady.wait(lock, isReady);
+	}
+	else if (timeoutMs > 0) {
+		m_cvReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), isReady);
+	}
+
+	Slot& slot = m_vecSlots[static_cast<size_t>(m_nNext % m_vecSlots.size())];
+	if (m_isClosed || !slot.isReady) {
+		return false;
+	}
+
+	using std::swap;
+	swap(slot.item, item);
+	slot.isReady = false;
+	m_nNext++;
+	m_nPending.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+/**
+ *	@brief	關閉緩衝區，喚醒等待中的消費者
+ *	@return	此函數沒有返回值
+ *	@remark	關閉後無法再放入或取出項目，槽位內的項目由呼叫端自行回收 (Reset 前保持不變)。
+ */
+template <typename T>
+void CarReorderBuffer<T>::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_isClosed = true;
+	m_cvReady.notify_all();
+}
+
+#endif // !ODMC_CARPLATE_REORDER_HH
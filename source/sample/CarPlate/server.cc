@@ -0,0 +1,406 @@
+﻿/**************************************************************************//**
+ * @file	server.cc
+ * @brief	CarStreamServer 與 CarStream 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "server.hh"
+
+/**
+ *	@brief	CarStream 建構式
+ *	@param[in]	id		串流編號
+ *	@param[in]	config	串流設定
+ *	@param[in]	server	所屬伺服器
+ *	@return	此函數沒有返回值
+ */
+CarStream::CarStream(int id, const CarStreamConfig& config, CarStreamServer& server)
+	: m_nId(id)
+	, m_sConfig(config)
+	, m_strSource(config.capture.recordFile.empty() ? config.url : CAR_SOURCE_REPLAY + config.capture.recordFile)
+	, m_cServer(server)
+	, m_nPriority(static_cast<int>(config.priority))
+	, m_isRunning(false)
+	, m_isScheduled(false)
+	, m_nProcessed(0)
+	, m_cMetrics("stream-" + std::to_string(id)) {
+	m_cDetector.SetMetrics(&m_cMetrics);
+	m_cCapture.SetMetrics(&m_cMetrics);
+	m_cServer.m_cMetrics.Register(&m_cMetrics);
+}
+
+/**
+ *	@brief	CarStream 解構式
+ *	@return	此函數沒有返回值
+ */
+CarStream::~CarStream()
+{
+	this->Stop();
+	m_cServer.m_cMetrics.Unregister(&m_cMetrics);
+	m_cMetrics.SetSources(nullptr, nullptr);
+}
+
+/**
+ *	@brief	開始擷取串流並進行偵測
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若啟動失敗返回值為零 (false)。
+ */
+bool CarStream::Start()
+{
+	if (m_isRunning.load()) {
+		return true;
+	}
+
+	// 重建傳輸通道前先停止統計讀取
+	m_cMetrics.SetSources(nullptr, &m_cPool);
+
+	for (;;) {
+		m_cChannel.reset(CarFrameChannel::Create(m_sConfig.channel));
+		if (m_cChannel == nullptr) {
+			break;
+		}
+		m_cMetrics.SetSources(m_cChannel.get(), &m_cPool);
+		m_cDetector.SetMotionOptions(m_sConfig.motion);
+		m_cDetector.SetTrackOptions(m_sConfig.track);
+		m_cDetector.SetVoteOptions(m_sConfig.vote);
+
+		// 載入字元辨識模型 (同一模型檔由各串流映射，實體記憶體共用)
+		if (!m_cServer.m_strModelFile.empty()) {
+			m_cDetector.LoadOcr(m_cServer.m_strModelFile.c_str(), m_cServer.m_strClassFile, m_cServer.m_strImageFile);
+		}
+
+		m_isRunning.store(true);
+		if (!m_cCapture.Start(m_sConfig.url, *this, m_cPool, m_sConfig.capture)) {
+			break;
+		}
+		return true;
+	}
+
+	this->Stop();
+	return false;
+}
+
+/**
+ *	@brief	停止擷取串流，等候佇列或執行中的偵測工作結束。
+ *	@return	此函數沒有返回值
+ */
+void CarStream::Stop()
+{
+	m_isRunning.store(false);
+	this->Close();
+	m_cCapture.Stop();
+
+	{
+		// 等候偵測工作結束通知 (worker pool 停止時佇列中的工作不再執行，逾時後重新檢查)
+		std::unique_lock<std::mutex> lock(m_mutexIdle);
+		while (m_isScheduled.load() && m_cServer.m_cWorkers.IsRunning()) {
+			m_cvIdle.wait_for(lock, std::chrono::milliseconds(CAR_RING_WAIT_MS));
+		}
+		m_isScheduled.store(false);
+	}
+	m_cFrame.Release();
+}
+
+/**
+ *	@brief	[重載] 偵測一幀影像 (由 worker thread 執行)，期間有新影像到達時重新排程。
+ */
+void CarStream::Run()
+{
+	if (m_isRunning.load() && m_cChannel->Pop(m_cFrame, 0)) {
+		auto& imgFrame = m_cFrame.Image();
+
+		// 串流重新連接後影像規格可能改變，釋放暫存影像 (下一幀依新解析度配置)
+		if (m_cCapture.FetchReset()) {
+			m_cDetector.ReleaseWorkspace();
+		}
+		m_cDetector.Detect(imgFrame);
+		m_nProcessed.fetch_add(1, std::memory_order_relaxed);
+		if (!m_cDetector.IsIdle()) {
+			m_cMetrics.AddProcessed();
+		}
+
+		auto eventsPtr = m_cServer.m_eventsPtr;
+		if (eventsPtr != nullptr) {
+			this->PostEvents(*eventsPtr);
+		}
+
+		auto listenerPtr = m_cServer.m_listenerPtr;
+		if (listenerPtr != nullptr) {
+			listenerPtr->OnDetected(m_nId, imgFrame, m_cDetector);
+		}
+		m_cFrame.Release();
+	}
+
+	// 持有 mutex 直到通知完成，Stop 返回前此工作不再存取串流物件
+	std::lock_guard<std::mutex> lock(m_mutexIdle);
+	m_isScheduled.store(false);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	CarChannelStats stats;
+	this->GetStats(stats);
+	m_cMetrics.SampleQueue(stats.pending);
+	if (stats.pending > 0) {
+		this->Schedule();
+	}
+	m_cvIdle.notify_all();
+}
+
+/**
+ *	@brief	[重載] 放入影像 (擷取端)，並排程偵測工作。
+ */
+bool CarStream::Push(CarFrame& frame)
+{
+	auto isPushed = m_cChannel->Push(frame);
+	this->Schedule();
+	return isPushed;
+}
+
+/**
+ *	@brief	[重載] 取出影像
+ */
+bool CarStream::Pop(CarFrame& frame, int timeoutMs)
+{
+	return m_cChannel != nullptr && m_cChannel->Pop(frame, timeoutMs);
+}
+
+/**
+ *	@brief	[重載] 關閉影像傳輸通道
+ */
+void CarStream::Close()
+{
+	if (m_cChannel != nullptr) {
+		m_cChannel->Close();
+	}
+}
+
+/**
+ *	@brief	[重載] 是否只保留最新影像
+ */
+bool CarStream::IsLatestOnly() const
+{
+	return m_cChannel == nullptr || m_cChannel->IsLatestOnly();
+}
+
+/**
+ *	@brief	[重載] 取得影像傳輸通道統計資料
+ */
+void CarStream::GetStats(CarChannelStats& stats) const
+{
+	if (m_cChannel != nullptr) {
+		m_cChannel->GetStats(stats);
+	}
+	else ::memset(&stats, 0, sizeof(CarChannelStats));
+}
+
+/**
+ *	@brief	排程偵測工作，已有工作在佇列或執行中時不重複排程。
+ *	@return	此函數沒有返回值
+ */
+void CarStream::Schedule()
+{
+	if (!m_isRunning.load()) {
+		return;
+	}
+
+	if (m_isScheduled.exchange(true)) {
+		return;
+	}
+
+	// 以串流編號作為提示，同一路串流優先由同一個 worker 執行 (cache locality)
+	if (!m_cServer.m_cWorkers.Submit(this, this->GetPriority(), m_nId)) {
+		m_isScheduled.store(false);
+	}
+}
+
+/**
+ *	@brief	將此幀偵測結果放入事件佇列: 啟用投票時為此幀產生的車牌事件，否則為每筆候選區域。
+ *	@param[in]	events	偵測事件非同步輸出
+ *	@return	此函數沒有返回值
+ */
+void CarStream::PostEvents(CarEventWriter& events)
+{
+	CarDetectEvent event;
+	const double timestampMs = m_cFrame.TimestampMs();
+
+	if (m_sConfig.vote.isEnabled) {
+		// 投票幀序為偵測器的輸入幀序: 只有車牌最後一次出現在此幀時才能對應到來源幀序 (軌跡結束的事件沒有截圖參考)
+		const uint64_t lastIndex = m_cDetector.GetFrames() - 1;
+		for (const auto& plateEvent : m_cDetector.GetEvents()) {
+			CarEventWriter::MakeEvent(event, m_nId, timestampMs, plateEvent);
+			if (m_cFrame.IsStamped() && plateEvent.lastIndex == lastIndex) {
+				CarEventWriter::SetCrop(event, m_strSource.c_str(), m_cFrame.Index());
+			}
+			events.Post(event);
+		}
+		return;
+	}
+	if (m_cDetector.IsIdle()) {
+		return;
+	}
+
+	const auto& candidates = m_cDetector.GetCandidates();
+	const auto& reads = m_cDetector.GetReads();
+	for (size_t i = 0; i < candidates.size(); i++) {
+		CarEventWriter::MakeEvent(event, m_nId, m_cFrame.Index(), timestampMs, candidates[i], i < reads.size() ? &reads[i] : nullptr);
+		if (m_cFrame.IsStamped()) {
+			CarEventWriter::SetCrop(event, m_strSource.c_str(), m_cFrame.Index());
+		}
+		events.Post(event);
+	}
+}
+
+/**
+ *	@brief	CarStreamServer 建構式
+ *	@return	此函數沒有返回值
+ */
+CarStreamServer::CarStreamServer()
+	: m_nNextId(0)
+	, m_listenerPtr(nullptr)
+	, m_eventsPtr(nullptr) {
+}
+
+/**
+ *	@brief	CarStreamServer 解構式
+ *	@return	此函數沒有返回值
+ */
+CarStreamServer::~CarStreamServer()
+{
+	this->Stop();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_vecStreams.clear();
+}
+
+/**
+ *	@brief	啟動偵測 worker pool 與所有已註冊的串流
+ *	@param[in]	workers	worker 數量，0 = 依 CPU 核心數量
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若啟動失敗返回值為零 (false)。
+ */
+bool CarStreamServer::Start(int workers)
+{
+	this->Stop();
+
+	if (!m_cWorkers.Start(workers)) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& stream : m_vecStreams) {
+		stream->Start();
+	}
+	return true;
+}
+
+/**
+ *	@brief	停止所有串流與偵測 worker pool，串流仍保留於註冊列表。
+ *	@return	此函數沒有返回值
+ */
+void CarStreamServer::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& stream : m_vecStreams) {
+			stream->Stop();
+		}
+	}
+	m_cWorkers.Stop();
+}
+
+/**
+ *	@brief	註冊串流，伺服器運作中時立即開始擷取。
+ *	@param[in]	config	串流設定
+ *	@return	<b>型別: int</b> \n 若註冊成功返回串流編號。 \n 若註冊失敗返回值為 -1。
+ */
+int CarStreamServer::AddStream(const CarStreamConfig& config)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const int streamId = m_nNextId;
+
+	std::unique_ptr<CarStream> stream(new (std::nothrow) CarStream(streamId, config, *this));
+	if (stream == nullptr) {
+		return -1;
+	}
+
+	if (this->IsRunning() && !stream->Start()) {
+		return -1;
+	}
+
+	m_vecStreams.push_back(std::move(stream));
+	m_nNextId++;
+	return streamId;
+}
+
+/**
+ *	@brief	停止並移除串流
+ *	@param[in]	streamId	串流編號
+ *	@return	<b>型別: bool</b> \n 若移除成功返回值為非零值 (true)。 \n 若串流不存在返回值為零 (false)。
+ */
+bool CarStreamServer::RemoveStream(int streamId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto it = m_vecStreams.begin(); it != m_vecStreams.end(); ++it) {
+		if ((*it)->GetId() == streamId) {
+			(*it)->Stop();
+			m_vecStreams.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *	@brief	設定串流偵測優先權 (下一次排程生效)
+ *	@param[in]	streamId	串流編號
+ *	@param[in]	priority	偵測優先權
+ *	@return	<b>型別: bool</b> \n 若設定成功返回值為非零值 (true)。 \n 若串流不存在返回值為零 (false)。
+ */
+bool CarStreamServer::SetPriority(int streamId, TaskPriority priority)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& stream : m_vecStreams) {
+		if (stream->GetId() == streamId) {
+			stream->SetPriority(priority);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *	@brief	取得串流影像來源連線狀態
+ *	@param[in]	streamId	串流編號
+ *	@return	<b>型別: SourceHealth</b> \n 連線狀態，串流不存在時返回 SourceHealth::Idle。
+ */
+SourceHealth CarStreamServer::GetHealth(int streamId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& stream : m_vecStreams) {
+		if (stream->GetId() == streamId) {
+			return stream->GetHealth();
+		}
+	}
+	return SourceHealth::Idle;
+}
+
+/**
+ *	@brief	取得已註冊串流數量
+ *	@return	<b>型別: size_t</b> \n 串流數量
+ */
+size_t CarStreamServer::GetStreamCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_vecStreams.size();
+}
+
+/**
+ *	@brief	設定字元辨識模型檔 (下一次啟動串流時載入)
+ *	@param[in]	modelFile	二進位模型檔路徑
+ *	@param[in]	classFile	字元訓練標籤檔 (XML)
+ *	@param[in]	imageFile	字元訓練影像檔 (XML)
+ *	@return	此函數沒有返回值
+ */
+void CarStreamServer::SetOcrFiles(const char* modelFile, const cv::String& classFile, const cv::String& imageFile)
+{
+	m_strModelFile = (modelFile != nullptr) ? modelFile : "";
+	m_strClassFile = classFile;
+	m_strImageFile = imageFile;
+}
@@ -0,0 +1,162 @@
+﻿/**************************************************************************//**
+ * @file	server.hh
+ * @brief	CarStreamServer 多路串流車牌偵測伺服器類別宣告 Header (不依賴 Win32)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_SERVER_HH
+#define	ODMC_CARPLATE_SERVER_HH
+#include "capture.hh"
+#include "detector.hh"
+#include "eventlog.hh"
+#include "workpool.hh"
+
+class CarStreamServer;
+
+/**
+ *	@struct	CarStreamConfig
+ *	@brief	串流設定
+ */
+struct CarStreamConfig {
+	cv::String			url;			//!< 串流網址或影像檔案路徑
+	TaskPriority		priority;		//!< 偵測優先權
+	ChannelType			channel;		//!< 擷取與偵測之間影像傳輸方式
+	CarCaptureOptions	capture;		//!< 影像擷取選項
+	CarMotionOptions	motion;			//!< 畫面變化偵測選項 (靜止畫面略過偵測)
+	CarTrackOptions		track;			//!< 車牌位置追蹤選項 (只搜尋已知車牌附近區域)
+	CarVoteOptions		vote;			//!< 跨幀投票選項 (同一車牌只輸出一筆事件)
+
+	CarStreamConfig()
+		: url()
+		, priority(TaskPriority::Normal)
+		, channel(ChannelType::Mailbox)
+		, capture()
+		, motion()
+		, track()
+		, vote() {
+	}
+};
+
+/**
+ *	@class	CarStreamListener
+ *	@brief	偵測結果通知介面
+ */
+class CarStreamListener
+{
+public:
+	virtual ~CarStreamListener() {}
+
+	/**
+	 *	@brief	單一幀偵測完成時由 worker thread 呼叫 (同一路串流不會同時呼叫)
+	 *	@param[in]		streamId	串流編號
+	 *	@param[in,out]	imgFrame	已繪製偵測結果的影像，返回後緩衝區歸還緩衝池。
+	 *	@param[in]		detector	偵測物件，可取得候選區域、辨識結果與此幀產生的車牌事件 (GetEvents)。
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void OnDetected(int streamId, cv::Mat& imgFrame, const CarPlateDetector& detector) = 0;
+};
+
+/**
+ *	@class	CarStream
+ *	@brief	單一路串流: 擷取 thread、影像傳輸通道與偵測物件
+ *	@remark	擷取端每放入一幀即排程一次偵測工作，同一路串流同時最多只有一個工作在佇列或執行中，
+ *			因此偵測物件不需要鎖，且任何一路串流都無法佔滿 worker (各串流公平輪流)。
+ */
+class CarStream : public CarTask, public CarFrameChannel
+{
+public:
+	CarStream(int id, const CarStreamConfig& config, CarStreamServer& server);
+	virtual ~CarStream();
+
+	bool Start();
+	void Stop();
+
+	int GetId() const { return m_nId; }
+	TaskPriority GetPriority() const { return static_cast<TaskPriority>(m_nPriority.load(std::memory_order_relaxed)); }
+	void SetPriority(TaskPriority priority) { m_nPriority.store(static_cast<int>(priority), std::memory_order_relaxed); }
+	uint64_t GetProcessed() const { return m_nProcessed.load(std::memory_order_relaxed); }
+	CarStreamMetrics& GetMetrics() { return m_cMetrics; }
+
+	// CarTask
+	void Run() override;
+
+	// CarFrameChannel (擷取端放入影像後排程偵測工作)
+	bool Push(CarFrame& frame) override;
+	bool Pop(CarFrame& frame, int timeoutMs = -1) override;
+	void Close() override;
+	bool IsLatestOnly() const override;
+	void GetStats(CarChannelStats& stats) const override;
+
+private:
+	CarStream(const CarStream&) = delete;				//!< Disable copy construction
+	CarStream& operator=(const CarStream&) = delete;	//!< Disable assignment operator
+	void Schedule();
+	void PostEvents(CarEventWriter& events);
+
+	int					m_nId;				//!< 串流編號
+	CarStreamConfig		m_sConfig;			//!< 串流設定
+	std::string			m_strSource;		//!< 事件截圖參考來源 (錄製時為 replay:<錄製檔>，否則為串流網址)
+	CarStreamServer&	m_cServer;			//!< 所屬伺服器
+	std::atomic<int>	m_nPriority;		//!< 偵測優先權 (TaskPriority)
+	std::atomic<bool>	m_isRunning;		//!< 串流是否運作中
+	std::atomic<bool>	m_isScheduled;		//!< 是否已有偵測工作在佇列或執行中
+	std::mutex			m_mutexIdle;		//!< 偵測工作結束通知用 mutex
+	std::condition_variable	m_cvIdle;		//!< 偵測工作結束通知 (停止串流時等候)
+	std::atomic<uint64_t> m_nProcessed;		//!< 已偵測幀數
+
+	CarFramePool		m_cPool;			//!< 影像緩衝池
+	std::unique_ptr<CarFrameChannel> m_cChannel;	//!< 影像傳輸通道
+	CarCapture			m_cCapture;			//!< 影像擷取
+	CarPlateDetector	m_cDetector;		//!< 車牌偵測
+	CarFrame			m_cFrame;			//!< 偵測中的影像
+	CarStreamMetrics	m_cMetrics;			//!< 效能統計
+};
+
+/**
+ *	@class	CarStreamServer
+ *	@brief	多路串流車牌偵測伺服器
+ *	@remark	每路串流一個擷取 thread (阻塞於網路 I/O)，所有串流共用一個依 CPU 核心數量建立的
+ *			工作竊取 worker pool 進行偵測，串流數量增加時偵測 thread 數量不變。
+ *			設定事件輸出時，worker 將偵測結果 (啟用投票時為車牌事件) 放入事件佇列，由背景 thread 寫出。
+ */
+class CarStreamServer
+{
+public:
+	CarStreamServer();
+	virtual ~CarStreamServer();
+
+	bool Start(int workers = 0);
+	void Stop();
+	bool IsRunning() const { return m_cWorkers.IsRunning(); }
+
+	int  AddStream(const CarStreamConfig& config);
+	bool RemoveStream(int streamId);
+	bool SetPriority(int streamId, TaskPriority priority);
+	SourceHealth GetHealth(int streamId);
+	size_t GetStreamCount();
+
+	void SetListener(CarStreamListener* listenerPtr) { m_listenerPtr = listenerPtr; }
+	void SetEventWriter(CarEventWriter* eventsPtr) { m_eventsPtr = eventsPtr; }
+	void SetOcrFiles(const char* modelFile, const cv::String& classFile, const cv::String& imageFile);
+	CarWorkerPool& GetWorkers() { return m_cWorkers; }
+	CarMetricsRegistry& GetMetrics() { return m_cMetrics; }
+
+private:
+	friend class CarStream;
+	CarStreamServer(const CarStreamServer&) = delete;				//!< Disable copy construction
+	CarStreamServer& operator=(const CarStreamServer&) = delete;	//!< Disable assignment operator
+
+	CarMetricsRegistry	m_cMetrics;			//!< 各串流效能統計登錄 (串流解構前必須保持有效)
+	std::mutex			m_mutex;			//!< 保護串流列表
+	std::vector<std::unique_ptr<CarStream> > m_vecStreams;	//!< 串流列表
+	int					m_nNextId;			//!< 下一個串流編號
+	CarWorkerPool		m_cWorkers;			//!< 偵測 worker pool
+	CarStreamListener*	m_listenerPtr;		//!< 偵測結果通知 (可為 nullptr)
+	CarEventWriter*		m_eventsPtr;		//!< 偵測事件非同步輸出 (可為 nullptr，必須已啟動)
+	std::string			m_strModelFile;		//!< 字元辨識二進位模型檔
+	cv::String			m_strClassFile;		//!< 字元訓練標籤檔
+	cv::String			m_strImageFile;		//!< 字元訓練影像檔
+};
+
+#endif // !ODMC_CARPLATE_SERVER_HH
@@ -0,0 +1,560 @@
+﻿/**************************************************************************//**
+ * @file	source.cc
+ * @brief	CarFrameSource 與各影像來源類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "source.hh"
+
+// OpenCV 4.7 起可查詢最近讀取的封包是否為關鍵影格 (CAP_PROP_LRF_HAS_KEY_FRAME)
+#if (CV_VERSION_MAJOR > 4) || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+#define CAR_CAPTURE_KEYFRAME_PROP
+#endif
+
+/**
+ *	@brief	依網址建立影像來源
+ *	@param[in]	url		串流網址、影像檔案路徑、replay:<錄製檔路徑>、synthetic:[<寬>x<高>][@<幀數>]
+ *						或 flaky:<幀數>,<失敗次數>[,<阻塞 ms>]:<網址> (包裝其他來源的斷線模擬)
+ *	@param[in]	options	影像擷取選項
+ *	@return	<b>型別: CarFrameSource*</b> \n 若建立成功返回影像來源 (由呼叫端釋放)。 \n 若網址格式錯誤或配置失敗返回 nullptr。
+ */
+CarFrameSource* CarFrameSource::Create(const cv::String& url, const CarCaptureOptions& options)
+{
+	const size_t flakyLen = ::strlen(CAR_SOURCE_FLAKY);
+	if (url.compare(0, flakyLen, CAR_SOURCE_FLAKY) == 0) {
+		const char* argPtr = url.c_str() + flakyLen;
+		const char* urlPtr = ::strchr(argPtr, ':');
+		unsigned long long frames = 0;
+		int fails = 0;
+		int hangMs = 0;
+
+		if (urlPtr == nullptr || ::sscanf(argPtr, "%llu,%d,%d", &frames, &fails, &hangMs) < 2 || fails < 0 || hangMs < 0) {
+			return nullptr;
+		}
+		CarFrameSource* sourcePtr = CarFrameSource::Create(cv::String(urlPtr + 1), options);
+		if (sourcePtr == nullptr) {
+			return nullptr;
+		}
+		CarFrameSource* flakyPtr = new (std::nothrow) CarFlakySource(sourcePtr, frames, fails, hangMs);
+		if (flakyPtr == nullptr) {
+			delete sourcePtr;
+		}
+		return flakyPtr;
+	}
+
+	const size_t replayLen = ::strlen(CAR_SOURCE_REPLAY);
+	if (url.compare(0, replayLen, CAR_SOURCE_REPLAY) == 0) {
+		return new (std::nothrow) CarReplaySource(url.substr(replayLen), options);
+	}
+
+	const size_t syntheticLen = ::strlen(CAR_SOURCE_SYNTHETIC);
+	if (url.compare(0, syntheticLen, CAR_SOURCE_SYNTHETIC) == 0) {
+		const char* argPtr = url.c_str() + syntheticLen;
+		int width = CAR_SYNTH_WIDTH;
+		int height = CAR_SYNTH_HEIGHT;
+		uint64_t frames = 0;
+
+		if (*argPtr != '\0' && *argPtr != '@' && ::sscanf(argPtr, "%dx%d", &width, &height) != 2) {
+			return nullptr;
+		}
+		const char* framesPtr = ::strchr(argPtr, '@');
+		if (framesPtr != nullptr) {
+			frames = ::strtoull(framesPtr + 1, nullptr, 10);
+		}
+		if (width <= 0 || height <= 0) {
+			return nullptr;
+		}
+		return new (std::nothrow) CarSyntheticSource(cv::Size(width, height), frames, options);
+	}
+
+	return new (std::nothrow) CarVideoSource(url, options);
+}
+
+/**
+ *	@brief	CarVideoSource 建構式
+ *	@param[in]	url		串流網址或影像檔案路徑
+ *	@param[in]	options	影像擷取選項
+ *	@return	此函數沒有返回值
+ */
+CarVideoSource::CarVideoSource(const cv::String& url, const CarCaptureOptions& options)
+	: m_strUrl(url)
+	, m_sOptions(options)
+	, m_nFrameType(CV_8UC3)
+	, m_nIndex(0)
+	, m_nNextIndex(0) {
+}
+
+/**
+ *	@brief	CarVideoSource 解構式
+ *	@return	此函數沒有返回值
+ */
+CarVideoSource::~CarVideoSource() { this->Close(); }
+
+/**
+ *	@brief	[重載] 開啟串流，決定輸出大小，可行時要求擷取裝置直接輸出該大小。
+ *	@remark	攝影機等裝置可直接輸出較小的影像，影像檔案與多數網路串流不支援，由擷取端縮放。
+ */
+bool CarVideoSource::Open()
+{
+	this->Close();
+	if (!m_cCapture.open(m_strUrl) || !m_cCapture.isOpened()) {
+		m_cCapture.release();
+		return false;
+	}
+	m_cCapture.set(cv::CAP_PROP_FORMAT, CV_8UC3);
+
+	m_outputSize = m_sOptions.outputSize;
+	if (m_outputSize.area() == 0 && m_sOptions.scaleDown > 1) {
+		const int width = static_cast<int>(m_cCapture.get(cv::CAP_PROP_FRAME_WIDTH));
+		const int height = static_cast<int>(m_cCapture.get(cv::CAP_PROP_FRAME_HEIGHT));
+		if (width > 0 && height > 0) {
+			m_outputSize = cv::Size(width / m_sOptions.scaleDown, height / m_sOptions.scaleDown);
+		}
+	}
+	if (m_sOptions.isRequestSize && m_outputSize.area() > 0) {
+		m_cCapture.set(cv::CAP_PROP_FRAME_WIDTH, m_outputSize.width);
+		m_cCapture.set(cv::CAP_PROP_FRAME_HEIGHT, m_outputSize.height);
+	}
+
+	// 幀序與解碼器輸出大小重新起算
+	m_sourceSize = cv::Size();
+	m_nIndex = 0;
+	m_nNextIndex = 0;
+	m_openTime = std::chrono::steady_clock::now();
+	return true;
+}
+
+/**
+ *	@brief	[重載] 關閉串流
+ */
+void CarVideoSource::Close()
+{
+	m_cCapture.release();
+}
+
+/**
+ *	@brief	[重載] 讀取下一幀，依解碼模式跳過的幀只呼叫 grab (仍會解碼)，需要的幀取出 (或縮放) 至緩衝池緩衝區。
+ */
+SourceRead CarVideoSource::Read(CarFrame& frame, CarFramePool& pool)
+{
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	bool isDecoded;
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Capture);
+		isDecoded = m_cCapture.grab();
+	}
+	if (!isDecoded) {
+		return SourceRead::Failed;
+	}
+
+	// 依解碼模式跳過的幀不取得緩衝區、不轉換色彩
+	const uint64_t index = m_nIndex++;
+	if (!this->IsDecodeFrame(index)) {
+		return SourceRead::Skipped;
+	}
+
+	// 由緩衝池取得與上一幀相同規格的緩衝區 (擷取與解碼分開計時)
+	frame = pool.Acquire(m_frameSize, m_nFrameType);
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Decode);
+		auto& imgFrame = frame.Image();
+		if (m_outputSize.area() > 0 && m_outputSize != m_sourceSize) {
+			// 解碼器輸出大小不符 (或尚未得知)，解碼至暫存影像後縮放至緩衝區
+			isDecoded = m_cCapture.retrieve(m_imgTemp) && !m_imgTemp.empty();
+			if (isDecoded) {
+				m_sourceSize = m_imgTemp.size();
+				cv::resize(m_imgTemp, imgFrame, m_outputSize);
+			}
+		}
+		else {
+			// 解碼器已直接輸出所需大小 (或不縮放)，直接解碼至緩衝區
+			isDecoded = m_cCapture.retrieve(imgFrame) && !imgFrame.empty();
+			if (isDecoded) {
+				m_sourceSize = imgFrame.size();
+				if (m_outputSize.area() == 0 && m_sOptions.scaleDown > 1) {
+					m_outputSize = cv::Size(m_sourceSize.width / m_sOptions.scaleDown, m_sourceSize.height / m_sOptions.scaleDown);
+				}
+				if (m_outputSize.area() > 0 && m_outputSize != m_sourceSize) {
+					cv::resize(imgFrame, m_imgTemp, m_outputSize);
+					std::swap(m_imgTemp, imgFrame);
+				}
+			}
+		}
+	}
+
+	// 解碼失敗時緩衝區歸還緩衝池 (不可送出上一次使用的內容)
+	if (!isDecoded) {
+		frame.Release();
+		return SourceRead::Failed;
+	}
+
+	// 附加來源幀序與時間戳記 (後端不提供位置時以開啟串流後經過的時間代替)
+	double timestampMs = m_cCapture.get(cv::CAP_PROP_POS_MSEC);
+	if (!(timestampMs >= 0.0)) {
+		timestampMs = Milliseconds(std::chrono::steady_clock::now() - m_openTime).count();
+	}
+	frame.SetStamp(index, timestampMs);
+	m_nNextIndex = index + std::max(m_sOptions.decode == CaptureDecode::Keyframe ? m_sOptions.keyframeInterval : m_sOptions.decodeStep, 1);
+	m_frameSize = frame.Image().size();
+	m_nFrameType = frame.Image().type();
+	return SourceRead::Frame;
+}
+
+/**
+ *	@brief	依解碼模式判斷剛讀取 (grab) 的幀是否需要取出 (retrieve)
+ *	@param[in]	index	此幀來源幀序
+ *	@return	<b>型別: bool</b> \n 若需要取出返回值為非零值 (true)。 \n 若跳過此幀返回值為零 (false)。
+ *	@remark	OpenCV 4.7 起可查詢最近讀取的封包是否為關鍵影格，較舊版本或後端不支援時，
+ *			關鍵影格模式依預估間隔解碼 (查詢可用時預估間隔仍作為解碼間隔上限)。
+ */
+bool CarVideoSource::IsDecodeFrame(uint64_t index)
+{
+	switch (m_sOptions.decode) {
+	case CaptureDecode::EveryNth:
+		return index >= m_nNextIndex;
+
+	case CaptureDecode::Keyframe:
+		if (index >= m_nNextIndex) {
+			return true;
+		}
+		#if defined(CAR_CAPTURE_KEYFRAME_PROP)
+		return m_cCapture.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0;
+		#else
+		return false;
+		#endif
+
+	default:
+		return true;
+	}
+}
+
+/**
+ *	@brief	CarReplaySource 建構式
+ *	@param[in]	path	錄製檔路徑
+ *	@param[in]	options	影像擷取選項
+ *	@return	此函數沒有返回值
+ */
+CarReplaySource::CarReplaySource(const cv::String& path, const CarCaptureOptions& options)
+	: m_strPath(path)
+	, m_sOptions(options)
+	, m_nFrames(0)
+	, m_nNext(0)
+	, m_nIndexBase(0)
+	, m_nLastIndex(0)
+	, m_fTimeBase(0.0)
+	, m_fFirstTime(0.0)
+	, m_fLastTime(0.0) {
+	::memset(&m_sHeader, 0, sizeof(m_sHeader));
+}
+
+/**
+ *	@brief	CarReplaySource 解構式
+ *	@return	此函數沒有返回值
+ */
+CarReplaySource::~CarReplaySource() { this->Close(); }
+
+/**
+ *	@brief	[重載] 映射錄製檔並驗證檔頭，由第一幀重新開始播放。
+ */
+bool CarReplaySource::Open()
+{
+	this->Close();
+	for (;;) {
+		if (!m_cFile.Open(m_strPath.c_str())) break;
+
+		const uint64_t size = static_cast<uint64_t>(m_cFile.GetSize());
+		if (size < sizeof(CarRecordHeader)) break;
+
+		// 驗證檔頭與影像規格
+		::memcpy(&m_sHeader, m_cFile.GetData(), sizeof(CarRecordHeader));
+		const auto& header = m_sHeader;
+		if (::memcmp(header.magic, CAR_RECORD_MAGIC, sizeof(header.magic)) != 0) break;
+		if (header.version != CAR_RECORD_VERSION || header.headerSize != sizeof(CarRecordHeader)) break;
+		if (header.width == 0 || header.height == 0 || CV_MAT_DEPTH(header.type) != CV_8U) break;
+		if (header.frameBytes != static_cast<uint64_t>(header.width) * header.height * CV_ELEM_SIZE(header.type)) break;
+		if (header.recordSize != CarFrameRecorder::GetRecordSize(header.frameBytes)) break;
+		if (header.dataOffset < header.headerSize || header.dataOffset > size) break;
+
+		// 幀數以檔案內完整的紀錄為上限 (錄製未正常結束時檔頭幀數為 0)
+		const uint64_t records = (size - header.dataOffset) / header.recordSize;
+		m_nFrames = (header.frames > 0) ? std::min(header.frames, records) : records;
+		if (m_nFrames == 0) break;
+
+		const auto& first = *reinterpret_cast<const CarRecordFrame*>(m_cFile.GetData() + header.dataOffset);
+		m_nNext = 0;
+		m_nIndexBase = 0;
+		m_nLastIndex = 0;
+		m_fTimeBase = 0.0;
+		m_fFirstTime = first.timestampMs;
+		m_fLastTime = first.timestampMs;
+		m_startTime = std::chrono::steady_clock::now();
+		return true;
+	}
+
+	this->Close();
+	return false;
+}
+
+/**
+ *	@brief	[重載] 解除錄製檔映射
+ */
+void CarReplaySource::Close()
+{
+	m_cFile.Close();
+	m_nFrames = 0;
+}
+
+/**
+ *	@brief	[重載] 送出下一幀錄製影像，依錄製時間戳記送出時等候至該幀的送出時間 (每次最多 CAR_RING_WAIT_MS)。
+ */
+SourceRead CarReplaySource::Read(CarFrame& frame, CarFramePool& pool)
+{
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	if (!m_cFile.IsOpened()) {
+		return SourceRead::Failed;
+	}
+
+	// 播放完畢，循環播放時幀序與時間戳記接續 (間隔取錄製檔平均幀間隔)
+	if (m_nNext >= m_nFrames) {
+		if (!m_sOptions.isLoop) {
+			return SourceRead::End;
+		}
+		const double interval = (m_nFrames > 1) ? (m_fLastTime - m_fFirstTime) / static_cast<double>(m_nFrames - 1) : 0.0;
+		m_fTimeBase += m_fLastTime - m_fFirstTime + interval;
+		m_nIndexBase += m_nLastIndex + 1;
+		m_nNext = 0;
+	}
+
+	const uint8_t* recordPtr = m_cFile.GetData() + m_sHeader.dataOffset + m_nNext * m_sHeader.recordSize;
+	const auto& info = *reinterpret_cast<const CarRecordFrame*>(recordPtr);
+	const double timestampMs = m_fTimeBase + info.timestampMs;
+
+	// 依錄製速度送出: 未到送出時間時等候，等候時間過長則返回讓呼叫端檢查執行識別
+	if (m_sOptions.isRealtime) {
+		const auto dueTime = m_startTime + std::chrono::duration_cast<Clock::duration>(Milliseconds(timestampMs - m_fFirstTime));
+		const auto waitTime = dueTime - Clock::now();
+		if (waitTime > Clock::duration::zero()) {
+			if (waitTime > std::chrono::milliseconds(CAR_RING_WAIT_MS)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(CAR_RING_WAIT_MS));
+				return SourceRead::Pending;
+			}
+			std::this_thread::sleep_until(dueTime);
+		}
+	}
+
+	// 由映射區複製至緩衝池緩衝區 (偵測端會在影像上繪製，不可直接使用唯讀映射)
+	frame = pool.Acquire(cv::Size(static_cast<int>(m_sHeader.width), static_cast<int>(m_sHeader.height)), static_cast<int>(m_sHeader.type));
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Decode);
+		auto& imgFrame = frame.Image();
+		imgFrame.create(static_cast<int>(m_sHeader.height), static_cast<int>(m_sHeader.width), static_cast<int>(m_sHeader.type));
+		const uint8_t* dataPtr = recordPtr + CarFrameRecorder::GetRecordSize(0);
+		const size_t rowBytes = static_cast<size_t>(m_sHeader.width) * imgFrame.elemSize();
+		for (int y = 0; y < imgFrame.rows; y++) {
+			::memcpy(imgFrame.ptr(y), dataPtr + rowBytes * y, rowBytes);
+		}
+	}
+
+	frame.SetStamp(m_nIndexBase + info.index, timestampMs);
+	m_nLastIndex = info.index;
+	m_fLastTime = info.timestampMs;
+	m_nNext++;
+	return SourceRead::Frame;
+}
+
+/**
+ *	@brief	CarSyntheticSource 建構式
+ *	@param[in]	size	影像大小
+ *	@param[in]	frames	總幀數，0 = 不限
+ *	@param[in]	options	影像擷取選項
+ *	@return	此函數沒有返回值
+ */
+CarSyntheticSource::CarSyntheticSource(const cv::Size& size, uint64_t frames, const CarCaptureOptions& options)
+	: m_sOptions(options)
+	, m_size(size)
+	, m_nFrames(frames)
+	, m_nIndex(0) {
+}
+
+/**
+ *	@brief	CarSyntheticSource 解構式
+ *	@return	此函數沒有返回值
+ */
+CarSyntheticSource::~CarSyntheticSource() {}
+
+/**
+ *	@brief	[重載] 以固定亂數種子產生背景 (垂直漸層與灰階矩形)，由第一幀重新開始。
+ */
+bool CarSyntheticSource::Open()
+{
+	cv::RNG rng(CAR_SYNTH_SEED);
+
+	m_imgBackground.create(m_size, CV_8UC3);
+	for (int y = 0; y < m_size.height; y++) {
+		const double level = 70.0 + 80.0 * y / m_size.height;
+		m_imgBackground.row(y).setTo(cv::Scalar(level, level, level));
+	}
+	for (int i = 0; i < 40; i++) {
+		const int x = rng.uniform(0, m_size.width);
+		const int y = rng.uniform(0, m_size.height);
+		const cv::Rect rect = cv::Rect(x, y, rng.uniform(8, m_size.width / 4 + 9), rng.uniform(8, m_size.height / 4 + 9)) & cv::Rect(cv::Point(), m_size);
+		const double level = rng.uniform(40, 200);
+		cv::rectangle(m_imgBackground, rect, cv::Scalar(level, level, level), cv::FILLED);
+	}
+
+	m_nIndex = 0;
+	return true;
+}
+
+/**
+ *	@brief	[重載] 釋放背景影像
+ */
+void CarSyntheticSource::Close()
+{
+	m_imgBackground.release();
+}
+
+/**
+ *	@brief	[重載] 產生下一幀: 背景加上移動中的車牌，時間戳記依 CAR_SYNTH_FPS 計算。
+ */
+SourceRead CarSyntheticSource::Read(CarFrame& frame, CarFramePool& pool)
+{
+	if (m_imgBackground.empty()) {
+		return SourceRead::Failed;
+	}
+
+	uint64_t content = m_nIndex;
+	if (m_nFrames > 0 && m_nIndex >= m_nFrames) {
+		if (!m_sOptions.isLoop) {
+			return SourceRead::End;
+		}
+		content = m_nIndex % m_nFrames;
+	}
+
+	frame = pool.Acquire(m_size, CV_8UC3);
+	{
+		CarStageTimer timer(m_metricsPtr, MetricStage::Decode);
+		auto& imgFrame = frame.Image();
+		m_imgBackground.copyTo(imgFrame);
+
+		// 每段前 CAR_SYNTH_PASS_FRAMES 幀車牌由左至右橫越畫面，其餘幀畫面靜止
+		const uint64_t cycle = CAR_SYNTH_PASS_FRAMES + CAR_SYNTH_GAP_FRAMES;
+		const uint64_t plate = content / cycle;
+		const int step = static_cast<int>(content % cycle);
+		if (step < CAR_SYNTH_PASS_FRAMES) {
+			char text[16];
+			CarSyntheticSource::GetPlateText(plate, text, sizeof(text));
+
+			const int width = std::min(CAR_SYNTH_PLATE_WD, m_size.width / 2);
+			const int height = std::max(width / 4, 1);
+			const int x = (m_size.width - width) * step / std::max(CAR_SYNTH_PASS_FRAMES - 1, 1);
+			const int y = m_size.height * 3 / 5 + (static_cast<int>(plate % 3) - 1) * height;
+			const cv::Rect rect = cv::Rect(x, y - height / 2, width, height) & cv::Rect(cv::Point(), m_size);
+			cv::rectangle(imgFrame, rect, cv::Scalar(235, 235, 235), cv::FILLED);
+			cv::rectangle(imgFrame, rect, cv::Scalar(20, 20, 20), std::max(height / 20, 2));
+			cv::putText(imgFrame, text, cv::Point(rect.x + height / 5, rect.y + height * 3 / 4), cv::FONT_HERSHEY_SIMPLEX,
+				height / 40.0, cv::Scalar(10, 10, 10), std::max(height / 12, 2));
+		}
+	}
+
+	frame.SetStamp(m_nIndex, m_nIndex * 1000.0 / CAR_SYNTH_FPS);
+	m_nIndex++;
+	return SourceRead::Frame;
+}
+
+/**
+ *	@brief	產生合成車牌文字 (3 個英文字母、'-'、4 個數字)，相同編號每次結果相同。
+ *	@param[in]	plate	車牌編號
+ *	@param[out]	textPtr	(指標) 文字緩衝區
+ *	@param[in]	size	文字緩衝區大小 (至少 9 bytes)
+ *	@return	此函數沒有返回值
+ */
+void CarSyntheticSource::GetPlateText(uint64_t plate, char* textPtr, size_t size)
+{
+	uint64_t value = (plate + 1) * 6364136223846793005ULL + CAR_SYNTH_SEED;
+	value ^= value >> 29;
+
+	::snprintf(textPtr, size, "%c%c%c-%04u",
+		static_cast<char>('A' + value % 26),
+		static_cast<char>('A' + (value / 26) % 26),
+		static_cast<char>('A' + (value / 676) % 26),
+		static_cast<unsigned>((value / 17576) % 10000));
+}
+
+/**
+ *	@brief	CarFlakySource 建構式
+ *	@param[in]	sourcePtr	(指標) 內部影像來源 (所有權轉移)
+ *	@param[in]	frames		每次連接送出的幀數，0 = 不斷線
+ *	@param[in]	fails		斷線後開啟失敗次數
+ *	@param[in]	hangMs		斷線期間每次讀取阻塞時間 (ms)，0 = 立即返回失敗
+ *	@return	此函數沒有返回值
+ */
+CarFlakySource::CarFlakySource(CarFrameSource* sourcePtr, uint64_t frames, int fails, int hangMs)
+	: m_cSource(sourcePtr)
+	, m_nFrames(frames)
+	, m_nFails(fails)
+	, m_nHangMs(hangMs)
+	, m_nCount(0)
+	, m_nFailed(0)
+	, m_isDown(false) {
+}
+
+/**
+ *	@brief	CarFlakySource 解構式
+ *	@return	此函數沒有返回值
+ */
+CarFlakySource::~CarFlakySource()
+{
+	this->Close();
+}
+
+/**
+ *	@brief	[重載] 開啟內部影像來源，斷線後的前 m_nFails 次直接返回失敗。
+ */
+bool CarFlakySource::Open()
+{
+	if (m_isDown && m_nFailed < m_nFails) {
+		m_nFailed++;
+		return false;
+	}
+
+	m_cSource->SetMetrics(m_metricsPtr);
+	if (!m_cSource->Open()) {
+		return false;
+	}
+	m_nCount = 0;
+	m_nFailed = 0;
+	m_isDown = false;
+	return true;
+}
+
+/**
+ *	@brief	[重載] 關閉內部影像來源 (斷線狀態保留至下一次開啟成功)
+ */
+void CarFlakySource::Close()
+{
+	m_cSource->Close();
+}
+
+/**
+ *	@brief	[重載] 讀取內部影像來源，送出 m_nFrames 幀後模擬斷線。
+ */
+SourceRead CarFlakySource::Read(CarFrame& frame, CarFramePool& pool)
+{
+	if (m_isDown) {
+		if (m_nHangMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(m_nHangMs));
+		}
+		return SourceRead::Failed;
+	}
+
+	const SourceRead result = m_cSource->Read(frame, pool);
+	if (result == SourceRead::Frame && m_nFrames > 0 && ++m_nCount >= m_nFrames) {
+		m_isDown = true;
+	}
+	return result;
+}
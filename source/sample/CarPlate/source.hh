@@ -0,0 +1,241 @@
+﻿/**************************************************************************//**
+ * @file	source.hh
+ * @brief	CarFrameSource 影像來源介面與各影像來源類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_SOURCE_HH
+#define	ODMC_CARPLATE_SOURCE_HH
+#include <memory>
+#include <string>
+#include "metrics.hh"
+#include "mapfile.hh"
+#include "recorder.hh"
+
+#define CAR_SOURCE_REPLAY		"replay:"		//!< 錄製檔重播來源網址前綴 (replay:<path>)
+#define CAR_SOURCE_SYNTHETIC	"synthetic:"	//!< 合成影像來源網址前綴 (synthetic:[<width>x<height>][@<frames>])
+#define CAR_SOURCE_FLAKY		"flaky:"		//!< 斷線模擬來源網址前綴 (flaky:<frames>,<fails>[,<hangMs>]:<url>)
+
+/**
+ *	@enum	CaptureDecode
+ *	@brief	擷取端解碼模式 (跳過的幀仍由 grab 解碼，但不取出: 不轉換色彩、不縮放、不複製、不送出)
+ */
+enum class CaptureDecode : int {
+	All = 0,		//!< 取出所有幀
+	EveryNth,		//!< 每 decodeStep 幀取出一幀
+	Keyframe,		//!< 只取出關鍵影格
+};
+
+/**
+ *	@struct	CarCaptureOptions
+ *	@brief	影像擷取選項
+ */
+struct CarCaptureOptions {
+	cv::Size	outputSize;		//!< 輸出影像大小，為空時保持原始大小
+	int			scaleDown;		//!< 輸出縮小倍數 (未指定輸出大小時使用)，1 = 原始大小
+	bool		isRequestSize;	//!< 是否要求擷取裝置直接輸出縮小後的大小 (裝置不支援時由擷取端縮放)
+	CaptureDecode decode;		//!< 解碼模式
+	int			decodeStep;		//!< 解碼間隔 (CaptureDecode::EveryNth)
+	int			keyframeInterval;	//!< 無法查詢關鍵影格時的預估間隔 (CaptureDecode::Keyframe)
+	bool		isRealtime;		//!< 重播錄製檔時是否依錄製時間戳記送出 (否則盡快送出)
+	bool		isLoop;			//!< 重播錄製檔或合成影像結束後是否從頭開始
+	std::string	recordFile;		//!< 錄製檔路徑 (擷取的原始影像與時間戳記)，空字串 = 不錄製
+	int			pacingMs;		//!< 每幀擷取後等待時間 (ms)，用於影像檔案依原始速度播放，0 = 不等待
+	int			errorLimit;		//!< 連續擷取失敗上限，超過時重新連接串流，0 = 不重新連接
+	int			backoffMinMs;	//!< 重新連接等待時間下限 (ms)
+	int			backoffMaxMs;	//!< 重新連接等待時間上限 (ms)
+	int			stallMs;		//!< 沒有收到影像超過此時間時視為停滯 (ms)，0 = 不判定
+
+	CarCaptureOptions()
+		: outputSize()
+		, scaleDown(1)
+		, isRequestSize(true)
+		, decode(CaptureDecode::All)
+		, decodeStep(1)
+		, keyframeInterval(CAR_CAPTURE_KEYFRAME_INTERVAL)
+		, isRealtime(true)
+		, isLoop(false)
+		, recordFile()
+		, pacingMs(0)
+		, errorLimit(CAR_CAPTURE_ERROR_LIMIT)
+		, backoffMinMs(CAR_CAPTURE_BACKOFF_MIN_MS)
+		, backoffMaxMs(CAR_CAPTURE_BACKOFF_MAX_MS)
+		, stallMs(CAR_CAPTURE_STALL_MS) {
+	}
+};
+
+
+/**
+ *	@enum	SourceRead
+ *	@brief	影像來源讀取結果
+ */
+enum class SourceRead : int {
+	Frame = 0,		//!< 取得一幀影像
+	Skipped,		//!< 依解碼模式跳過一幀 (未取得影像)
+	Pending,		//!< 下一幀尚未到達送出時間 (已等候一段時間，稍後再讀取)
+	Failed,			//!< 讀取失敗 (串流中斷，可重新開啟)
+	End,			//!< 來源已結束 (錄製檔或合成影像播放完畢)
+};
+
+/**
+ *	@class	CarFrameSource
+ *	@brief	影像來源介面 (擷取 thread 與批次解碼 thread 使用)
+ *	@remark	依網址建立: CAR_SOURCE_REPLAY 前綴為錄製檔重播，CAR_SOURCE_SYNTHETIC 前綴為合成影像，
+ *			CAR_SOURCE_FLAKY 前綴為包裝其他來源的斷線模擬，其餘由 cv::VideoCapture 開啟 (串流網址或影像檔案)。影像由緩衝池取得緩衝區，並附加幀序與時間戳記。
+ */
+class CarFrameSource
+{
+public:
+	CarFrameSource() : m_metricsPtr(nullptr) {}
+	virtual ~CarFrameSource() {}
+
+	static CarFrameSource* Create(const cv::String& url, const CarCaptureOptions& options);
+
+	/**
+	 *	@brief	開啟影像來源 (重新開啟時幀序重新起算)
+	 *	@return	<b>型別: bool</b> \n 若開啟成功返回值為非零值 (true)。 \n 若開啟失敗返回值為零 (false)。
+	 */
+	virtual bool Open() = 0;
+
+	/**
+	 *	@brief	關閉影像來源
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Close() = 0;
+
+	/**
+	 *	@brief	讀取下一幀影像
+	 *	@param[out]	frame	影像緩衝區 handle (只有返回 SourceRead::Frame 時有效)
+	 *	@param[in]	pool	影像緩衝池
+	 *	@return	<b>型別: SourceRead</b> \n 讀取結果
+	 */
+	virtual SourceRead Read(CarFrame& frame, CarFramePool& pool) = 0;
+
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; }
+
+protected:
+	CarStreamMetrics*	m_metricsPtr;		//!< 擷取與解碼計時 (可為 nullptr)
+
+private:
+	CarFrameSource(const CarFrameSource&) = delete;				//!< Disable copy construction
+	CarFrameSource& operator=(const CarFrameSource&) = delete;	//!< Disable assignment operator
+};
+
+/**
+ *	@class	CarVideoSource
+ *	@brief	cv::VideoCapture 影像來源 (串流網址或影像檔案)
+ *	@remark	依解碼模式跳過的幀只呼叫 grab (解碼器仍會解碼該幀)，不 retrieve，不進行色彩轉換、縮放與緩衝區複製。
+ */
+class CarVideoSource : public CarFrameSource
+{
+public:
+	CarVideoSource(const cv::String& url, const CarCaptureOptions& options);
+	virtual ~CarVideoSource();
+
+	bool Open() override;
+	void Close() override;
+	SourceRead Read(CarFrame& frame, CarFramePool& pool) override;
+
+private:
+	bool IsDecodeFrame(uint64_t index);
+
+	cv::String			m_strUrl;		//!< 串流網址或影像檔案路徑
+	CarCaptureOptions	m_sOptions;		//!< 影像擷取選項
+	cv::VideoCapture	m_cCapture;		//!< 影像擷取物件
+	cv::Mat				m_imgTemp;		//!< 縮放前暫存影像
+	cv::Size			m_sourceSize;	//!< 解碼器輸出大小 (第一幀解碼後得知)
+	cv::Size			m_outputSize;	//!< 輸出影像大小，為空時保持解碼器輸出大小
+	cv::Size			m_frameSize;	//!< 上一幀緩衝區大小
+	int					m_nFrameType;	//!< 上一幀緩衝區型別
+	uint64_t			m_nIndex;		//!< 來源幀序 (含依解碼模式跳過的幀)
+	uint64_t			m_nNextIndex;	//!< 下一次必須解碼的幀序
+	std::chrono::steady_clock::time_point m_openTime;	//!< 開啟時間 (後端不提供時間戳記時使用)
+};
+
+/**
+ *	@class	CarReplaySource
+ *	@brief	錄製檔重播影像來源 (CarFrameRecorder 產生的錄製檔)
+ *	@remark	錄製檔以記憶體映射開啟，每幀由映射區複製至緩衝池緩衝區 (偵測端會在影像上繪製)。
+ *			可依錄製時間戳記送出 (重現原始速度與跳幀行為) 或盡快送出 (量測處理上限)，
+ *			循環播放時幀序與時間戳記接續遞增。
+ */
+class CarReplaySource : public CarFrameSource
+{
+public:
+	CarReplaySource(const cv::String& path, const CarCaptureOptions& options);
+	virtual ~CarReplaySource();
+
+	bool Open() override;
+	void Close() override;
+	SourceRead Read(CarFrame& frame, CarFramePool& pool) override;
+	uint64_t GetFrames() const { return m_nFrames; }
+
+private:
+	cv::String			m_strPath;		//!< 錄製檔路徑
+	CarCaptureOptions	m_sOptions;		//!< 影像擷取選項
+	CarMappedFile		m_cFile;		//!< 錄製檔映射
+	CarRecordHeader		m_sHeader;		//!< 錄製檔檔頭
+	uint64_t			m_nFrames;		//!< 錄製檔幀數
+	uint64_t			m_nNext;		//!< 下一幀位置
+	uint64_t			m_nIndexBase;	//!< 循環播放的幀序偏移
+	uint64_t			m_nLastIndex;	//!< 最近送出幀的錄製幀序
+	double				m_fTimeBase;	//!< 循環播放的時間戳記偏移 (ms)
+	double				m_fFirstTime;	//!< 錄製檔第一幀時間戳記 (ms)
+	double				m_fLastTime;	//!< 最近送出幀的錄製時間戳記 (ms)
+	std::chrono::steady_clock::time_point m_startTime;	//!< 重播起始時間 (對應錄製時間戳記 m_fFirstTime)
+};
+
+/**
+ *	@class	CarSyntheticSource
+ *	@brief	合成影像來源 (固定亂數種子產生的背景與移動中的車牌)
+ *	@remark	每段 CAR_SYNTH_PASS_FRAMES 幀內一面車牌由左至右橫越畫面，之後空白 CAR_SYNTH_GAP_FRAMES 幀
+ *			(畫面靜止)，下一段更換車牌文字。相同參數每次產生的影像完全相同，可在任何機器上重現。
+ */
+class CarSyntheticSource : public CarFrameSource
+{
+public:
+	CarSyntheticSource(const cv::Size& size, uint64_t frames, const CarCaptureOptions& options);
+	virtual ~CarSyntheticSource();
+
+	bool Open() override;
+	void Close() override;
+	SourceRead Read(CarFrame& frame, CarFramePool& pool) override;
+
+	static void GetPlateText(uint64_t plate, char* textPtr, size_t size);
+
+private:
+	CarCaptureOptions	m_sOptions;		//!< 影像擷取選項
+	cv::Size			m_size;			//!< 影像大小
+	uint64_t			m_nFrames;		//!< 總幀數，0 = 不限
+	uint64_t			m_nIndex;		//!< 下一幀幀序
+	cv::Mat				m_imgBackground;	//!< 背景影像 (開啟時產生)
+};
+
+/**
+ *	@class	CarFlakySource
+ *	@brief	斷線模擬影像來源 (包裝其他影像來源，用於在本機重現串流中斷與重新連接)
+ *	@remark	每次開啟後送出 frames 幀即模擬斷線: 之後的讀取都返回 SourceRead::Failed，hangMs 大於 0 時
+ *			每次讀取先阻塞 hangMs (模擬網路讀取卡住)。關閉後的前 fails 次開啟失敗，之後才重新開啟內部來源。
+ */
+class CarFlakySource : public CarFrameSource
+{
+public:
+	CarFlakySource(CarFrameSource* sourcePtr, uint64_t frames, int fails, int hangMs);
+	virtual ~CarFlakySource();
+
+	bool Open() override;
+	void Close() override;
+	SourceRead Read(CarFrame& frame, CarFramePool& pool) override;
+
+private:
+	std::unique_ptr<CarFrameSource> m_cSource;	//!< 內部影像來源
+	uint64_t			m_nFrames;		//!< 每次連接送出的幀數，0 = 不斷線
+	int					m_nFails;		//!< 斷線後開啟失敗次數
+	int					m_nHangMs;		//!< 斷線期間每次讀取阻塞時間 (ms)
+	uint64_t			m_nCount;		//!< 本次連接已送出幀數
+	int					m_nFailed;		//!< 本次斷線後已失敗的開啟次數
+	bool				m_isDown;		//!< 是否處於斷線狀態
+};
+
+#endif // !ODMC_CARPLATE_SOURCE_HH
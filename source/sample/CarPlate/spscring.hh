@@ -0,0 +1,316 @@
+﻿/**************************************************************************//**
+ * @file	spscring.hh
+ * @brief	CarSpscRing 單一生產者/單一消費者環形佇列樣板 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_SPSCRING_HH
+#define	ODMC_CARPLATE_SPSCRING_HH
+#include <memory>
+#include "carcore.hh"
+
+/**
+ *	@enum	RingOverflow
+ *	@brief	佇列已滿時的處理方式
+ */
+enum class RingOverflow {
+	DropOldest = 0,		//!< 丟棄最舊的項目，保留最新項目
+	DropNewest,			//!< 丟棄要放入的項目
+	Block,				//!< 等待消費者取出項目
+};
+
+/**
+ *	@class	CarSpscRing
+ *	@brief	固定容量單一生產者/單一消費者環形佇列
+ *	@remark	每個槽位帶有序號 (sequence)，生產者與消費者以 acquire/release 交換槽位所有權，
+ *			正常路徑不需要鎖。放入與取出皆以 swap 交換內容，槽位內的物件 (如 cv::Mat 緩衝區)
+ *			會回到呼叫端重複使用。只有佇列空 (或 Block 模式下滿) 時才透過 condition variable 休眠等待。
+ *			DropOldest 模式下生產者會與消費者競爭 tail 索引以丟棄最舊項目，因此 tail 以 CAS 更新。
+ */
+template <typename T>
+class CarSpscRing
+{
+public:
+	explicit CarSpscRing(size_t capacity = CAR_RING_CAPACITY, RingOverflow overflow = RingOverflow::DropOldest);
+	virtual ~CarSpscRing() {}
+
+	bool Push(T& item);
+	bool Pop(T& item, int timeoutMs = -1);
+	void Close();
+
+	size_t GetCapacity() const { return m_nCapacity; }
+	size_t GetSize() const;
+	uint64_t GetProduced() const { return m_nProduced.load(std::memory_order_relaxed); }
+	uint64_t GetConsumed() const { return m_nConsumed.load(std::memory_order_relaxed); }
+	uint64_t GetDropped() const { return m_nDropped.load(std::memory_order_relaxed); }
+	bool IsClosed() const { return m_isClosed.load(std::memory_order_acquire); }
+	void SetOverflow(RingOverflow overflow) { m_eOverflow = overflow; }
+
+private:
+	CarSpscRing(const CarSpscRing&) = delete;				//!< Disable copy construction
+	CarSpscRing& operator=(const CarSpscRing&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Slot
+	 *	@brief	環形佇列槽位
+	 */
+	struct Slot {
+		std::atomic<size_t>	seq;	//!< 槽位序號: 等於 head 表示可寫入，等於 tail + 1 表示可讀取
+		T					item;	//!< 槽位內容
+	};
+
+	bool WaitNotEmpty(int timeoutMs);
+	void WaitNotFull();
+	void WakeConsumer();
+	void WakeProducer();
+
+	std::unique_ptr<Slot[]>	m_slots;					//!< 槽位陣列
+	size_t					m_nCapacity;				//!< 容量 (2 的次方)
+	size_t					m_nMask;					//!< 索引遮罩
+	RingOverflow			m_eOverflow;				//!< 佇列已滿處理方式
+
+	char					m_padHead[64];				//!< 分隔 cache line，避免 false sharing
+	std::atomic<size_t>		m_nHead;					//!< 下一個寫入位置 (只有生產者寫入)
+	char					m_padTail[64];				//!< 分隔 cache line，避免 false sharing
+	std::atomic<size_t>		m_nTail;					//!< 下一個讀取位置 (CAS 更新)
+	char					m_padState[64];				//!< 分隔 cache line，避免 false sharing
+
+	std::atomic<bool>		m_isClosed;					//!< 佇列是否已關閉
+	std::atomic<bool>		m_isConsumerWaiting;		//!< 消費者是否休眠中
+	std::atomic<bool>		m_isProducerWaiting;		//!< 生產者是否休眠中
+	std::atomic<uint64_t>	m_nProduced;				//!< 放入項目數量
+	std::atomic<uint64_t>	m_nConsumed;				//!< 取出項目數量
+	std::atomic<uint64_t>	m_nDropped;					//!< 丟棄項目數量
+	std::mutex				m_mutex;					//!< 休眠等待用 mutex
+	std::condition_variable	m_cvNotEmpty;				//!< 佇列非空通知
+	std::condition_variable	m_cvNotFull;				//!< 佇列非滿通知
+};
+
+/**
+ *	@brief	CarSpscRing 建構式
+ *	@param[in]	capacity	容量 (向上取 2 的次方，最小為 2)
+ *	@param[in]	overflow	佇列已滿處理方式
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+CarSpscRing<T>::CarSpscRing(size_t capacity, RingOverflow overflow)
+	: m_nCapacity(2)
+	, m_eOverflow(overflow)
+	, m_nHead(0)
+	, m_nTail(0)
+	, m_isClosed(false)
+	, m_isConsumerWaiting(false)
+	, m_isProducerWaiting(false)
+	, m_nProduced(0)
+	, m_nConsumed(0)
+	, m_nDropped(0) {
+	while (m_nCapacity < capacity) m_nCapacity <<= 1;
+	m_nMask = m_nCapacity - 1;
+	m_slots.reset(new Slot[m_nCapacity]);
+	for (size_t i = 0; i < m_nCapacity; i++) {
+		m_slots[i].seq.store(i, std::memory_order_relaxed);
+	}
+}
+
+/**
+ *	@brief	放入項目 (只能由生產者呼叫)
+ *	@param[in,out]	item	要放入的項目，返回時換成槽位原本的內容 (可重複使用的緩衝區)。
+ *	@return	<b>型別: bool</b> \n 若放入成功返回值為非零值 (true)。 \n 若項目被丟棄 (DropNewest) 或佇列已關閉返回值為零 (false)。
+ */
+template <typename T>
+bool CarSpscRing<T>::Push(T& item)
+{
+	const size_t head = m_nHead.load(std::memory_order_relaxed);
+	Slot& slot = m_slots[head & m_nMask];
+
+	for (;;) {
+		if (m_isClosed.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		// 槽位可寫入
+		if (slot.seq.load(std::memory_order_acquire) == head) {
+			using std::swap;
+			swap(slot.item, item);
+			slot.seq.store(head + 1, std::memory_order_release);
+			m_nHead.store(head + 1, std::memory_order_release);
+			m_nProduced.fetch_add(1, std::memory_order_relaxed);
+			this->WakeConsumer();
+			return true;
+		}
+
+		// 槽位尚未被取出 (佇列已滿) 或消費者正在交換內容
+		switch (m_eOverflow) {
+		case RingOverflow::DropNewest:
+			m_nDropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+
+		case RingOverflow::DropOldest: {
+			size_t tail = m_nTail.load(std::memory_order_acquire);
+			if (tail + m_nCapacity == head && m_nTail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+				// 取得最舊槽位所有權，直接標示為可寫入 (內容保留作為緩衝區)
+				m_slots[tail & m_nMask].seq.store(tail + m_nCapacity, std::memory_order_release);
+				m_nDropped.fetch_add(1, std::memory_order_relaxed);
+			}
+			else std::this_thread::yield();
+			break;
+		}
+
+		default:
+			this->WaitNotFull();
+			break;
+		}
+	}
+}
+
+/**
+ *	@brief	取出最舊的項目 (只能由消費者呼叫)
+ *	@param[in,out]	item		存放取出的項目，原本的內容換入槽位供生產者重複使用。
+ *	@param[in]		timeoutMs	佇列為空時最長等待時間 (ms)，0 = 不等待，負值 = 持續等待至有項目或佇列關閉。
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或佇列已關閉且為空返回值為零 (false)。
+ */
+template <typename T>
+bool CarSpscRing<T>::Pop(T& item, int timeoutMs)
+{
+	size_t tail = m_nTail.load(std::memory_order_acquire);
+
+	for (;;) {
+		Slot& slot = m_slots[tail & m_nMask];
+		const size_t seq = slot.seq.load(std::memory_order_acquire);
+
+		if (seq == tail + 1) {
+			if (m_nTail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				using std::swap;
+				swap(slot.item, item);
+				slot.seq.store(tail + m_nCapacity, std::memory_order_release);
+				m_nConsumed.fetch_add(1, std::memory_order_relaxed);
+				this->WakeProducer();
+				return true;
+			}
+			continue;
+		}
+
+		// 槽位尚未寫入，佇列為空
+		if (seq == tail) {
+			if (!this->WaitNotEmpty(timeoutMs)) {
+				return false;
+			}
+		}
+		tail = m_nTail.load(std::memory_order_acquire);
+	}
+}
+
+/**
+ *	@brief	取得佇列內項目數量 (近似值，可由任何 thread 呼叫)
+ *	@return	<b>型別: size_t</b> \n 項目數量 (0 ~ 容量)
+ *	@remark	先讀取 tail 再讀取 head，讀取期間 tail 只會增加，因此差值不會因 tail 前進而下溢。
+ *			消費者可能在生產者發布 head 前先取出該槽位 (tail 暫時超過 head)，結果限制於 0 ~ 容量。
+ */
+template <typename T>
+size_t CarSpscRing<T>::GetSize() const
+{
+	const size_t tail = m_nTail.load(std::memory_order_acquire);
+	const size_t head = m_nHead.load(std::memory_order_acquire);
+	if (head <= tail) {
+		return 0;
+	}
+	return std::min(head - tail, m_nCapacity);
+}
+
+/**
+ *	@brief	關閉佇列，喚醒所有等待中的生產者與消費者
+ *	@return	此函數沒有返回值
+ *	@remark	關閉後無法再放入項目，消費者仍可取出剩餘項目。
+ */
+template <typename T>
+void CarSpscRing<T>::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_isClosed.store(true, std::memory_order_release);
+	m_cvNotEmpty.notify_all();
+	m_cvNotFull.notify_all();
+}
+
+/**
+ *	@brief	等待佇列非空
+ *	@param[in]	timeoutMs	最長等待時間 (ms)，0 = 不等待，負值 = 持續等待。
+ *	@return	<b>型別: bool</b> \n 若佇列非空返回值為非零值 (true)。 \n 若逾時或佇列已關閉返回值為零 (false)。
+ */
+template <typename T>
+bool CarSpscRing<T>::WaitNotEmpty(int timeoutMs)
+{
+	auto isReady = [this]() {
+		return m_nHead.load(std::memory_order_acquire) != m_nTail.load(std::memory_order_acquire)
+			|| m_isClosed.load(std::memory_order_acquire);
+	};
+
+	if (timeoutMs == 0) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_isConsumerWaiting.store(true);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (timeoutMs < 0) {
+		m_cvNotEmpty.wait(lock, isReady);
+	}
+	else {
+		m_cvNotEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs), isReady);
+	}
+	m_isConsumerWaiting.store(false);
+
+	return m_nHead.load(std::memory_order_acquire) != m_nTail.load(std::memory_order_acquire);
+}
+
+/**
+ *	@brief	等待佇列非滿 (Block 模式)
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+void CarSpscRing<T>::WaitNotFull()
+{
+	auto isReady = [this]() {
+		return m_nHead.load(std::memory_order_acquire) - m_nTail.load(std::memory_order_acquire) < m_nCapacity
+			|| m_isClosed.load(std::memory_order_acquire);
+	};
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_isProducerWaiting.store(true);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!m_cvNotFull.wait_for(lock, std::chrono::milliseconds(CAR_RING_WAIT_MS), isReady)) {
+		// 逾時只是保險，返回後由 Push 重新檢查
+	}
+	m_isProducerWaiting.store(false);
+}
+
+/**
+ *	@brief	若消費者休眠中則喚醒
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+void CarSpscRing<T>::WakeConsumer()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_isConsumerWaiting.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cvNotEmpty.notify_one();
+	}
+}
+
+/**
+ *	@brief	若生產者休眠中則喚醒
+ *	@return	此函數沒有返回值
+ */
+template <typename T>
+void CarSpscRing<T>::WakeProducer()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_isProducerWaiting.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cvNotFull.notify_one();
+	}
+}
+
+#endif // !ODMC_CARPLATE_SPSCRING_HH
@@ -0,0 +1,695 @@
+﻿/**************************************************************************//**
+ * @file	stagegraph.cc
+ * @brief	CarStageGraph 與各節點類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "stagegraph.hh"
+
+/**
+ *	@brief	CarMotionStage 建構式
+ *	@param[in]	options	畫面變化偵測選項
+ *	@return	此函數沒有返回值
+ */
+CarMotionStage::CarMotionStage(const CarMotionOptions& options)
+	: m_sOptions(options) {
+	m_cDetector.SetMotionOptions(options);
+}
+
+/**
+ *	@brief	[重載] 畫面變化偵測，靜止時標記此幀由後續節點略過。
+ */
+bool CarMotionStage::Process(CarStageFrame& stageFrame)
+{
+	stageFrame.isIdle = !m_cDetector.ImageMotion(stageFrame.frame.Image());
+	return true;
+}
+
+/**
+ *	@brief	CarTrackStage 建構式
+ *	@param[in]	tracker	車牌位置追蹤 (stage graph 持有，節點存在期間必須保持有效)
+ *	@return	此函數沒有返回值
+ */
+CarTrackStage::CarTrackStage(CarPlateTracker& tracker)
+	: m_cTracker(tracker) {
+}
+
+/**
+ *	@brief	[重載] 依車牌軌跡設定此幀搜尋區域
+ */
+bool CarTrackStage::Process(CarStageFrame& stageFrame)
+{
+	m_cTracker.Predict(stageFrame.index, stageFrame.frame.Image().size(), stageFrame.regions);
+	return true;
+}
+
+/**
+ *	@brief	[重載] 灰階轉換 (搜尋區域內)
+ */
+bool CarGrayscaleStage::Process(CarStageFrame& stageFrame)
+{
+	auto& imgFrame = stageFrame.frame.Image();
+	if (imgFrame.empty()) {
+		return false;
+	}
+
+	m_cDetector.ImageGrayscale(imgFrame, stageFrame.imgGrayscale, stageFrame.regions);
+	return stageFrame.imgGrayscale.data != nullptr;
+}
+
+/**
+ *	@brief	[重載] 提高灰階影像對比 (搜尋區域內)
+ */
+bool CarContrastStage::Process(CarStageFrame& stageFrame)
+{
+	m_cDetector.ImageContrast(stageFrame.imgGrayscale, stageFrame.imgContrast, stageFrame.regions);
+	return stageFrame.imgContrast.data != nullptr;
+}
+
+/**
+ *	@brief	[重載] 平滑化與二值化 (搜尋區域內)
+ */
+bool CarPreprocessStage::Process(CarStageFrame& stageFrame)
+{
+	return m_cDetector.ImageThreshold(stageFrame.imgContrast, stageFrame.imgThresh, stageFrame.regions);
+}
+
+/**
+ *	@brief	[重載] 分塊完成灰階至二值化 (搜尋區域內)
+ */
+bool CarTiledStage::Process(CarStageFrame& stageFrame)
+{
+	auto& imgFrame = stageFrame.frame.Image();
+	if (imgFrame.empty()) {
+		return false;
+	}
+
+	return m_cDetector.ImagePreprocess(imgFrame, stageFrame.imgGrayscale, stageFrame.imgThresh, stageFrame.regions);
+}
+
+/**
+ *	@brief	[重載] 標記連通元件並篩選車牌候選區域 (搜尋區域內)
+ */
+bool CarContoursStage::Process(CarStageFrame& stageFrame)
+{
+	return m_cDetector.ImageCandidates(stageFrame.frame.Image(), stageFrame.imgThresh, stageFrame.regions, stageFrame.components, stageFrame.candidates);
+}
+
+/**
+ *	@brief	CarRecognizeStage 建構式
+ *	@param[in]	modelFile	二進位模型檔路徑
+ *	@param[in]	classFile	字元訓練標籤檔 (XML)
+ *	@param[in]	imageFile	字元訓練影像檔 (XML)
+ *	@return	此函數沒有返回值
+ */
+CarRecognizeStage::CarRecognizeStage(const char* modelFile, const cv::String& classFile, const cv::String& imageFile)
+	: m_strModelFile((modelFile != nullptr) ? modelFile : "")
+	, m_strClassFile(classFile)
+	, m_strImageFile(imageFile) {
+}
+
+/**
+ *	@brief	[重載] 建立使用相同模型檔的節點 (各自載入模型)
+ */
+std::unique_ptr<CarStage> CarRecognizeStage::Clone() const
+{
+	const char* modelFile = m_strModelFile.empty() ? nullptr : m_strModelFile.c_str();
+	return std::unique_ptr<CarStage>(new (std::nothrow) CarRecognizeStage(modelFile, m_strClassFile, m_strImageFile));
+}
+
+/**
+ *	@brief	[重載] 載入字元辨識模型，載入失敗時只進行車牌定位。
+ */
+bool CarRecognizeStage::Prepare()
+{
+	if (!m_strModelFile.empty()) {
+		m_cDetector.LoadOcr(m_strModelFile.c_str(), m_strClassFile, m_strImageFile);
+	}
+	return true;
+}
+
+/**
+ *	@brief	[重載] 辨識車牌候選區域文字
+ */
+bool CarRecognizeStage::Process(CarStageFrame& stageFrame)
+{
+	m_cDetector.ImageRecognize(stageFrame.frame.Image(), stageFrame.imgGrayscale, stageFrame.candidates, stageFrame.reads);
+	return true;
+}
+
+/**
+ *	@brief	[重載] 疊合輪廓圖層
+ */
+bool CarMatchStage::Process(CarStageFrame& stageFrame)
+{
+	m_cDetector.ImageMatch(stageFrame.frame.Image(), stageFrame.imgThresh, stageFrame.candidates);
+	return true;
+}
+
+/**
+ *	@brief	CarStageGraph 建構式
+ *	@return	此函數沒有返回值
+ */
+CarStageGraph::CarStageGraph()
+	: m_nWorkers(1)
+	, m_nOrdered(0)
+	, m_nThreads(CAR_PARALLEL_THREADS)
+	, m_sourcePtr(nullptr)
+	, m_metricsPtr(nullptr)
+	, m_isKeep(false)
+	, m_nFinished(0) {
+}
+
+/**
+ *	@brief	CarStageGraph 解構式
+ *	@return	此函數沒有返回值
+ */
+CarStageGraph::~CarStageGraph()
+{
+	this->Stop();
+}
+
+/**
+ *	@brief	加入節點 (連接於最後一個節點之後)，必須於啟動前呼叫。
+ *	@param[in]	stage	節點物件，所有權轉移至 stage graph。
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::AddStage(std::unique_ptr<CarStage> stage)
+{
+	if (stage != nullptr && !this->IsRunning()) {
+		m_vecStages.push_back(std::move(stage));
+	}
+}
+
+/**
+ *	@brief	移除所有節點，必須於啟動前呼叫。
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::ClearStages()
+{
+	if (!this->IsRunning()) {
+		m_vecStages.clear();
+	}
+}
+
+/**
+ *	@brief	建立預設車牌偵測節點: (畫面變化) → (追蹤) → 灰階 → 對比 → 二值化 → 連通元件與候選 → 字元辨識 → 疊圖
+ *	@param[in]	modelFile	二進位模型檔路徑，nullptr 時不進行字元辨識。
+ *	@param[in]	classFile	字元訓練標籤檔 (XML)
+ *	@param[in]	imageFile	字元訓練影像檔 (XML)
+ *	@param[in]	motion		畫面變化偵測選項，啟用時於最前面加入畫面變化偵測節點。
+ *	@param[in]	track		車牌位置追蹤選項，啟用時於灰階轉換前加入追蹤節點。
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::SetDefaultStages(const char* modelFile, const cv::String& classFile, const cv::String& imageFile, const CarMotionOptions& motion, const CarTrackOptions& track)
+{
+	this->ClearStages();
+	if (motion.isEnabled) {
+		this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarMotionStage(motion)));
+	}
+	m_cTracker.SetOptions(track);
+	if (track.isEnabled) {
+		this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarTrackStage(m_cTracker)));
+	}
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarGrayscaleStage()));
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarContrastStage()));
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarPreprocessStage()));
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarContoursStage()));
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarRecognizeStage(modelFile, classFile, imageFile)));
+	this->AddStage(std::unique_ptr<CarStage>(new (std::nothrow) CarMatchStage()));
+}
+
+/**
+ *	@brief	啟動來源與各節點 threads (幀平行模式為來源與各 worker threads)
+ *	@param[in]	source		影像來源通道，停止前必須保持有效。
+ *	@param[in]	intervalMs	最小處理間隔 (ms)，間隔內的影像跳過不處理，0 = 處理每一幀 (已設定速率控制時依負載放大)。
+ *	@param[in]	depth		同時處理中的幀數上限 (幀平行模式至少為 worker 數量)
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若啟動失敗或節點不支援幀平行模式返回值為零 (false)。
+ */
+bool CarStageGraph::Start(CarFrameChannel& source, int intervalMs, size_t depth)
+{
+	this->Stop();
+
+	const size_t stageCount = m_vecStages.size();
+	const bool isParallel = m_nWorkers > 1;
+	depth = std::max<size_t>(depth, isParallel ? m_nWorkers : 1);
+
+	for (;;) {
+		if (stageCount == 0) break;
+		if (isParallel && !this->PrepareLanes()) break;
+
+		bool isReady = true;
+		for (auto& stage : m_vecStages) {
+			isReady = isReady && stage->Prepare();
+		}
+		for (auto& stage : m_vecClones) {
+			isReady = isReady && stage->Prepare();
+		}
+		if (!isReady) break;
+
+		// 每個節點一個輸入佇列，另加一個輸出佇列。處理資料物件只有 depth 個，佇列容量足夠時 Push 不會阻塞。
+		// 幀平行模式不使用節點佇列，輸出端依序號重新排序 (同時存在的序號範圍不超過 depth)。
+		m_vecQueues.clear();
+		if (isParallel) {
+			m_cReorder.Reset(depth);
+		}
+		else {
+			for (size_t i = 0; i <= stageCount; i++) {
+				m_vecQueues.emplace_back(new (std::nothrow) StageQueue(depth, RingOverflow::Block));
+				if (m_vecQueues.back() == nullptr) break;
+			}
+			if (m_vecQueues.size() != stageCount + 1 || m_vecQueues.back() == nullptr) break;
+		}
+
+		m_cFreeQueue.reset(new (std::nothrow) StageQueue(depth, RingOverflow::Block));
+		if (m_cFreeQueue == nullptr) break;
+
+		m_vecFrames.clear();
+		for (size_t i = 0; i < depth; i++) {
+			std::unique_ptr<CarStageFrame> stageFrame(new (std::nothrow) CarStageFrame());
+			if (stageFrame == nullptr) break;
+
+			CarStageFrame* stageFramePtr = stageFrame.get();
+			m_cFreeQueue->Push(stageFramePtr);
+			m_vecFrames.push_back(std::move(stageFrame));
+		}
+		if (m_vecFrames.size() != depth) break;
+
+		for (auto& stage : m_vecStages) {
+			stage->SetMetrics(m_metricsPtr);
+			stage->SetThreads(m_nThreads);
+		}
+		for (auto& stage : m_vecClones) {
+			stage->SetMetrics(m_metricsPtr);
+			stage->SetThreads(m_nThreads);
+		}
+
+		CarRateOptions rateOptions = m_sRateOptions;
+		rateOptions.minIntervalMs = std::max(rateOptions.minIntervalMs, intervalMs);
+		m_cRate.SetOptions(rateOptions);
+		m_cTracker.SetMetrics(m_metricsPtr);
+		m_cTracker.Reset();
+		m_cVoter.SetOptions(m_sVoteOptions);
+
+		m_sourcePtr = &source;
+		m_nFinished.store(0);
+		m_isKeep.store(true);
+
+		bool isStarted = true;
+		std::thread* threadPtr = new (std::nothrow) std::thread(&CarStageGraph::SourceProcess, this);
+		isStarted = threadPtr != nullptr;
+		if (isStarted) m_vecThreads.push_back(threadPtr);
+
+		for (size_t i = 0; i < stageCount && isStarted && !isParallel; i++) {
+			threadPtr = new (std::nothrow) std::thread(&CarStageGraph::StageProcess, this, i);
+			isStarted = threadPtr != nullptr;
+			if (isStarted) m_vecThreads.push_back(threadPtr);
+		}
+		for (size_t i = 0; i < m_vecLanes.size() && isStarted && isParallel; i++) {
+			threadPtr = new (std::nothrow) std::thread(&CarStageGraph::WorkerProcess, this, i);
+			isStarted = threadPtr != nullptr;
+			if (isStarted) m_vecThreads.push_back(threadPtr);
+		}
+		if (!isStarted) break;
+		return true;
+	}
+
+	this->Stop();
+	return false;
+}
+
+/**
+ *	@brief	停止所有 threads，處理中的影像緩衝區歸還緩衝池。
+ *	@return	此函數沒有返回值
+ *	@remark	Pop 取得但尚未 Release 的處理資料物件於停止後失效。
+ */
+void CarStageGraph::Stop()
+{
+	m_isKeep.store(false);
+	for (auto& queue : m_vecQueues) {
+		if (queue != nullptr) queue->Close();
+	}
+	if (m_cFreeQueue != nullptr) {
+		m_cFreeQueue->Close();
+	}
+	m_cReorder.Close();
+	{
+		std::lock_guard<std::mutex> lock(m_mutexWork);
+		m_cvWork.notify_all();
+	}
+
+	for (auto& threadPtr : m_vecThreads) {
+		if (threadPtr->joinable()) {
+			threadPtr->join();
+		}
+		SAFE_DELETE(threadPtr);
+	}
+	m_vecThreads.clear();
+
+	m_vecQueues.clear();
+	m_cFreeQueue.reset();
+	m_dequeWork.clear();
+	m_vecLanes.clear();
+	m_vecClones.clear();
+	m_nOrdered = 0;
+	m_vecFrames.clear();
+	m_sourcePtr = nullptr;
+}
+
+/**
+ *	@brief	取出處理完成的影像，處理失敗的影像直接歸還不輸出。
+ *	@param[out]	stageFramePtr	(指標參考) 處理資料物件，使用完畢後必須呼叫 Release 歸還。
+ *	@param[in]	timeoutMs		最長等待時間 (ms)，0 = 不等待，負值 = 持續等待。
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或已停止返回值為零 (false)。
+ */
+bool CarStageGraph::Pop(CarStageFrame*& stageFramePtr, int timeoutMs)
+{
+	stageFramePtr = nullptr;
+	if (!this->IsRunning()) {
+		return false;
+	}
+
+	while (this->PopOutput(stageFramePtr, timeoutMs)) {
+		m_nFinished.fetch_add(1, std::memory_order_release);
+
+		// 靜止畫面只經過畫面變化偵測，不代表偵測成本，不列入速率控制
+		if (!stageFramePtr->isIdle) {
+			m_cRate.Update(stageFramePtr->cost, stageFramePtr->work, std::chrono::steady_clock::now() - stageFramePtr->sourceTime);
+		}
+		if (stageFramePtr->isValid) {
+			if (!stageFramePtr->isIdle) {
+				m_cTracker.Update(stageFramePtr->index, stageFramePtr->regions, stageFramePtr->candidates);
+				if (m_metricsPtr != nullptr) {
+					m_metricsPtr->AddProcessed();
+				}
+			}
+
+			// 靜止畫面沒有候選區域，仍需結束逾時的軌跡
+			m_cVoter.Update(stageFramePtr->index, stageFramePtr->candidates, stageFramePtr->reads, stageFramePtr->events);
+			return true;
+		}
+		this->Release(stageFramePtr);
+		stageFramePtr = nullptr;
+	}
+	return false;
+}
+
+/**
+ *	@brief	歸還處理資料物件，影像緩衝區歸還緩衝池，來源 thread 可繼續取幀。
+ *	@param[in]	stageFramePtr	(指標) Pop 取得的處理資料物件
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::Release(CarStageFrame* stageFramePtr)
+{
+	if (stageFramePtr == nullptr || m_cFreeQueue == nullptr) {
+		return;
+	}
+
+	stageFramePtr->frame.Release();
+	m_cFreeQueue->Push(stageFramePtr);
+}
+
+/**
+ *	@brief	來源 thread process: 取得閒置處理資料物件後由影像通道取幀，並依速率控制的處理間隔跳幀。
+ *			影像來源停滯時等待通道發布的連線狀態恢復。
+ *	@param[in]	cThisPtr	(指標) CarStageGraph 物件
+ *	@remark	處理序號只增不減: 串流重新連接後擷取端幀序由 0 重新起算，此時以前一個處理序號為基準重新對齊，
+ *			追蹤、投票與重複車牌抑制的幀數間隔不會因幀序倒退而失效。
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::SourceProcess(CarStageGraph* cThisPtr)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	auto& source = *cThisPtr->m_sourcePtr;
+	auto metricsPtr = cThisPtr->m_metricsPtr;
+	const bool isLatestOnly = source.IsLatestOnly();
+	auto& rate = cThisPtr->m_cRate;
+	Clock::time_point prevTime;		// 第一幀立即處理
+	uint64_t lastIndex = 0;			// 前一個處理序號
+	uint64_t indexBase = 0;			// 擷取端幀序對齊至處理序號的偏移 (重新連接時更新)
+	bool isIndexed = false;
+	uint64_t sequence = 0;
+	bool isStalled = false;
+
+	CarStageFrame* stageFramePtr = nullptr;
+	while (cThisPtr->m_isKeep.load()) {
+		// 所有處理資料物件都在管線中 (輸出端未取走) 時暫停取幀，最新影像信箱期間由擷取端覆寫。
+		if (stageFramePtr == nullptr && !cThisPtr->m_cFreeQueue->Pop(stageFramePtr, CAR_RING_WAIT_MS)) {
+			stageFramePtr = nullptr;
+			continue;
+		}
+
+		// 跳幀處理 (最新影像信箱): 未到處理時間前不取出影像，處理間隔每次重新讀取
+		const Clock::duration interval = rate.GetInterval();
+		auto nextTime = Clock::now();
+		if (isLatestOnly && (nextTime - prevTime) < interval) {
+			auto waitTime = std::min<Clock::duration>(interval - (nextTime - prevTime), std::chrono::milliseconds(CAR_RING_WAIT_MS));
+			std::this_thread::sleep_for(waitTime);
+			continue;
+		}
+
+		auto& frame = stageFramePtr->frame;
+		frame.Release();
+		if (!source.Pop(frame, CAR_RING_WAIT_MS)) {
+			// 影像來源停滯 (重新連接中或超過停滯時間沒有影像): 等待擷取端恢復，不反覆輪詢空的通道
+			if (source.IsStalled()) {
+				if (!isStalled && metricsPtr != nullptr) {
+					metricsPtr->AddStall();
+				}
+				isStalled = true;
+				source.WaitResume(CAR_RING_WAIT_MS);
+			}
+			continue;
+		}
+		// 來源恢復後第一幀立即處理 (停滯期間不計入處理間隔)
+		if (isStalled) {
+			isStalled = false;
+			prevTime = Clock::time_point();
+		}
+		// 擷取端附加幀序時沿用 (擷取端跳過的幀同樣計入)，否則依取出順序編號；
+		// 幀序倒退 (串流重新連接後由 0 起算) 時重新對齊，處理序號接續前一幀
+		uint64_t index = isIndexed ? lastIndex + 1 : 0;
+		if (frame.IsStamped()) {
+			if (isIndexed && frame.Index() + indexBase <= lastIndex) {
+				indexBase = lastIndex + 1 - frame.Index();
+			}
+			index = frame.Index() + indexBase;
+		}
+		stageFramePtr->index = index;
+		lastIndex = index;
+		isIndexed = true;
+
+		if (metricsPtr != nullptr) {
+			CarChannelStats stats;
+			source.GetStats(stats);
+			metricsPtr->SampleQueue(stats.pending);
+		}
+
+		// 跳幀處理 (FIFO 佇列): 處理間隔內取出的影像直接丟棄
+		nextTime = Clock::now();
+		if (!isLatestOnly && (nextTime - prevTime) < interval) {
+			if (metricsPtr != nullptr) {
+				metricsPtr->AddSkipped();
+			}
+			continue;
+		}
+		prevTime = nextTime;
+
+		stageFramePtr->sourceTime = nextTime;
+		stageFramePtr->cost = Clock::duration::zero();
+		stageFramePtr->work = Clock::duration::zero();
+		stageFramePtr->candidates.clear();
+		stageFramePtr->reads.clear();
+		stageFramePtr->regions.assign(1, cv::Rect(cv::Point(), frame.Image().size()));
+		stageFramePtr->events.clear();
+		stageFramePtr->isValid = true;
+		stageFramePtr->isIdle = false;
+		stageFramePtr->sequence = sequence++;
+		if (!cThisPtr->Dispatch(stageFramePtr)) {
+			break;
+		}
+		stageFramePtr = nullptr;
+	}
+
+	if (stageFramePtr != nullptr) {
+		stageFramePtr->frame.Release();
+	}
+}
+
+/**
+ *	@brief	節點 thread process: 由輸入佇列取出處理資料，處理後放入下一個節點的佇列。
+ *	@param[in]	cThisPtr	(指標) CarStageGraph 物件
+ *	@param[in]	index		節點編號
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::StageProcess(CarStageGraph* cThisPtr, size_t index)
+{
+	auto& stage = *cThisPtr->m_vecStages[index];
+	auto& input = *cThisPtr->m_vecQueues[index];
+	auto& output = *cThisPtr->m_vecQueues[index + 1];
+
+	CarStageFrame* stageFramePtr = nullptr;
+	while (cThisPtr->m_isKeep.load()) {
+		if (!input.Pop(stageFramePtr, CAR_RING_WAIT_MS)) {
+			continue;
+		}
+
+		CarStageGraph::RunStage(stage, *stageFramePtr);
+		if (!output.Push(stageFramePtr)) {
+			break;
+		}
+	}
+}
+
+/**
+ *	@brief	worker thread process (幀平行模式): 取出等待處理的幀，依序完成此 worker 的所有節點後放入重新排序緩衝區。
+ *	@param[in]	cThisPtr	(指標) CarStageGraph 物件
+ *	@param[in]	index		worker 編號
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::WorkerProcess(CarStageGraph* cThisPtr, size_t index)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const auto& lane = cThisPtr->m_vecLanes[index];
+	const auto workers = static_cast<Clock::duration::rep>(cThisPtr->m_nWorkers);
+
+	while (cThisPtr->m_isKeep.load()) {
+		CarStageFrame* stageFramePtr = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(cThisPtr->m_mutexWork);
+			cThisPtr->m_cvWork.wait_for(lock, std::chrono::milliseconds(CAR_RING_WAIT_MS), [cThisPtr]() {
+				return !cThisPtr->m_dequeWork.empty() || !cThisPtr->m_isKeep.load();
+			});
+			if (cThisPtr->m_dequeWork.empty()) {
+				continue;
+			}
+			stageFramePtr = cThisPtr->m_dequeWork.front();
+			cThisPtr->m_dequeWork.pop_front();
+		}
+
+		// 前置節點於來源 thread 依序執行，其成本不分攤；worker 節點由 workers 個 thread 同時處理，吞吐量成本依數量分攤。
+		const auto orderedCost = stageFramePtr->cost;
+		const auto orderedWork = stageFramePtr->work;
+		for (auto stagePtr : lane) {
+			CarStageGraph::RunStage(*stagePtr, *stageFramePtr);
+		}
+		stageFramePtr->cost = std::max(orderedCost, (stageFramePtr->work - orderedWork) / workers);
+		stageFramePtr->finishTime = Clock::now();
+
+		if (!cThisPtr->m_cReorder.Push(stageFramePtr->sequence, stageFramePtr)) {
+			break;
+		}
+	}
+}
+
+/**
+ *	@brief	執行單一節點並累計處理時間，前一個節點處理失敗或畫面靜止時略過。
+ *	@param[in]		stage		節點物件
+ *	@param[in,out]	stageFrame	處理資料
+ *	@return	此函數沒有返回值
+ */
+void CarStageGraph::RunStage(CarStage& stage, CarStageFrame& stageFrame)
+{
+	if (!stageFrame.isValid || stageFrame.isIdle) {
+		return;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+	stageFrame.isValid = stage.Process(stageFrame);
+
+	const auto elapsed = std::chrono::steady_clock::now() - startTime;
+	stageFrame.cost = std::max(stageFrame.cost, elapsed);
+	stageFrame.work += elapsed;
+}
+
+/**
+ *	@brief	建立幀平行模式各 worker 的節點列表，第一個 worker 使用原節點，其餘 worker 使用節點複本。
+ *	@return	<b>型別: bool</b> \n 若建立成功返回值為非零值 (true)。 \n 若依幀序處理的節點不在最前面或節點不支援複製返回值為零 (false)。
+ */
+bool CarStageGraph::PrepareLanes()
+{
+	m_vecLanes.clear();
+	m_vecClones.clear();
+
+	// 依幀序處理的節點只能位於最前面，由來源 thread 依序執行
+	m_nOrdered = 0;
+	while (m_nOrdered < m_vecStages.size() && m_vecStages[m_nOrdered]->IsOrdered()) {
+		m_nOrdered++;
+	}
+
+	for (size_t w = 0; w < m_nWorkers; w++) {
+		std::vector<CarStage*> lane;
+		for (size_t i = m_nOrdered; i < m_vecStages.size(); i++) {
+			const auto& stage = m_vecStages[i];
+			if (stage->IsOrdered()) {
+				return false;
+			}
+			if (w == 0) {
+				lane.push_back(stage.get());
+				continue;
+			}
+
+			std::unique_ptr<CarStage> clone = stage->Clone();
+			if (clone == nullptr) {
+				return false;
+			}
+			lane.push_back(clone.get());
+			m_vecClones.push_back(std::move(clone));
+		}
+		m_vecLanes.push_back(std::move(lane));
+	}
+	return true;
+}
+
+/**
+ *	@brief	將來源 thread 取出的幀送入管線: 節點管線放入第一個節點的佇列，幀平行模式執行前置節點後交給 worker。
+ *	@param[in]	stageFramePtr	(指標) 處理資料物件 (已設定序號)
+ *	@return	<b>型別: bool</b> \n 若送出成功返回值為非零值 (true)。 \n 若已停止返回值為零 (false)。
+ */
+bool CarStageGraph::Dispatch(CarStageFrame* stageFramePtr)
+{
+	if (m_nWorkers == 1) {
+		return m_vecQueues.front()->Push(stageFramePtr);
+	}
+
+	for (size_t i = 0; i < m_nOrdered; i++) {
+		CarStageGraph::RunStage(*m_vecStages[i], *stageFramePtr);
+	}
+
+	// 處理失敗或畫面靜止的幀不需要 worker，直接依序號放入重新排序緩衝區
+	if (!stageFramePtr->isValid || stageFramePtr->isIdle || m_vecLanes.front().empty()) {
+		stageFramePtr->finishTime = std::chrono::steady_clock::now();
+		return m_cReorder.Push(stageFramePtr->sequence, stageFramePtr);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutexWork);
+		m_dequeWork.push_back(stageFramePtr);
+	}
+	m_cvWork.notify_one();
+	return m_isKeep.load();
+}
+
+/**
+ *	@brief	取出下一個離開管線的幀 (幀平行模式依序號順序，並記錄在重新排序緩衝區的等待時間)
+ *	@param[out]	stageFramePtr	(指標參考) 處理資料物件
+ *	@param[in]	timeoutMs		最長等待時間 (ms)，0 = 不等待，負值 = 持續等待。
+ *	@return	<b>型別: bool</b> \n 若取出成功返回值為非零值 (true)。 \n 若逾時或已停止返回值為零 (false)。
+ */
+bool CarStageGraph::PopOutput(CarStageFrame*& stageFramePtr, int timeoutMs)
+{
+	if (m_nWorkers == 1) {
+		return m_vecQueues.back()->Pop(stageFramePtr, timeoutMs);
+	}
+
+	if (!m_cReorder.Pop(stageFramePtr, timeoutMs)) {
+		return false;
+	}
+	if (m_metricsPtr != nullptr) {
+		m_metricsPtr->Record(MetricStage::Reorder, std::chrono::steady_clock::now() - stageFramePtr->finishTime);
+	}
+	return true;
+}
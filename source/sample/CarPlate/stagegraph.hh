@@ -0,0 +1,308 @@
+﻿/**************************************************************************//**
+ * @file	stagegraph.hh
+ * @brief	CarStageGraph 車牌偵測管線化處理 (stage graph) 類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_STAGEGRAPH_HH
+#define	ODMC_CARPLATE_STAGEGRAPH_HH
+#include <deque>
+#include "channel.hh"
+#include "detector.hh"
+#include "ratecontrol.hh"
+#include "reorder.hh"
+
+/**
+ *	@struct	CarStageFrame
+ *	@brief	單一幀於 stage graph 中流動的處理資料 (各階段影像與偵測結果)
+ *	@remark	物件於 stage graph 啟動時配置並重複使用，各階段影像緩衝區不會每幀重新配置。
+ */
+struct CarStageFrame {
+	CarFrame		frame;				//!< 原始影像 (緩衝池緩衝區)，各階段直接繪製結果
+	cv::Mat			imgGrayscale;		//!< 灰階影像
+	cv::Mat			imgContrast;		//!< 提高對比影像
+	cv::Mat			imgThresh;			//!< 二值化影像 (輪廓圖層)
+	CarComponents	components;			//!< 連通元件統計資料
+	std::vector<CarPlateCandidate> candidates;	//!< 車牌候選區域
+	std::vector<CarPlateRead> reads;	//!< 各候選區域辨識結果
+	std::vector<cv::Rect> regions;		//!< 搜尋區域 (預設為全畫面，由追蹤節點縮小)
+	std::vector<CarPlateEvent> events;	//!< 此幀產生的車牌事件 (輸出端投票結果)
+	uint64_t		index;				//!< 來源影像序號 (由 0 起算，含跳過不處理的影像，串流重新連接後接續遞增)
+	uint64_t		sequence;			//!< 進入管線的序號 (由 0 起算，連續不中斷，幀平行模式依此重新排序)
+	std::chrono::steady_clock::time_point sourceTime;	//!< 由來源取出的時間 (計算端到端延遲)
+	std::chrono::steady_clock::time_point finishTime;	//!< 處理完成的時間 (幀平行模式計算重新排序等待時間)
+	std::chrono::steady_clock::duration cost;			//!< 各節點處理時間最大值 (瓶頸節點成本)
+	std::chrono::steady_clock::duration work;			//!< 各節點處理時間總和
+	bool			isValid;			//!< 處理過程是否成功 (失敗時後續階段略過)
+	bool			isIdle;				//!< 畫面靜止 (後續階段略過，影像照常輸出)
+};
+
+/**
+ *	@class	CarStage
+ *	@brief	stage graph 節點介面，每個節點由獨立 thread 執行
+ */
+class CarStage
+{
+public:
+	virtual ~CarStage() {}
+
+	/**
+	 *	@brief	取得節點名稱
+	 *	@return	<b>型別: const char*</b> \n 節點名稱
+	 */
+	virtual const char* GetName() const = 0;
+
+	/**
+	 *	@brief	stage graph 啟動時於節點 thread 開始運作前呼叫一次
+	 *	@return	<b>型別: bool</b> \n 若準備成功返回值為非零值 (true)。 \n 若準備失敗返回值為零 (false)。
+	 */
+	virtual bool Prepare() { return true; }
+
+	/**
+	 *	@brief	建立設定相同的節點 (幀平行模式每個 worker 各自持有一份節點)
+	 *	@return	<b>型別: std::unique_ptr<CarStage></b> \n 新節點物件，不支援複製時為 nullptr。
+	 */
+	virtual std::unique_ptr<CarStage> Clone() const { return nullptr; }
+
+	/**
+	 *	@brief	節點是否依賴前一幀的處理結果 (必須依幀序處理)
+	 *	@return	<b>型別: bool</b> \n 若必須依幀序處理返回值為非零值 (true)。 \n 若各幀可獨立處理返回值為零 (false)。
+	 */
+	virtual bool IsOrdered() const { return false; }
+
+	/**
+	 *	@brief	處理一幀資料
+	 *	@param[in,out]	stageFrame	處理資料
+	 *	@return	<b>型別: bool</b> \n 若處理成功返回值為非零值 (true)。 \n 若處理失敗返回值為零 (false)，後續節點略過此幀。
+	 */
+	virtual bool Process(CarStageFrame& stageFrame) = 0;
+
+	/**
+	 *	@brief	設定效能統計物件，節點處理過程的各階段延遲記錄於此。
+	 *	@param[in]	metricsPtr	(指標) 效能統計物件，nullptr = 不統計。
+	 *	@return	此函數沒有返回值
+	 */
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_cDetector.SetMetrics(metricsPtr); }
+
+	/**
+	 *	@brief	設定單幀平行處理 (分塊預處理與連通元件列帶) 使用的 thread 數量
+	 *	@param[in]	threads	thread 數量，0 = 所有核心，1 = 於節點 thread 依序處理。
+	 *	@return	此函數沒有返回值
+	 */
+	void SetThreads(int threads) { m_cDetector.SetThreads(threads); }
+
+protected:
+	CarPlateDetector	m_cDetector;		//!< 影像處理物件 (各節點獨立持有暫存影像)
+};
+
+/**
+ *	@class	CarMotionStage
+ *	@brief	畫面變化偵測節點 (ImageMotion)，畫面靜止時後續節點略過此幀。
+ */
+class CarMotionStage : public CarStage
+{
+public:
+	CarMotionStage(const CarMotionOptions& options);
+	const char* GetName() const override { return "ImageMotion"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarMotionStage(m_sOptions)); }
+	bool IsOrdered() const override { return true; }
+	bool Process(CarStageFrame& stageFrame) override;
+
+private:
+	CarMotionOptions	m_sOptions;		//!< 畫面變化偵測選項
+};
+
+/**
+ *	@class	CarTrackStage
+ *	@brief	車牌位置追蹤節點，依已知車牌位置設定此幀搜尋區域 (追蹤結果於輸出端回饋)。
+ */
+class CarTrackStage : public CarStage
+{
+public:
+	CarTrackStage(CarPlateTracker& tracker);
+	const char* GetName() const override { return "ImageTrack"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarTrackStage(m_cTracker)); }
+	bool Process(CarStageFrame& stageFrame) override;
+
+private:
+	CarPlateTracker&	m_cTracker;		//!< 車牌位置追蹤 (stage graph 持有)
+};
+
+/**
+ *	@class	CarGrayscaleStage
+ *	@brief	灰階轉換節點 (ImageGrayscale)
+ */
+class CarGrayscaleStage : public CarStage
+{
+public:
+	const char* GetName() const override { return "ImageGrayscale"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarGrayscaleStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarContrastStage
+ *	@brief	提高對比節點 (ImageContrast)
+ */
+class CarContrastStage : public CarStage
+{
+public:
+	const char* GetName() const override { return "ImageContrast"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarContrastStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarPreprocessStage
+ *	@brief	平滑化與二值化節點 (ImagePreprocess 的平滑化與邊緣強化部分)
+ */
+class CarPreprocessStage : public CarStage
+{
+public:
+	const char* GetName() const override { return "ImagePreprocess"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarPreprocessStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarTiledStage
+ *	@brief	分塊融合預處理節點 (取代灰階、提高對比、平滑化與二值化節點)
+ */
+class CarTiledStage : public CarStage
+{
+public:
+	CarTiledStage() { m_cDetector.SetTiled(true); }
+	const char* GetName() const override { return "ImageTiled"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarTiledStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarContoursStage
+ *	@brief	連通元件標記與候選篩選節點 (ImageDrawContours、ImageCandidates)
+ */
+class CarContoursStage : public CarStage
+{
+public:
+	const char* GetName() const override { return "ImageDrawContours"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarContoursStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarRecognizeStage
+ *	@brief	車牌文字辨識節點 (ImageRecognize)
+ */
+class CarRecognizeStage : public CarStage
+{
+public:
+	CarRecognizeStage(const char* modelFile, const cv::String& classFile, const cv::String& imageFile);
+	const char* GetName() const override { return "ImageRecognize"; }
+	std::unique_ptr<CarStage> Clone() const override;
+	bool Prepare() override;
+	bool Process(CarStageFrame& stageFrame) override;
+
+private:
+	std::string	m_strModelFile;		//!< 字元辨識二進位模型檔
+	cv::String	m_strClassFile;		//!< 字元訓練標籤檔
+	cv::String	m_strImageFile;		//!< 字元訓練影像檔
+};
+
+/**
+ *	@class	CarMatchStage
+ *	@brief	疊合輪廓圖層節點 (ImageMatch)
+ */
+class CarMatchStage : public CarStage
+{
+public:
+	const char* GetName() const override { return "ImageMatch"; }
+	std::unique_ptr<CarStage> Clone() const override { return std::unique_ptr<CarStage>(new (std::nothrow) CarMatchStage()); }
+	bool Process(CarStageFrame& stageFrame) override;
+};
+
+/**
+ *	@class	CarStageGraph
+ *	@brief	車牌偵測管線化處理
+ *	@remark	來源 thread 由影像傳輸通道取出影像 (含跳幀處理)，依序流經各節點 thread 後輸出，
+ *			節點之間以有界環形佇列連接。第 N+1 幀的預處理與第 N 幀的連通元件標記同時進行，
+ *			吞吐量趨近 1 / max(節點處理時間)。同時處理中的幀數上限為 depth，輸出端未取走時來源端暫停取幀。
+ *			跳幀間隔由速率控制依實際量測的瓶頸節點成本與端到端延遲調整 (未設定時為固定間隔)。
+ *			加入追蹤節點時，輸出端以每幀候選區域更新車牌軌跡，後續幀只在軌跡附近區域搜尋。
+ *			啟用投票時輸出端依軌跡合併多幀辨識結果，車牌事件附加於產生事件的幀 (events)。
+ *			設定多個 worker 時改為幀平行模式: 依幀序處理的前置節點 (畫面變化偵測) 於來源 thread 執行，
+ *			其餘節點每個 worker 各持有一份 (各自的暫存影像)，整幀分派給閒置的 worker 依序完成所有節點，
+ *			完成的幀經重新排序緩衝區依進入管線的順序輸出，單一幀處理較久時只延遲輸出，不阻塞其他 worker。
+ *			同時處理中的幀數上限 (depth) 仍限制來源端取幀，輸出端未取走時背壓傳遞至擷取端。
+ *			單幀內的預處理與連通元件標記另依 thread 數量 (SetThreads) 切割為水平列帶平行處理，降低單一串流延遲。
+ */
+class CarStageGraph
+{
+public:
+	CarStageGraph();
+	virtual ~CarStageGraph();
+
+	void AddStage(std::unique_ptr<CarStage> stage);
+	void ClearStages();
+	void SetDefaultStages(const char* modelFile, const cv::String& classFile, const cv::String& imageFile, const CarMotionOptions& motion = CarMotionOptions(), const CarTrackOptions& track = CarTrackOptions());
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; }
+	void SetRateOptions(const CarRateOptions& options) { m_sRateOptions = options; }
+	void SetVoteOptions(const CarVoteOptions& options) { m_sVoteOptions = options; }
+	void SetWorkers(size_t workers) { if (!this->IsRunning()) m_nWorkers = std::max<size_t>(workers, 1); }
+	void SetThreads(int threads) { if (!this->IsRunning()) m_nThreads = std::max(threads, 0); }
+	void FlushEvents(std::vector<CarPlateEvent>& events) { m_cVoter.Flush(events); }
+
+	bool Start(CarFrameChannel& source, int intervalMs = 0, size_t depth = CAR_STAGE_DEPTH);
+	void Stop();
+	bool Pop(CarStageFrame*& stageFramePtr, int timeoutMs = -1);
+	void Release(CarStageFrame* stageFramePtr);
+
+	bool IsRunning() const { return m_isKeep.load(); }
+	size_t GetStageCount() const { return m_vecStages.size(); }
+	size_t GetWorkers() const { return m_nWorkers; }
+	int GetThreads() const { return m_nThreads; }
+	size_t GetReorderPending() const { return m_cReorder.GetPending(); }
+	uint64_t GetFinished() const { return m_nFinished.load(std::memory_order_acquire); }
+	const CarRateController& GetRateController() const { return m_cRate; }
+	CarPlateTracker& GetTracker() { return m_cTracker; }
+
+private:
+	CarStageGraph(const CarStageGraph&) = delete;				//!< Disable copy construction
+	CarStageGraph& operator=(const CarStageGraph&) = delete;	//!< Disable assignment operator
+	static void SourceProcess(CarStageGraph* cThisPtr);
+	static void StageProcess(CarStageGraph* cThisPtr, size_t index);
+	static void WorkerProcess(CarStageGraph* cThisPtr, size_t index);
+	static void RunStage(CarStage& stage, CarStageFrame& stageFrame);
+
+	bool PrepareLanes();
+	bool Dispatch(CarStageFrame* stageFramePtr);
+	bool PopOutput(CarStageFrame*& stageFramePtr, int timeoutMs);
+
+	typedef CarSpscRing<CarStageFrame*> StageQueue;
+
+	std::vector<std::unique_ptr<CarStage> >		m_vecStages;	//!< 節點列表 (依序連接)
+	std::vector<std::unique_ptr<StageQueue> >	m_vecQueues;	//!< 節點輸入佇列，最後一個為輸出佇列
+	std::vector<std::unique_ptr<CarStageFrame> > m_vecFrames;	//!< 處理資料物件
+	std::vector<std::thread*>	m_vecThreads;		//!< 來源與節點 threads
+	std::unique_ptr<StageQueue>	m_cFreeQueue;		//!< 閒置處理資料物件
+	size_t				m_nWorkers;					//!< 幀平行 worker 數量 (1 = 節點管線)
+	size_t				m_nOrdered;					//!< 幀平行模式於來源 thread 執行的前置節點數量
+	int					m_nThreads;					//!< 各節點單幀平行處理 thread 數量，0 = 所有核心
+	std::vector<std::vector<CarStage*> > m_vecLanes;	//!< 各 worker 依序執行的節點 (第一個 worker 使用原節點)
+	std::vector<std::unique_ptr<CarStage> > m_vecClones;	//!< 其他 worker 持有的節點複本
+	std::deque<CarStageFrame*>	m_dequeWork;		//!< 等待 worker 處理的幀
+	std::mutex				m_mutexWork;			//!< 保護等待處理的幀
+	std::condition_variable	m_cvWork;				//!< 新幀通知
+	CarReorderBuffer<CarStageFrame*> m_cReorder;	//!< 幀平行模式輸出重新排序緩衝區
+	CarFrameChannel*	m_sourcePtr;				//!< 影像來源通道
+	CarRateOptions		m_sRateOptions;				//!< 速率控制選項 (啟動時套用)
+	CarRateController	m_cRate;					//!< 處理間隔速率控制，間隔內的影像跳過不處理
+	CarPlateTracker		m_cTracker;					//!< 車牌位置追蹤 (追蹤節點預測，輸出端更新)
+	CarVoteOptions		m_sVoteOptions;				//!< 投票選項 (啟動時套用)
+	CarPlateVoter		m_cVoter;					//!< 跨幀車牌辨識結果投票 (輸出端更新)
+	CarStreamMetrics*	m_metricsPtr;				//!< 效能統計物件 (可為 nullptr)
+	std::atomic<bool>	m_isKeep;					//!< 持續運作識別
+	std::atomic<uint64_t> m_nFinished;				//!< 已流出管線的幀數 (含處理失敗的影像)
+};
+
+#endif // !ODMC_CARPLATE_STAGEGRAPH_HH
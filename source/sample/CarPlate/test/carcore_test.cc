@@ -0,0 +1,247 @@
+﻿/**************************************************************************//**
+ * @file	carcore_test.cc
+ * @brief	CarPlateCore 資料結構行為測試 (環形佇列、MPSC 佇列、重新排序緩衝區與影像緩衝池)
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "channel.hh"
+#include "mpscqueue.hh"
+#include "reorder.hh"
+
+static int s_nFailures = 0;		//!< 失敗的檢查數量
+
+/**
+ *	@brief	檢查條件，不成立時輸出位置並計數 (繼續執行其餘檢查)
+ */
+#define CAR_CHECK(cond)	do { if (!(cond)) { ::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); s_nFailures++; } } while (0)
+
+#define CAR_TEST_FRAMES		100000	//!< 緩衝池穩定狀態測試幀數
+#define CAR_TEST_WARMUP		1000	//!< 緩衝池暖機幀數 (之後不應再配置)
+
+/**
+ *	@brief	環形佇列繞回: 反覆放入與取出，序號超過容量多次後仍依序取出；DropNewest 滿時丟棄新項目。
+ *	@return	此函數沒有返回值
+ */
+static void TestRingWraparound()
+{
+	CarSpscRing<int> ring(4, RingOverflow::DropNewest);
+	CAR_CHECK(ring.GetCapacity() == 4);
+
+	int next = 0;
+	int expect = 0;
+	for (int round = 0; round < 1000; round++) {
+		for (int i = 0; i < 3; i++) {
+			int item = next++;
+			CAR_CHECK(ring.Push(item));
+		}
+		CAR_CHECK(ring.GetSize() == 3);
+		for (int i = 0; i < 3; i++) {
+			int item = -1;
+			CAR_CHECK(ring.Pop(item, 0));
+			CAR_CHECK(item == expect);
+			expect++;
+		}
+		CAR_CHECK(ring.GetSize() == 0);
+	}
+
+	int item = 0;
+	CAR_CHECK(!ring.Pop(item, 0));
+	for (int i = 0; i < 4; i++) {
+		item = i;
+		CAR_CHECK(ring.Push(item));
+	}
+	item = 4;
+	CAR_CHECK(!ring.Push(item));
+	CAR_CHECK(ring.GetDropped() == 1);
+	CAR_CHECK(ring.GetSize() == 4);
+	CAR_CHECK(ring.Pop(item, 0) && item == 0);
+}
+
+/**
+ *	@brief	DropOldest: 佇列已滿時丟棄最舊項目，只保留最新的容量數量項目。
+ *	@return	此函數沒有返回值
+ */
+static void TestRingDropOldest()
+{
+	CarSpscRing<int> ring(4, RingOverflow::DropOldest);
+	for (int i = 0; i < 10; i++) {
+		int item = i;
+		CAR_CHECK(ring.Push(item));
+	}
+	CAR_CHECK(ring.GetDropped() == 6);
+	CAR_CHECK(ring.GetSize() == 4);
+
+	for (int i = 6; i < 10; i++) {
+		int item = -1;
+		CAR_CHECK(ring.Pop(item, 0));
+		CAR_CHECK(item == i);
+	}
+	int item = 0;
+	CAR_CHECK(!ring.Pop(item, 0));
+	CAR_CHECK(ring.GetProduced() == 10);
+	CAR_CHECK(ring.GetConsumed() == 4);
+}
+
+/**
+ *	@brief	MPSC 佇列: 多個生產者同時放入，取出數量加上丟棄數量等於放入數量，且各生產者的項目依序取出。
+ *	@return	此函數沒有返回值
+ */
+static void TestMpscQueue()
+{
+	const int producers = 4;
+	const int items = 20000;
+	CarMpscQueue<int> queue(64);
+	CAR_CHECK(queue.IsValid());
+
+	std::atomic<int> done(0);
+	std::vector<std::thread> vecThreads;
+	for (int p = 0; p < producers; p++) {
+		vecThreads.emplace_back([&queue, &done, p, items]() {
+			for (int i = 0; i < items; i++) {
+				queue.Push(p * items + i);
+			}
+			done.fetch_add(1);
+		});
+	}
+
+	// 所有生產者結束後再取出一次剩餘項目
+	std::vector<int> vecLast(producers, -1);
+	uint64_t popped = 0;
+	for (bool isDone = false; ; ) {
+		int item = 0;
+		if (queue.Pop(item)) {
+			const int p = item / items;
+			CAR_CHECK(item % items > vecLast[p]);
+			vecLast[p] = item % items;
+			popped++;
+			continue;
+		}
+		if (isDone) break;
+		isDone = done.load() == producers;
+	}
+	for (auto& thread : vecThreads) {
+		thread.join();
+	}
+
+	CAR_CHECK(popped + queue.GetDropped() == static_cast<uint64_t>(producers) * items);
+	CAR_CHECK(queue.GetConsumed() == popped);
+}
+
+/**
+ *	@brief	重新排序緩衝區: 多個生產者以任意順序放入，消費者依序號順序取出。
+ *	@return	此函數沒有返回值
+ */
+static void TestReorderOrdering()
+{
+	const int producers = 4;
+	const int items = 20000;
+	CarReorderBuffer<int> reorder;
+	reorder.Reset(8);
+
+	std::vector<std::thread> vecThreads;
+	for (int p = 0; p < producers; p++) {
+		vecThreads.emplace_back([&reorder, p, producers, items]() {
+			// 超出容量範圍時等待消費者取出前面的序號
+			for (int i = p; i < items; i += producers) {
+				int item = i;
+				while (!reorder.Push(static_cast<uint64_t>(i), item)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for (int i = 0; i < items; i++) {
+		int item = -1;
+		CAR_CHECK(reorder.Pop(item, 1000));
+		CAR_CHECK(item == i);
+		if (item != i) break;
+	}
+	for (auto& thread : vecThreads) {
+		thread.join();
+	}
+	CAR_CHECK(reorder.GetPending() == 0);
+	CAR_CHECK(reorder.GetMaxPending() <= reorder.GetCapacity());
+}
+
+/**
+ *	@brief	影像緩衝池穩定狀態: 擷取端與偵測端經由環形佇列通道傳遞影像，暖機後不再配置緩衝區。
+ *	@param[in]	overflow	佇列已滿處理方式
+ *	@return	此函數沒有返回值
+ */
+static void TestFramePoolSteadyState(RingOverflow overflow)
+{
+	CarFramePool pool;
+	CarQueueChannel channel(8, overflow);
+	std::atomic<uint64_t> warmAllocations(0);
+	std::atomic<bool> isDone(false);
+
+	std::thread producer([&pool, &channel, &warmAllocations, &isDone]() {
+		for (int i = 0; i < CAR_TEST_FRAMES; i++) {
+			if (i == CAR_TEST_WARMUP) {
+				warmAllocations.store(pool.GetAllocations());
+			}
+			CarFrame frame = pool.Acquire(cv::Size(64, 48), CV_8UC3);
+			frame.Image().data[0] = static_cast<uint8_t>(i);
+			frame.SetStamp(static_cast<uint64_t>(i), i * 40.0);
+			channel.Push(frame);
+			frame.Release();
+		}
+		isDone.store(true);
+	});
+
+	// 擷取端結束後再取出一次剩餘影像
+	uint64_t consumed = 0;
+	int64_t lastIndex = -1;
+	CarFrame frame;
+	for (bool isLast = false; ; ) {
+		if (channel.Pop(frame, 0)) {
+			CAR_CHECK(frame.IsStamped());
+			CAR_CHECK(static_cast<int64_t>(frame.Index()) > lastIndex);
+			CAR_CHECK(frame.Image().data[0] == static_cast<uint8_t>(frame.Index()));
+			lastIndex = static_cast<int64_t>(frame.Index());
+			consumed++;
+			frame.Release();
+			continue;
+		}
+		if (isLast) break;
+		isLast = isDone.load();
+		std::this_thread::yield();
+	}
+	producer.join();
+
+	CarChannelStats stats;
+	channel.GetStats(stats);
+	CAR_CHECK(stats.pending == 0);
+	CAR_CHECK(lastIndex == CAR_TEST_FRAMES - 1);
+	CAR_CHECK(stats.produced == static_cast<uint64_t>(CAR_TEST_FRAMES));
+	CAR_CHECK(consumed + stats.dropped == static_cast<uint64_t>(CAR_TEST_FRAMES));
+	if (overflow == RingOverflow::Block) {
+		CAR_CHECK(stats.dropped == 0);
+	}
+	CAR_CHECK(warmAllocations.load() > 0);
+	CAR_CHECK(pool.GetAllocations() == warmAllocations.load());
+}
+
+/**
+ *	@brief	測試程式入口函數
+ */
+int main()
+{
+	TestRingWraparound();
+	TestRingDropOldest();
+	TestMpscQueue();
+	TestReorderOrdering();
+	TestFramePoolSteadyState(RingOverflow::Block);
+	TestFramePoolSteadyState(RingOverflow::DropOldest);
+
+	if (s_nFailures > 0) {
+		::fprintf(stderr, "%d check(s) failed\n", s_nFailures);
+		return EXIT_FAILURE;
+	}
+	::fprintf(stderr, "all checks passed\n");
+	return EXIT_SUCCESS;
+}
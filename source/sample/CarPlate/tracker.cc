@@ -0,0 +1,296 @@
+﻿/**************************************************************************//**
+ * @file	tracker.cc
+ * @brief	CarPlateTracker 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "tracker.hh"
+
+/**
+ *	@brief	CarPlateTracker 建構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateTracker::CarPlateTracker()
+	: m_sOptions()
+	, m_metricsPtr(nullptr)
+	, m_sFrameSize()
+	, m_nFullScan(0)
+	, m_nNextId(0)
+	, m_fScanRatio(1.0)
+	, m_isLost(false) {
+}
+
+/**
+ *	@brief	CarPlateTracker 解構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateTracker::~CarPlateTracker() {}
+
+/**
+ *	@brief	設定車牌位置追蹤選項並清除所有軌跡
+ *	@param[in]	options	車牌位置追蹤選項
+ *	@return	此函數沒有返回值
+ */
+void CarPlateTracker::SetOptions(const CarTrackOptions& options)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_sOptions = options;
+		m_sOptions.fullScanFrames = std::max(options.fullScanFrames, 1);
+		m_sOptions.margin = std::max(options.margin, 0.0);
+		m_sOptions.padding = std::max(options.padding, 0);
+		m_sOptions.maxMisses = std::max(options.maxMisses, 0);
+		m_sOptions.maxTracks = std::max<size_t>(options.maxTracks, 1);
+	}
+	this->Reset();
+}
+
+/**
+ *	@brief	清除所有軌跡，下一幀搜尋全畫面。
+ *	@return	此函數沒有返回值
+ */
+void CarPlateTracker::Reset()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_vecTracks.clear();
+	m_sFrameSize = cv::Size();
+	m_nFullScan = 0;
+	m_fScanRatio = 1.0;
+	m_isLost = false;
+}
+
+/**
+ *	@brief	推算各軌跡於指定幀的位置，產生此幀搜尋區域。
+ *	@param[in]	index		幀序號 (遞增)
+ *	@param[in]	frameSize	影像尺寸
+ *	@param[out]	regions		存放搜尋區域 (互不重疊)，全畫面搜尋時只有一個與畫面相同的區域。
+ *	@return	<b>型別: bool</b> \n 若此幀搜尋全畫面返回值為非零值 (true)。 \n 若只搜尋追蹤區域返回值為零 (false)。
+ */
+bool CarPlateTracker::Predict(uint64_t index, const cv::Size& frameSize, std::vector<cv::Rect>& regions)
+{
+	const cv::Rect frameRect(cv::Point(), frameSize);
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (;;) {
+		if (!m_sOptions.isEnabled) break;
+
+		// 畫面尺寸改變時原有軌跡座標無效
+		if (frameSize != m_sFrameSize) {
+			m_vecTracks.clear();
+			m_sFrameSize = frameSize;
+			break;
+		}
+		if (m_vecTracks.empty() || m_isLost) break;
+		if (index >= m_nFullScan + static_cast<uint64_t>(m_sOptions.fullScanFrames)) break;
+
+		regions.clear();
+		for (const auto& track : m_vecTracks) {
+			const cv::Rect rect = this->SearchRect(track, index) & frameRect;
+			if (rect.area() > 0) {
+				regions.push_back(rect);
+			}
+		}
+		CarPlateTracker::MergeRegions(regions);
+		if (regions.empty()) break;
+
+		// 搜尋區域過大時全畫面搜尋成本相近，直接搜尋全畫面 (同時發現新車牌)
+		int64_t area = 0;
+		for (const auto& region : regions) {
+			area += region.area();
+		}
+		const double ratio = static_cast<double>(area) / frameRect.area();
+		if (ratio > m_sOptions.maxArea) break;
+
+		m_fScanRatio += (ratio - m_fScanRatio) * CAR_TRACK_RATIO_ALPHA;
+		if (m_metricsPtr != nullptr) {
+			m_metricsPtr->AddTracked();
+		}
+		return false;
+	}
+
+	regions.assign(1, frameRect);
+	m_nFullScan = index;
+	m_isLost = false;
+	m_fScanRatio += (1.0 - m_fScanRatio) * CAR_TRACK_RATIO_ALPHA;
+	return true;
+}
+
+/**
+ *	@brief	以指定幀的候選區域更新軌跡，未配對的候選區域建立新軌跡。
+ *	@param[in]		index		幀序號 (必須依序呼叫)
+ *	@param[in]		regions		此幀搜尋區域 (Predict 輸出)
+ *	@param[in,out]	candidates	此幀車牌候選區域 (影像座標)，寫入對應的軌跡編號 (未追蹤為 -1)。
+ *	@return	此函數沒有返回值
+ *	@remark	候選區域中心位於軌跡搜尋區域內才可配對，依與預測中心的距離由近到遠配對。
+ *			未配對的軌跡只有在預測位置位於此幀搜尋區域內時才計為未找到 (軌跡建立前已預測的幀不計)。
+ */
+void CarPlateTracker::Update(uint64_t index, const std::vector<cv::Rect>& regions, std::vector<CarPlateCandidate>& candidates)
+{
+	for (auto& candidate : candidates) {
+		candidate.track = -1;
+	}
+	if (!m_sOptions.isEnabled) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const size_t trackCount = m_vecTracks.size();
+
+	// 建立所有可能配對
+	m_vecPairs.clear();
+	for (size_t t = 0; t < trackCount; t++) {
+		const auto& track = m_vecTracks[t];
+		const cv::Rect search = this->SearchRect(track, index);
+		const float dt = static_cast<float>(index - std::min(index, track.index));
+		const float px = track.cx + track.vx * dt;
+		const float py = track.cy + track.vy * dt;
+
+		for (size_t c = 0; c < candidates.size(); c++) {
+			const cv::Rect& rect = candidates[c].rect;
+			const float cx = rect.x + rect.width * 0.5f;
+			const float cy = rect.y + rect.height * 0.5f;
+			if (!search.contains(cv::Point(static_cast<int>(cx), static_cast<int>(cy)))) continue;
+
+			const Pair pair = { (cx - px) * (cx - px) + (cy - py) * (cy - py), t, c };
+			m_vecPairs.push_back(pair);
+		}
+	}
+	std::sort(m_vecPairs.begin(), m_vecPairs.end(), [](const Pair& a, const Pair& b) { return a.distance < b.distance; });
+
+	// 前段為軌跡、後段為候選區域的配對旗標
+	m_vecMatched.assign(trackCount + candidates.size(), 0);
+	for (const auto& pair : m_vecPairs) {
+		if (m_vecMatched[pair.track] != 0 || m_vecMatched[trackCount + pair.candidate] != 0) continue;
+		m_vecMatched[pair.track] = 1;
+		m_vecMatched[trackCount + pair.candidate] = 1;
+
+		// 位置直接採用量測值，速度依預測誤差修正 (第二次找到時直接以位移估計)
+		auto& track = m_vecTracks[pair.track];
+		const cv::Rect& rect = candidates[pair.candidate].rect;
+		const float cx = rect.x + rect.width * 0.5f;
+		const float cy = rect.y + rect.height * 0.5f;
+		const float dt = static_cast<float>(std::max<uint64_t>(index - std::min(index, track.index), 1));
+		if (track.hits == 1) {
+			track.vx = (cx - track.cx) / dt;
+			track.vy = (cy - track.cy) / dt;
+		}
+		else {
+			track.vx += CAR_TRACK_GAIN * (cx - (track.cx + track.vx * dt)) / dt;
+			track.vy += CAR_TRACK_GAIN * (cy - (track.cy + track.vy * dt)) / dt;
+		}
+		track.cx = cx;
+		track.cy = cy;
+		track.width = static_cast<float>(rect.width);
+		track.height = static_cast<float>(rect.height);
+		track.index = index;
+		track.hits++;
+		track.misses = 0;
+		candidates[pair.candidate].track = track.id;
+	}
+
+	// 未找到的軌跡計數，超過上限時移除並於下一幀搜尋全畫面
+	size_t count = 0;
+	for (size_t t = 0; t < trackCount; t++) {
+		auto& track = m_vecTracks[t];
+		if (m_vecMatched[t] == 0) {
+			const cv::Rect search = this->SearchRect(track, index);
+			const cv::Point center(search.x + search.width / 2, search.y + search.height / 2);
+			bool isSearched = false;
+			for (const auto& region : regions) {
+				isSearched = isSearched || region.contains(center);
+			}
+			if (isSearched && ++track.misses > m_sOptions.maxMisses) {
+				m_isLost = true;
+				continue;
+			}
+		}
+		m_vecTracks[count++] = track;
+	}
+	m_vecTracks.resize(count);
+
+	// 未配對的候選區域建立新軌跡
+	for (size_t c = 0; c < candidates.size() && m_vecTracks.size() < m_sOptions.maxTracks; c++) {
+		if (m_vecMatched[trackCount + c] != 0) continue;
+
+		const cv::Rect& rect = candidates[c].rect;
+		Track track;
+		track.id = m_nNextId++;
+		track.cx = rect.x + rect.width * 0.5f;
+		track.cy = rect.y + rect.height * 0.5f;
+		track.width = static_cast<float>(rect.width);
+		track.height = static_cast<float>(rect.height);
+		track.vx = 0.0f;
+		track.vy = 0.0f;
+		track.index = index;
+		track.hits = 1;
+		track.misses = 0;
+		m_vecTracks.push_back(track);
+		candidates[c].track = track.id;
+	}
+}
+
+/**
+ *	@brief	取得目前軌跡數量
+ *	@return	<b>型別: size_t</b> \n 軌跡數量
+ */
+size_t CarPlateTracker::GetTrackCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_vecTracks.size();
+}
+
+/**
+ *	@brief	取得每幀搜尋面積佔畫面比例 (指數移動平均)
+ *	@return	<b>型別: double</b> \n 搜尋面積比例 (0 ~ 1)
+ */
+double CarPlateTracker::GetScanRatio()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_fScanRatio;
+}
+
+/**
+ *	@brief	計算軌跡於指定幀的搜尋區域 (未裁切至畫面範圍)
+ *	@param[in]	track	軌跡
+ *	@param[in]	index	幀序號
+ *	@return	<b>型別: cv::Rect</b> \n 以預測中心向外擴張的搜尋區域，連續未找到時擴張比例加倍。
+ */
+cv::Rect CarPlateTracker::SearchRect(const Track& track, uint64_t index) const
+{
+	const float dt = static_cast<float>(index - std::min(index, track.index));
+	const float cx = track.cx + track.vx * dt;
+	const float cy = track.cy + track.vy * dt;
+	const float margin = static_cast<float>(m_sOptions.margin) * static_cast<float>(1 << std::min(track.misses, 4));
+	const float halfWidth = track.width * (0.5f + margin) + std::abs(track.vx) + m_sOptions.padding;
+	const float halfHeight = track.height * (0.5f + margin) + std::abs(track.vy) + m_sOptions.padding;
+
+	const int x0 = static_cast<int>(std::floor(cx - halfWidth));
+	const int y0 = static_cast<int>(std::floor(cy - halfHeight));
+	const int x1 = static_cast<int>(std::ceil(cx + halfWidth));
+	const int y1 = static_cast<int>(std::ceil(cy + halfHeight));
+	return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+/**
+ *	@brief	合併重疊的區域，每個 pixel 只處理一次 (搜尋區域的候選區域不會重複，疊圖區域不會重複疊合)。
+ *	@param[in,out]	regions	搜尋區域
+ *	@return	此函數沒有返回值
+ */
+void CarPlateTracker::MergeRegions(std::vector<cv::Rect>& regions)
+{
+	for (size_t i = 0; i < regions.size(); ) {
+		bool isMerged = false;
+		for (size_t j = i + 1; j < regions.size(); j++) {
+			if ((regions[i] & regions[j]).area() > 0) {
+				regions[i] |= regions[j];
+				regions.erase(regions.begin() + j);
+				isMerged = true;
+				break;
+			}
+		}
+
+		// 合併後的區域可能與先前的區域重疊，重新檢查
+		i = isMerged ? 0 : i + 1;
+	}
+}
@@ -0,0 +1,110 @@
+﻿/**************************************************************************//**
+ * @file	tracker.hh
+ * @brief	CarPlateTracker 車牌位置追蹤 (只搜尋已知車牌附近區域) 類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_TRACKER_HH
+#define	ODMC_CARPLATE_TRACKER_HH
+#include "candidate.hh"
+#include "metrics.hh"
+
+/**
+ *	@struct	CarTrackOptions
+ *	@brief	車牌位置追蹤選項
+ */
+struct CarTrackOptions {
+	bool	isEnabled;			//!< 是否啟用 (停用時每一幀都搜尋全畫面)
+	int		fullScanFrames;		//!< 每隔此幀數搜尋全畫面一次 (發現新進入畫面的車牌)
+	double	margin;				//!< 搜尋區域向外擴張比例 (車牌寬高倍數，每次未找到時加倍擴張)
+	int		padding;			//!< 搜尋區域最少向外擴張 pixel 數量
+	int		maxMisses;			//!< 連續未找到幀數超過此值時移除軌跡並搜尋全畫面
+	double	maxArea;			//!< 搜尋區域面積總和超過畫面此比例時直接搜尋全畫面
+	size_t	maxTracks;			//!< 同時追蹤的車牌數量上限
+
+	CarTrackOptions()
+		: isEnabled(false)
+		, fullScanFrames(CAR_TRACK_FULL_SCAN_FRAMES)
+		, margin(CAR_TRACK_MARGIN)
+		, padding(CAR_TRACK_PADDING)
+		, maxMisses(CAR_TRACK_MAX_MISSES)
+		, maxArea(CAR_TRACK_MAX_AREA)
+		, maxTracks(CAR_TRACK_MAX_TRACKS) {
+	}
+};
+
+/**
+ *	@class	CarPlateTracker
+ *	@brief	車牌位置追蹤
+ *	@remark	以等速模型 (alpha-beta 濾波) 追蹤每個車牌外接矩形中心，依幀序號推算目前位置並向外擴張為搜尋區域，
+ *			重疊的搜尋區域合併後只在區域內進行預處理與候選搜尋。定期、軌跡遺失或畫面尺寸改變時搜尋全畫面。
+ *			Predict 與 Update 使用幀序號推算位移，stage graph 中預測與結果回饋相差數幀時仍可正確推算。
+ *			Update 將軌跡編號寫入候選區域，供跨幀投票使用。
+ *			Predict 與 Update 可由不同 thread 呼叫 (內部以 mutex 保護)，Update 必須依幀序呼叫。
+ */
+class CarPlateTracker
+{
+public:
+	CarPlateTracker();
+	virtual ~CarPlateTracker();
+
+	void SetOptions(const CarTrackOptions& options);
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; }
+	void Reset();
+	bool Predict(uint64_t index, const cv::Size& frameSize, std::vector<cv::Rect>& regions);
+	void Update(uint64_t index, const std::vector<cv::Rect>& regions, std::vector<CarPlateCandidate>& candidates);
+
+	bool IsEnabled() const { return m_sOptions.isEnabled; }
+	size_t GetTrackCount();
+	double GetScanRatio();
+
+	static void MergeRegions(std::vector<cv::Rect>& regions);
+
+private:
+	CarPlateTracker(const CarPlateTracker&) = delete;				//!< Disable copy construction
+	CarPlateTracker& operator=(const CarPlateTracker&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Track
+	 *	@brief	單一車牌軌跡
+	 */
+	struct Track {
+		int			id;			//!< 軌跡編號 (遞增，不重複使用)
+		float		cx;			//!< 最近一次找到時的中心座標 X
+		float		cy;			//!< 最近一次找到時的中心座標 Y
+		float		width;		//!< 外接矩形寬度
+		float		height;		//!< 外接矩形高度
+		float		vx;			//!< 每幀位移 X
+		float		vy;			//!< 每幀位移 Y
+		uint64_t	index;		//!< 最近一次找到時的幀序號
+		int			hits;		//!< 找到次數
+		int			misses;		//!< 連續未找到幀數
+	};
+
+	/**
+	 *	@struct	Pair
+	 *	@brief	軌跡與候選區域配對
+	 */
+	struct Pair {
+		float	distance;		//!< 預測中心與候選中心距離平方
+		size_t	track;			//!< 軌跡索引
+		size_t	candidate;		//!< 候選區域索引
+	};
+
+	cv::Rect SearchRect(const Track& track, uint64_t index) const;
+
+	CarTrackOptions		m_sOptions;			//!< 車牌位置追蹤選項
+	CarStreamMetrics*	m_metricsPtr;		//!< 效能統計物件 (可為 nullptr)
+	std::mutex			m_mutex;			//!< 保護軌跡資料
+	std::vector<Track>	m_vecTracks;		//!< 目前軌跡
+	std::vector<Pair>	m_vecPairs;			//!< 配對暫存
+	std::vector<char>	m_vecMatched;		//!< 候選區域是否已配對暫存
+	cv::Size			m_sFrameSize;		//!< 影像尺寸 (尺寸改變時清除軌跡)
+	uint64_t			m_nFullScan;		//!< 最近一次全畫面搜尋的幀序號
+	int					m_nNextId;			//!< 下一個軌跡編號
+	double				m_fScanRatio;		//!< 搜尋面積佔畫面比例平均值
+	bool				m_isLost;			//!< 有軌跡遺失，下一幀搜尋全畫面
+};
+
+#endif // !ODMC_CARPLATE_TRACKER_HH
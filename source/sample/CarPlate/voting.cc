@@ -0,0 +1,308 @@
+﻿/**************************************************************************//**
+ * @file	voting.cc
+ * @brief	CarPlateVoter 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "voting.hh"
+
+/**
+ *	@brief	CarPlateVoter 建構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateVoter::CarPlateVoter()
+	: m_sOptions()
+	, m_nStamp(0)
+	, m_nEmitted(0)
+	, m_nSuppressed(0) {
+}
+
+/**
+ *	@brief	CarPlateVoter 解構式
+ *	@return	此函數沒有返回值
+ */
+CarPlateVoter::~CarPlateVoter() {}
+
+/**
+ *	@brief	設定投票選項，配置投票表與 LRU 表並清除所有資料。
+ *	@param[in]	options	車牌辨識結果投票選項
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::SetOptions(const CarVoteOptions& options)
+{
+	m_sOptions = options;
+	m_sOptions.minFrames = std::max(options.minFrames, 1);
+	m_sOptions.saturationFrames = std::max(options.saturationFrames, m_sOptions.minFrames);
+	m_sOptions.endFrames = std::max(options.endFrames, 1);
+	m_sOptions.suppressFrames = std::max(options.suppressFrames, 0);
+	m_sOptions.maxTracks = std::max<size_t>(options.maxTracks, 1);
+
+	m_vecSlots.resize(m_sOptions.isEnabled ? m_sOptions.maxTracks : 0);
+	m_vecRecent.resize(m_sOptions.isEnabled ? m_sOptions.recentPlates : 0);
+	this->Reset();
+}
+
+/**
+ *	@brief	清除所有投票資料與最近輸出車牌 (不輸出事件)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Reset()
+{
+	for (auto& slot : m_vecSlots) {
+		slot.track = -1;
+	}
+	for (auto& recent : m_vecRecent) {
+		recent.text[0] = '\0';
+		recent.index = 0;
+		recent.stamp = 0;
+	}
+	m_nStamp = 0;
+	m_nEmitted = 0;
+	m_nSuppressed = 0;
+}
+
+/**
+ *	@brief	加入一幀辨識結果，輸出此幀產生的車牌事件。
+ *	@param[in]	index		幀序號 (必須依序呼叫，畫面靜止的幀也應呼叫以便結束軌跡)
+ *	@param[in]	candidates	此幀車牌候選區域 (含軌跡編號)
+ *	@param[in]	reads		各候選區域辨識結果
+ *	@param[out]	events		存放此幀產生的車牌事件 (先清除)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Update(uint64_t index, const std::vector<CarPlateCandidate>& candidates, const std::vector<CarPlateRead>& reads, std::vector<CarPlateEvent>& events)
+{
+	events.clear();
+	if (!m_sOptions.isEnabled) {
+		return;
+	}
+
+	for (size_t i = 0; i < candidates.size(); i++) {
+		const auto& candidate = candidates[i];
+		const bool isRead = i < reads.size() && reads[i].count > 0;
+
+		// 未追蹤的候選區域無法跨幀投票，直接以單幀結果輸出
+		if (candidate.track < 0) {
+			if (!isRead) continue;
+
+			CarPlateEvent event;
+			event.track = -1;
+			event.firstIndex = index;
+			event.lastIndex = index;
+			event.frames = 1;
+			event.rect = candidate.rect;
+			event.read = reads[i];
+			this->Emit(event, events);
+			continue;
+		}
+
+		Slot* slotPtr = this->FindSlot(candidate.track, index, events);
+		if (slotPtr == nullptr) continue;
+
+		slotPtr->lastIndex = index;
+		slotPtr->rect = candidate.rect;
+		if (!isRead || slotPtr->isEmitted) continue;
+
+		this->Vote(*slotPtr, reads[i]);
+
+		// 信心值飽和時不必等軌跡結束
+		if (slotPtr->frames >= m_sOptions.saturationFrames) {
+			CarPlateEvent event;
+			if (this->Consolidate(*slotPtr, event) && event.read.confidence >= m_sOptions.saturation) {
+				slotPtr->isEmitted = true;
+				this->Emit(event, events);
+			}
+		}
+	}
+
+	// 一段時間未出現的軌跡視為結束
+	for (auto& slot : m_vecSlots) {
+		if (slot.track >= 0 && index > slot.lastIndex + static_cast<uint64_t>(m_sOptions.endFrames)) {
+			this->Finish(slot, events);
+		}
+	}
+}
+
+/**
+ *	@brief	結束所有軌跡並輸出車牌事件 (串流或檔案結束時呼叫)
+ *	@param[out]	events	存放車牌事件 (先清除)
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Flush(std::vector<CarPlateEvent>& events)
+{
+	events.clear();
+	for (auto& slot : m_vecSlots) {
+		if (slot.track >= 0) {
+			this->Finish(slot, events);
+		}
+	}
+}
+
+/**
+ *	@brief	取得軌跡的投票資料，不存在時配置閒置或最久未出現的投票資料 (先結束原軌跡)。
+ *	@param[in]	track	車牌軌跡編號
+ *	@param[in]	index	幀序號
+ *	@param[out]	events	存放被取代軌跡的車牌事件
+ *	@return	<b>型別: Slot*</b> \n 投票資料
+ */
+CarPlateVoter::Slot* CarPlateVoter::FindSlot(int track, uint64_t index, std::vector<CarPlateEvent>& events)
+{
+	Slot* freePtr = nullptr;
+	for (auto& slot : m_vecSlots) {
+		if (slot.track == track) {
+			return &slot;
+		}
+
+		// 優先使用閒置的投票資料，其次為最久未出現的軌跡
+		if (slot.track < 0) {
+			if (freePtr == nullptr || freePtr->track >= 0) freePtr = &slot;
+		}
+		else if (freePtr == nullptr || (freePtr->track >= 0 && slot.lastIndex < freePtr->lastIndex)) {
+			freePtr = &slot;
+		}
+	}
+	if (freePtr == nullptr) {
+		return nullptr;
+	}
+
+	if (freePtr->track >= 0) {
+		this->Finish(*freePtr, events);
+	}
+
+	freePtr->track = track;
+	freePtr->firstIndex = index;
+	freePtr->lastIndex = index;
+	freePtr->frames = 0;
+	freePtr->isEmitted = false;
+	::memset(freePtr->lengths, 0, sizeof(freePtr->lengths));
+	::memset(freePtr->votes, 0, sizeof(freePtr->votes));
+	return freePtr;
+}
+
+/**
+ *	@brief	加入單幀辨識結果至投票資料
+ *	@param[in,out]	slot	投票資料
+ *	@param[in]		read	單幀辨識結果
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Vote(Slot& slot, const CarPlateRead& read)
+{
+	const int count = std::min(read.count, CAR_OCR_MAX_CHARS);
+	if (slot.frames == 0) {
+		slot.firstIndex = slot.lastIndex;
+	}
+	slot.frames++;
+	slot.lengths[count] += std::max(read.confidence, 0.0f);
+
+	for (int i = 0; i < count; i++) {
+		const auto label = static_cast<unsigned char>(read.chars[i].label) % CAR_VOTE_LABELS;
+		slot.votes[i][label] += std::max(read.chars[i].confidence, 0.0f);
+	}
+}
+
+/**
+ *	@brief	結束軌跡，未輸出且辨識幀數足夠時輸出車牌事件。
+ *	@param[in,out]	slot	投票資料，結束後成為閒置。
+ *	@param[out]		events	存放車牌事件
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Finish(Slot& slot, std::vector<CarPlateEvent>& events)
+{
+	CarPlateEvent event;
+	if (!slot.isEmitted && slot.frames >= m_sOptions.minFrames && this->Consolidate(slot, event)) {
+		this->Emit(event, events);
+	}
+	slot.track = -1;
+}
+
+/**
+ *	@brief	依得票結果產生車牌事件: 字元數量與每個位置的字元取得票最高者。
+ *	@param[in]	slot	投票資料
+ *	@param[out]	event	存放車牌事件
+ *	@return	<b>型別: bool</b> \n 若有辨識結果返回值為非零值 (true)。 \n 若沒有任何辨識結果返回值為零 (false)。
+ */
+bool CarPlateVoter::Consolidate(const Slot& slot, CarPlateEvent& event) const
+{
+	if (slot.frames == 0) {
+		return false;
+	}
+
+	int count = 0;
+	for (int n = 1; n <= CAR_OCR_MAX_CHARS; n++) {
+		if (slot.lengths[n] > slot.lengths[count]) count = n;
+	}
+	if (count == 0) {
+		return false;
+	}
+
+	auto& read = event.read;
+	read = CarPlateRead();
+	read.count = count;
+	read.confidence = 1.0f;
+	for (int i = 0; i < count; i++) {
+		const float* votePtr = slot.votes[i];
+		const auto best = std::max_element(votePtr, votePtr + CAR_VOTE_LABELS) - votePtr;
+		read.chars[i].label = static_cast<char>(best);
+		read.chars[i].confidence = std::min(votePtr[best] / slot.frames, 1.0f);
+		read.text[i] = read.chars[i].label;
+		read.confidence = std::min(read.confidence, read.chars[i].confidence);
+	}
+	read.text[count] = '\0';
+
+	event.track = slot.track;
+	event.firstIndex = slot.firstIndex;
+	event.lastIndex = slot.lastIndex;
+	event.frames = slot.frames;
+	event.rect = slot.rect;
+	return true;
+}
+
+/**
+ *	@brief	檢查車牌文字是否於抑制時間內輸出過，並更新 LRU 表。
+ *	@param[in]	text	車牌文字
+ *	@param[in]	index	幀序號
+ *	@return	<b>型別: bool</b> \n 若為重複車牌返回值為非零值 (true)。 \n 若不是重複車牌返回值為零 (false)。
+ */
+bool CarPlateVoter::IsRepeated(const char* text, uint64_t index)
+{
+	if (m_vecRecent.empty()) {
+		return false;
+	}
+
+	// 相同文字: 抑制時間由最後一次出現起算 (車輛停留期間持續抑制)
+	Recent* oldestPtr = &m_vecRecent.front();
+	for (auto& recent : m_vecRecent) {
+		if (::strcmp(recent.text, text) == 0) {
+			const bool isRepeated = index <= recent.index + static_cast<uint64_t>(m_sOptions.suppressFrames);
+			recent.index = std::max(recent.index, index);
+			recent.stamp = ++m_nStamp;
+			return isRepeated;
+		}
+		if (recent.stamp < oldestPtr->stamp) {
+			oldestPtr = &recent;
+		}
+	}
+
+	// 取代最久未使用的項目
+	::strncpy(oldestPtr->text, text, CAR_OCR_MAX_CHARS);
+	oldestPtr->text[CAR_OCR_MAX_CHARS] = '\0';
+	oldestPtr->index = index;
+	oldestPtr->stamp = ++m_nStamp;
+	return false;
+}
+
+/**
+ *	@brief	輸出車牌事件 (重複車牌只計數不輸出)
+ *	@param[in]	event	車牌事件
+ *	@param[out]	events	存放車牌事件
+ *	@return	此函數沒有返回值
+ */
+void CarPlateVoter::Emit(const CarPlateEvent& event, std::vector<CarPlateEvent>& events)
+{
+	if (this->IsRepeated(event.read.text, event.lastIndex)) {
+		m_nSuppressed++;
+		return;
+	}
+	m_nEmitted++;
+	events.push_back(event);
+}
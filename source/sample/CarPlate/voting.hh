@@ -0,0 +1,121 @@
+﻿/**************************************************************************//**
+ * @file	voting.hh
+ * @brief	CarPlateVoter 跨幀車牌辨識結果投票與去重複類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_VOTING_HH
+#define	ODMC_CARPLATE_VOTING_HH
+#include "candidate.hh"
+#include "ocr.hh"
+
+#define CAR_VOTE_LABELS		128		//!< 字元投票表大小 (ASCII)
+
+/**
+ *	@struct	CarVoteOptions
+ *	@brief	車牌辨識結果投票選項
+ */
+struct CarVoteOptions {
+	bool		isEnabled;			//!< 是否啟用 (停用時不輸出任何車牌事件)
+	int			minFrames;			//!< 軌跡至少辨識此幀數才輸出
+	int			saturationFrames;	//!< 辨識幀數達到此值且信心值達到 saturation 時立即輸出
+	float		saturation;			//!< 提前輸出的信心值門檻
+	int			endFrames;			//!< 軌跡此幀數未出現時視為結束並輸出
+	int			suppressFrames;		//!< 同一車牌文字於此幀數內不重複輸出
+	size_t		maxTracks;			//!< 同時投票的軌跡數量上限
+	size_t		recentPlates;		//!< 最近輸出車牌 (LRU) 數量上限
+
+	CarVoteOptions()
+		: isEnabled(false)
+		, minFrames(CAR_VOTE_MIN_FRAMES)
+		, saturationFrames(CAR_VOTE_SATURATION_FRAMES)
+		, saturation(CAR_VOTE_SATURATION)
+		, endFrames(CAR_VOTE_END_FRAMES)
+		, suppressFrames(CAR_VOTE_SUPPRESS_FRAMES)
+		, maxTracks(CAR_VOTE_MAX_TRACKS)
+		, recentPlates(CAR_VOTE_RECENT_PLATES) {
+	}
+};
+
+/**
+ *	@struct	CarPlateEvent
+ *	@brief	車牌事件 (同一軌跡多幀辨識結果投票後的單一結果)
+ */
+struct CarPlateEvent {
+	int			track;			//!< 車牌軌跡編號 (-1 = 未追蹤的單幀結果)
+	uint64_t	firstIndex;		//!< 第一次辨識的幀序號
+	uint64_t	lastIndex;		//!< 最後一次辨識的幀序號
+	int			frames;			//!< 參與投票的幀數
+	cv::Rect	rect;			//!< 最後一次出現的候選區域
+	CarPlateRead read;			//!< 投票結果 (各字元信心值 = 得票信心值總和 / 幀數)
+};
+
+/**
+ *	@class	CarPlateVoter
+ *	@brief	跨幀車牌辨識結果投票與去重複
+ *	@remark	依車牌軌跡累加字元數量與每個位置各字元的信心值，軌跡結束 (一段時間未出現) 或信心值飽和時
+ *			輸出一筆車牌事件，同一軌跡只輸出一次。最近輸出的車牌文字保存於固定大小的 LRU 表，
+ *			抑制時間內再次出現的相同車牌不重複輸出 (例如車輛停留時軌跡中斷後重新建立)。
+ *			投票表與 LRU 表於設定選項時配置，處理過程不配置記憶體。物件只能由單一 thread 使用。
+ */
+class CarPlateVoter
+{
+public:
+	CarPlateVoter();
+	virtual ~CarPlateVoter();
+
+	void SetOptions(const CarVoteOptions& options);
+	void Reset();
+	void Update(uint64_t index, const std::vector<CarPlateCandidate>& candidates, const std::vector<CarPlateRead>& reads, std::vector<CarPlateEvent>& events);
+	void Flush(std::vector<CarPlateEvent>& events);
+
+	bool IsEnabled() const { return m_sOptions.isEnabled; }
+	uint64_t GetEmitted() const { return m_nEmitted; }
+	uint64_t GetSuppressed() const { return m_nSuppressed; }
+
+private:
+	CarPlateVoter(const CarPlateVoter&) = delete;				//!< Disable copy construction
+	CarPlateVoter& operator=(const CarPlateVoter&) = delete;	//!< Disable assignment operator
+
+	/**
+	 *	@struct	Slot
+	 *	@brief	單一軌跡投票資料
+	 */
+	struct Slot {
+		int			track;			//!< 車牌軌跡編號 (-1 = 閒置)
+		uint64_t	firstIndex;		//!< 第一次辨識的幀序號
+		uint64_t	lastIndex;		//!< 最後一次出現的幀序號
+		int			frames;			//!< 參與投票的幀數
+		bool		isEmitted;		//!< 是否已輸出 (之後的結果不再投票)
+		cv::Rect	rect;			//!< 最後一次出現的候選區域
+		float		lengths[CAR_OCR_MAX_CHARS + 1];				//!< 各字元數量得票 (信心值總和)
+		float		votes[CAR_OCR_MAX_CHARS][CAR_VOTE_LABELS];	//!< 各位置各字元得票 (信心值總和)
+	};
+
+	/**
+	 *	@struct	Recent
+	 *	@brief	最近輸出車牌
+	 */
+	struct Recent {
+		char		text[CAR_OCR_MAX_CHARS + 1];	//!< 車牌文字 (空字串 = 閒置)
+		uint64_t	index;			//!< 最後一次出現的幀序號
+		uint64_t	stamp;			//!< 最後一次使用的序號 (LRU)
+	};
+
+	Slot* FindSlot(int track, uint64_t index, std::vector<CarPlateEvent>& events);
+	void Vote(Slot& slot, const CarPlateRead& read);
+	void Finish(Slot& slot, std::vector<CarPlateEvent>& events);
+	bool Consolidate(const Slot& slot, CarPlateEvent& event) const;
+	bool IsRepeated(const char* text, uint64_t index);
+	void Emit(const CarPlateEvent& event, std::vector<CarPlateEvent>& events);
+
+	CarVoteOptions		m_sOptions;			//!< 車牌辨識結果投票選項
+	std::vector<Slot>	m_vecSlots;			//!< 軌跡投票資料
+	std::vector<Recent>	m_vecRecent;		//!< 最近輸出車牌 (LRU)
+	uint64_t			m_nStamp;			//!< LRU 使用序號
+	uint64_t			m_nEmitted;			//!< 已輸出車牌事件數量
+	uint64_t			m_nSuppressed;		//!< 重複而未輸出的車牌事件數量
+};
+
+#endif // !ODMC_CARPLATE_VOTING_HH
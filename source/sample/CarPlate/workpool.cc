@@ -0,0 +1,179 @@
+﻿/**************************************************************************//**
+ * @file	workpool.cc
+ * @brief	CarWorkerPool 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "workpool.hh"
+
+/**
+ *	@brief	CarWorkerPool 建構式
+ *	@return	此函數沒有返回值
+ */
+CarWorkerPool::CarWorkerPool()
+	: m_isKeep(false)
+	, m_nPending(0)
+	, m_nSleeping(0)
+	, m_nNext(0)
+	, m_nExecuted(0)
+	, m_nStolen(0) {
+}
+
+/**
+ *	@brief	CarWorkerPool 解構式
+ *	@return	此函數沒有返回值
+ */
+CarWorkerPool::~CarWorkerPool()
+{
+	this->Stop();
+}
+
+/**
+ *	@brief	啟動 worker threads
+ *	@param[in]	workers	worker 數量，0 = 依 CPU 核心數量
+ *	@return	<b>型別: bool</b> \n 若啟動成功返回值為非零值 (true)。 \n 若啟動失敗返回值為零 (false)。
+ */
+bool CarWorkerPool::Start(int workers)
+{
+	this->Stop();
+
+	if (workers <= 0) {
+		workers = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	workers = std::max(workers, 1);
+
+	for (;;) {
+		m_vecWorkers.clear();
+		for (int i = 0; i < workers; i++) {
+			std::unique_ptr<Worker> worker(new (std::nothrow) Worker());
+			if (worker == nullptr) break;
+			worker->thread = nullptr;
+			m_vecWorkers.push_back(std::move(worker));
+		}
+		if (static_cast<int>(m_vecWorkers.size()) != workers) break;
+
+		m_isKeep.store(true);
+		bool isStarted = true;
+		for (int i = 0; i < workers && isStarted; i++) {
+			m_vecWorkers[i]->thread = new (std::nothrow) std::thread(&CarWorkerPool::WorkerProcess, this, i);
+			isStarted = m_vecWorkers[i]->thread != nullptr;
+		}
+		if (!isStarted) break;
+		return true;
+	}
+
+	this->Stop();
+	return false;
+}
+
+/**
+ *	@brief	停止所有 worker threads，等候執行中的工作完成，尚未執行的工作直接捨棄。
+ *	@return	此函數沒有返回值
+ */
+void CarWorkerPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isKeep.store(false);
+		m_cvTask.notify_all();
+	}
+
+	for (auto& worker : m_vecWorkers) {
+		if (worker->thread != nullptr) {
+			if (worker->thread->joinable()) {
+				worker->thread->join();
+			}
+			SAFE_DELETE(worker->thread);
+		}
+	}
+	m_vecWorkers.clear();
+	m_nPending.store(0);
+}
+
+/**
+ *	@brief	提交工作
+ *	@param[in]	taskPtr		(指標) 工作物件，執行完成前必須保持有效。
+ *	@param[in]	priority	工作優先權
+ *	@param[in]	hint		建議執行的 worker (如串流編號)，負值時輪流分配。
+ *	@return	<b>型別: bool</b> \n 若提交成功返回值為非零值 (true)。 \n 若執行緒池未啟動返回值為零 (false)。
+ */
+bool CarWorkerPool::Submit(CarTask* taskPtr, TaskPriority priority, int hint)
+{
+	if (taskPtr == nullptr || !this->IsRunning() || m_vecWorkers.empty()) {
+		return false;
+	}
+
+	const unsigned count = static_cast<unsigned>(m_vecWorkers.size());
+	const unsigned index = (hint >= 0 ? static_cast<unsigned>(hint) : m_nNext.fetch_add(1, std::memory_order_relaxed)) % count;
+	auto& worker = *m_vecWorkers[index];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks[static_cast<int>(priority)].push_back(taskPtr);
+	}
+
+	// 有休眠中的 worker 時喚醒 (m_nPending 與 m_nSleeping 皆為 seq_cst，不會遺失喚醒)
+	m_nPending.fetch_add(1);
+	if (m_nSleeping.load() > 0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cvTask.notify_one();
+	}
+	return true;
+}
+
+/**
+ *	@brief	取出下一個工作: 依優先權由高至低，先取自己的佇列，再由其他 worker 佇列竊取。
+ *	@param[in]	index	worker 編號
+ *	@return	<b>型別: CarTask*</b> \n 若取得工作返回工作指標。 \n 若沒有工作返回值為 nullptr。
+ */
+CarTask* CarWorkerPool::Fetch(int index)
+{
+	const int count = static_cast<int>(m_vecWorkers.size());
+	CarTask* taskPtr = nullptr;
+
+	for (int level = CAR_TASK_PRIORITIES - 1; level >= 0; level--) {
+		for (int i = 0; i < count; i++) {
+			auto& worker = *m_vecWorkers[(index + i) % count];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			auto& tasks = worker.tasks[level];
+			if (tasks.empty()) continue;
+
+			taskPtr = tasks.front();
+			tasks.pop_front();
+			if (i != 0) {
+				m_nStolen.fetch_add(1, std::memory_order_relaxed);
+			}
+			return taskPtr;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ *	@brief	worker thread process
+ *	@param[in]	cThisPtr	(指標) CarWorkerPool 物件
+ *	@param[in]	index		worker 編號
+ *	@return	此函數沒有返回值
+ */
+void CarWorkerPool::WorkerProcess(CarWorkerPool* cThisPtr, int index)
+{
+	auto isReady = [cThisPtr]() {
+		return !cThisPtr->m_isKeep.load() || cThisPtr->m_nPending.load() > 0;
+	};
+
+	while (cThisPtr->m_isKeep.load()) {
+		auto taskPtr = cThisPtr->Fetch(index);
+		if (taskPtr != nullptr) {
+			cThisPtr->m_nPending.fetch_sub(1);
+			taskPtr->Run();
+			cThisPtr->m_nExecuted.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		// 沒有工作，休眠等待新工作
+		std::unique_lock<std::mutex> lock(cThisPtr->m_mutex);
+		cThisPtr->m_nSleeping.fetch_add(1);
+		cThisPtr->m_cvTask.wait(lock, isReady);
+		cThisPtr->m_nSleeping.fetch_sub(1);
+	}
+}
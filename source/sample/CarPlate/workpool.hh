@@ -0,0 +1,92 @@
+﻿/**************************************************************************//**
+ * @file	workpool.hh
+ * @brief	CarWorkerPool 工作竊取 (work-stealing) 執行緒池類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_WORKPOOL_HH
+#define	ODMC_CARPLATE_WORKPOOL_HH
+#include <deque>
+#include <memory>
+#include "carcore.hh"
+
+/**
+ *	@enum	TaskPriority
+ *	@brief	工作優先權列表
+ */
+enum class TaskPriority {
+	Low = 0,		//!< 低優先權
+	Normal,			//!< 一般優先權
+	High,			//!< 高優先權
+};
+
+#define CAR_TASK_PRIORITIES		3		//!< 工作優先權數量
+
+/**
+ *	@class	CarTask
+ *	@brief	工作介面，提交至 CarWorkerPool 後由任一 worker thread 執行
+ */
+class CarTask
+{
+public:
+	virtual ~CarTask() {}
+
+	/**
+	 *	@brief	執行工作
+	 *	@return	此函數沒有返回值
+	 */
+	virtual void Run() = 0;
+};
+
+/**
+ *	@class	CarWorkerPool
+ *	@brief	固定數量 worker thread 的工作竊取執行緒池
+ *	@remark	每個 worker 依優先權各有一個工作佇列，提交時依提示 (hint) 放入指定 worker 以保持 cache locality，
+ *			worker 自己的佇列為空時由其他 worker 的佇列竊取工作。取出順序為高優先權優先，同優先權先進先出。
+ *			沒有工作時 worker 休眠等待，不會忙碌輪詢。工作物件的生命週期由提交端管理。
+ */
+class CarWorkerPool
+{
+public:
+	CarWorkerPool();
+	virtual ~CarWorkerPool();
+
+	bool Start(int workers = 0);
+	void Stop();
+	bool Submit(CarTask* taskPtr, TaskPriority priority = TaskPriority::Normal, int hint = -1);
+
+	bool IsRunning() const { return m_isKeep.load(std::memory_order_acquire); }
+	int GetWorkers() const { return static_cast<int>(m_vecWorkers.size()); }
+	uint64_t GetExecuted() const { return m_nExecuted.load(std::memory_order_relaxed); }
+	uint64_t GetStolen() const { return m_nStolen.load(std::memory_order_relaxed); }
+
+private:
+	CarWorkerPool(const CarWorkerPool&) = delete;				//!< Disable copy construction
+	CarWorkerPool& operator=(const CarWorkerPool&) = delete;	//!< Disable assignment operator
+	static void WorkerProcess(CarWorkerPool* cThisPtr, int index);
+
+	/**
+	 *	@struct	Worker
+	 *	@brief	worker thread 與其工作佇列
+	 */
+	struct Worker {
+		std::mutex				mutex;							//!< 保護工作佇列
+		std::deque<CarTask*>	tasks[CAR_TASK_PRIORITIES];		//!< 各優先權工作佇列
+		std::thread*			thread;							//!< worker thread
+	};
+
+	CarTask* Fetch(int index);
+
+	std::vector<std::unique_ptr<Worker> > m_vecWorkers;		//!< worker 列表
+	std::atomic<bool>		m_isKeep;			//!< 持續運作識別
+	std::atomic<int>		m_nPending;			//!< 尚未取出的工作數量
+	std::atomic<int>		m_nSleeping;		//!< 休眠中的 worker 數量
+	std::atomic<unsigned>	m_nNext;			//!< 沒有提示時輪流放入的 worker 編號
+	std::atomic<uint64_t>	m_nExecuted;		//!< 已執行工作數量
+	std::atomic<uint64_t>	m_nStolen;			//!< 竊取其他 worker 工作的次數
+	std::mutex				m_mutex;			//!< 休眠等待用 mutex
+	std::condition_variable	m_cvTask;			//!< 新工作通知
+};
+
+#endif // !ODMC_CARPLATE_WORKPOOL_HH
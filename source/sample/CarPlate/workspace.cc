@@ -0,0 +1,80 @@
+﻿/**************************************************************************//**
+ * @file	workspace.cc
+ * @brief	CarWorkspace 類別成員函數定義
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#include "workspace.hh"
+
+/**
+ *	@brief	各暫存影像的型別 (依 WorkBuffer 順序)
+ */
+static const int s_workBufferTypes[CAR_WORK_BUFFERS] = {
+	CV_8UC1, CV_8UC1, CV_8UC1, CV_8UC1, CV_8UC1, CV_8UC1, CV_8UC1,
+	CV_32FC1, CV_32FC1, CV_8UC1,
+};
+
+/**
+ *	@brief	CarWorkspace 建構式
+ *	@return	此函數沒有返回值
+ */
+CarWorkspace::CarWorkspace()
+	: m_metricsPtr(nullptr)
+	, m_nAllocations(0) {
+	for (auto& dataPtr : m_dataPtrs) {
+		dataPtr = nullptr;
+	}
+	m_imgElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+}
+
+/**
+ *	@brief	CarWorkspace 解構式
+ *	@return	此函數沒有返回值
+ */
+CarWorkspace::~CarWorkspace() {}
+
+/**
+ *	@brief	準備指定解析度的暫存影像，尺寸不符或已被重新配置的影像重新配置並計數。
+ *	@param[in]	size	影像尺寸
+ *	@return	<b>型別: bool</b> \n 若有暫存影像重新配置返回值為非零值 (true)。 \n 若全部沿用返回值為零 (false)。
+ */
+bool CarWorkspace::Prepare(const cv::Size& size)
+{
+	uint64_t allocations = 0;
+	for (int i = 0; i < CAR_WORK_BUFFERS; i++) {
+		auto& imgBuffer = m_imgBuffers[i];
+		const int type = s_workBufferTypes[i];
+		if (imgBuffer.size() == size && imgBuffer.type() == type && imgBuffer.data == m_dataPtrs[i]) {
+			continue;
+		}
+
+		// 尺寸相同但記憶體位址改變表示處理過程中被重新配置，同樣計數
+		if (imgBuffer.size() != size || imgBuffer.type() != type) {
+			imgBuffer.create(size, type);
+		}
+		m_dataPtrs[i] = imgBuffer.data;
+		allocations++;
+	}
+
+	if (allocations == 0) {
+		return false;
+	}
+	m_nAllocations += allocations;
+	if (m_metricsPtr != nullptr) {
+		m_metricsPtr->AddScratch(allocations);
+	}
+	return true;
+}
+
+/**
+ *	@brief	釋放所有暫存影像 (下一次準備時重新配置)
+ *	@return	此函數沒有返回值
+ */
+void CarWorkspace::Release()
+{
+	for (int i = 0; i < CAR_WORK_BUFFERS; i++) {
+		m_imgBuffers[i].release();
+		m_dataPtrs[i] = nullptr;
+	}
+}
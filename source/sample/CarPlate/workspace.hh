@@ -0,0 +1,63 @@
+﻿/**************************************************************************//**
+ * @file	workspace.hh
+ * @brief	CarWorkspace 偵測暫存影像工作區類別宣告 Header
+ * @date	2026-10-19
+ * @date	2026-10-19
+ * @author	Swang
+ *****************************************************************************/
+#ifndef ODMC_CARPLATE_WORKSPACE_HH
+#define	ODMC_CARPLATE_WORKSPACE_HH
+#include "metrics.hh"
+
+/**
+ *	@enum	WorkBuffer
+ *	@brief	工作區暫存影像列表 (皆為單通道，與原始影像同尺寸；除自適應閥值的 float 暫存外皆為 8-bit)
+ */
+enum class WorkBuffer : int {
+	Grayscale = 0,	//!< 灰階影像
+	Contrast,		//!< 提高對比影像
+	Tophat,			//!< top-hat 影像
+	Blackhat,		//!< black-hat 影像
+	Blurred,		//!< 平滑化影像
+	Thresh,			//!< 二值化影像 (輪廓圖層)
+	Candidates,		//!< 候選區域輪廓暫存
+	BlurredFloat,	//!< 平滑化影像 (float，自適應閥值暫存)
+	MeanFloat,		//!< 區域平均 (float，自適應閥值暫存)
+	Mean,			//!< 區域平均 (自適應閥值暫存)
+};
+
+#define CAR_WORK_BUFFERS	10	//!< 工作區暫存影像數量
+
+/**
+ *	@class	CarWorkspace
+ *	@brief	偵測暫存影像工作區
+ *	@remark	一次配置單一解析度所需的所有中間影像，之後每幀重複使用，只有解析度改變 (串流重新連接) 時重新配置。
+ *			每次準備工作區時同時檢查暫存影像是否於處理過程中被重新配置 (例如輸出尺寸不符)，
+ *			配置次數計入效能統計，穩定運作時不應增加。
+ */
+class CarWorkspace
+{
+public:
+	CarWorkspace();
+	virtual ~CarWorkspace();
+
+	bool Prepare(const cv::Size& size);
+	void Release();
+
+	void SetMetrics(CarStreamMetrics* metricsPtr) { m_metricsPtr = metricsPtr; }
+	cv::Mat& Get(WorkBuffer buffer) { return m_imgBuffers[static_cast<int>(buffer)]; }
+	const cv::Mat& GetElement() const { return m_imgElement; }
+	uint64_t GetAllocations() const { return m_nAllocations; }
+
+private:
+	CarWorkspace(const CarWorkspace&) = delete;				//!< Disable copy construction
+	CarWorkspace& operator=(const CarWorkspace&) = delete;	//!< Disable assignment operator
+
+	CarStreamMetrics*	m_metricsPtr;						//!< 效能統計物件 (可為 nullptr)
+	cv::Mat				m_imgBuffers[CAR_WORK_BUFFERS];		//!< 暫存影像
+	const uint8_t*		m_dataPtrs[CAR_WORK_BUFFERS];		//!< 配置時的影像記憶體位址 (檢查是否被重新配置)
+	cv::Mat				m_imgElement;						//!< 形態學運算結構元素 (3 x 3)
+	uint64_t			m_nAllocations;						//!< 暫存影像配置次數
+};
+
+#endif // !ODMC_CARPLATE_WORKSPACE_HH